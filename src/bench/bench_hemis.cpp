@@ -45,6 +45,7 @@ int main(int argc, char** argv)
         return EXIT_SUCCESS;
     }
 
+    SHA256AutoDetect();
     RandomInit();
     ECC_Start();
     ECCVerifyHandle globalVerifyHandle;
@@ -5,6 +5,8 @@
 #include "bench/bench.h"
 #include "bench/data.h"
 
+#include "consensus/merkle.h"
+#include "random.h"
 #include "validation.h"
 
 // These are the two major time-sinks which happen after we have fully received
@@ -45,5 +47,50 @@ static void DeserializeAndCheckBlockTest(benchmark::State& state)
     }
 }
 
+static void BlockMerkleRootTest(benchmark::State& state)
+{
+    CDataStream stream(benchmark::data::block2680960, SER_NETWORK, PROTOCOL_VERSION);
+    CBlock block;
+    stream >> block;
+
+    bool mutated;
+    while (state.KeepRunning()) {
+        uint256 root = BlockMerkleRoot(block, &mutated);
+        assert(root == block.hashMerkleRoot);
+    }
+}
+
+// Root of a large tree, hashed one level at a time
+static void MerkleRoot(benchmark::State& state)
+{
+    FastRandomContext rng(true);
+    std::vector<uint256> leaves(9001);
+    for (auto& item : leaves) {
+        item = rng.rand256();
+    }
+    bool mutated;
+    while (state.KeepRunning()) {
+        uint256 hash = ComputeMerkleRoot(leaves, &mutated);
+        leaves[mutated] = hash;
+    }
+}
+
+// Root of a block template when only the coinbase changes (cached levels)
+static void MerkleTreeUpdateCoinbase(benchmark::State& state)
+{
+    FastRandomContext rng(true);
+    std::vector<uint256> leaves(9001);
+    for (auto& item : leaves) {
+        item = rng.rand256();
+    }
+    CMerkleTree tree(leaves);
+    while (state.KeepRunning()) {
+        tree.SetLeaf(0, tree.GetRoot());
+    }
+}
+
 BENCHMARK(DeserializeBlockTest, 130);
 BENCHMARK(DeserializeAndCheckBlockTest, 160);
+BENCHMARK(BlockMerkleRootTest, 30 * 1000);
+BENCHMARK(MerkleRoot, 800);
+BENCHMARK(MerkleTreeUpdateCoinbase, 400 * 1000);
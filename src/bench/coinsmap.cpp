@@ -0,0 +1,78 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "bench/bench.h"
+
+#include "coins.h"
+#include "random.h"
+
+#include <assert.h>
+#include <unordered_map>
+
+// The coins cache map, and the std::unordered_map it replaced
+typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> UnorderedCoinsMap;
+
+static const size_t COINS_COUNT = 200000;
+
+static std::vector<COutPoint> RandomOutPoints(size_t nCount)
+{
+    FastRandomContext rng(true);
+    std::vector<COutPoint> vOutPoints;
+    vOutPoints.reserve(nCount);
+    for (size_t i = 0; i < nCount; i++) {
+        vOutPoints.emplace_back(rng.rand256(), rng.randrange(4));
+    }
+    return vOutPoints;
+}
+
+template <typename Map>
+static void FillCoinsMap(Map& map, const std::vector<COutPoint>& vOutPoints)
+{
+    for (const COutPoint& outpoint : vOutPoints) {
+        Coin coin;
+        coin.out.nValue = 1;
+        // P2PKH script, stored in the Coin without allocation
+        coin.out.scriptPubKey.resize(25);
+        map.emplace(outpoint, CCoinsCacheEntry(std::move(coin)));
+    }
+}
+
+// Fill a map
+template <typename Map>
+static void CoinsMapFill(benchmark::State& state)
+{
+    const std::vector<COutPoint>& vOutPoints = RandomOutPoints(COINS_COUNT);
+    while (state.KeepRunning()) {
+        Map map;
+        FillCoinsMap(map, vOutPoints);
+        assert(map.size() == COINS_COUNT);
+    }
+}
+
+// Look up coins, half of which are in the map
+template <typename Map>
+static void CoinsMapLookup(benchmark::State& state)
+{
+    const std::vector<COutPoint>& vOutPoints = RandomOutPoints(COINS_COUNT * 2);
+    Map map;
+    FillCoinsMap(map, std::vector<COutPoint>(vOutPoints.begin(), vOutPoints.begin() + COINS_COUNT));
+    FastRandomContext rng(true);
+    uint64_t nFound = 0;
+    while (state.KeepRunning()) {
+        for (int i = 0; i < 1000; i++) {
+            nFound += map.find(vOutPoints[rng.randrange(vOutPoints.size())]) != map.end();
+        }
+    }
+    assert(nFound > 0);
+}
+
+static void CoinsMapFillCompact(benchmark::State& state) { CoinsMapFill<CCoinsMap>(state); }
+static void CoinsMapFillUnordered(benchmark::State& state) { CoinsMapFill<UnorderedCoinsMap>(state); }
+static void CoinsMapLookupCompact(benchmark::State& state) { CoinsMapLookup<CCoinsMap>(state); }
+static void CoinsMapLookupUnordered(benchmark::State& state) { CoinsMapLookup<UnorderedCoinsMap>(state); }
+
+BENCHMARK(CoinsMapFillCompact, 10);
+BENCHMARK(CoinsMapFillUnordered, 10);
+BENCHMARK(CoinsMapLookupCompact, 10000);
+BENCHMARK(CoinsMapLookupUnordered, 10000);
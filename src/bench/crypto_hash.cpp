@@ -49,6 +49,49 @@ static void SHA256_32b(benchmark::State& state)
     }
 }
 
+/* Double-SHA256 of 1024 64-byte blobs (the nodes of a merkle tree level), with the given implementations */
+static void SHA256D64_1024(benchmark::State& state, sha256_implementation::UseImplementation use_implementation)
+{
+    SHA256AutoDetect(use_implementation);
+    std::vector<uint8_t> in(64 * 1024, 0);
+    while (state.KeepRunning()) {
+        SHA256D64(in.data(), in.data(), 1024);
+    }
+    SHA256AutoDetect();
+}
+
+static void SHA256D64_1024_STANDARD(benchmark::State& state)
+{
+    SHA256D64_1024(state, sha256_implementation::STANDARD);
+}
+
+static void SHA256D64_1024_SSE41(benchmark::State& state)
+{
+    SHA256D64_1024(state, sha256_implementation::USE_SSE41);
+}
+
+static void SHA256D64_1024_AVX2(benchmark::State& state)
+{
+    SHA256D64_1024(state, sha256_implementation::UseImplementation(sha256_implementation::USE_SSE41 | sha256_implementation::USE_AVX2));
+}
+
+static void SHA256D64_1024_SHANI(benchmark::State& state)
+{
+    SHA256D64_1024(state, sha256_implementation::UseImplementation(sha256_implementation::USE_SSE41 | sha256_implementation::USE_SHANI));
+}
+
+static void SHA256D64_1024_ALL(benchmark::State& state)
+{
+    SHA256D64_1024(state, sha256_implementation::USE_ALL);
+}
+
+static void SHA256_STANDARD(benchmark::State& state)
+{
+    SHA256AutoDetect(sha256_implementation::STANDARD);
+    SHA256(state);
+    SHA256AutoDetect();
+}
+
 static void SHA512(benchmark::State& state)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -78,8 +121,14 @@ static void FastRandom_1bit(benchmark::State& state)
 BENCHMARK(RIPEMD160, 440);
 BENCHMARK(SHA1, 570);
 BENCHMARK(SHA256, 340);
+BENCHMARK(SHA256_STANDARD, 340);
 BENCHMARK(SHA512, 330);
 
 BENCHMARK(SHA256_32b, 4700 * 1000);
+BENCHMARK(SHA256D64_1024_STANDARD, 7400);
+BENCHMARK(SHA256D64_1024_SSE41, 7400);
+BENCHMARK(SHA256D64_1024_AVX2, 7400);
+BENCHMARK(SHA256D64_1024_SHANI, 7400);
+BENCHMARK(SHA256D64_1024_ALL, 7400);
 BENCHMARK(FastRandom_32bit, 110 * 1000 * 1000);
 BENCHMARK(FastRandom_1bit, 440 * 1000 * 1000);
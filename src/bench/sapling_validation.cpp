@@ -0,0 +1,96 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "chainparams.h"
+#include "key.h"
+#include "keystore.h"
+#include "sapling/sapling_validation.h"
+#include "sapling/transaction_builder.h"
+#include "script/standard.h"
+#include "util/system.h"
+#include "validation.h"
+
+#include <boost/thread/thread.hpp>
+
+// Number of shielded transactions in the synthetic block
+static const int SHIELDED_TXS = 16;
+// Height of the synthetic block
+static const int SHIELDED_BLOCK_HEIGHT = 1;
+
+// A block with SHIELDED_TXS transactions, half of them from transparent inputs
+// to two shielded outputs, and half from one shielded note to two shielded outputs.
+static const CBlock& GetShieldedBlock()
+{
+    static CBlock block;
+    if (!block.vtx.empty()) return block;
+
+    initZKSNARKS();
+    SaplingValidation::InitProofCache();
+    SelectParams(CBaseChainParams::REGTEST);
+    const Consensus::Params& consensus = Params().GetConsensus();
+
+    CBasicKeyStore keystore;
+    CKey tsk;
+    tsk.MakeNewKey(true);
+    keystore.AddKey(tsk);
+    const CScript& scriptPubKey = GetScriptForDestination(tsk.GetPubKey().GetID());
+    auto sk = libzcash::SaplingSpendingKey::random();
+    auto expsk = sk.expanded_spending_key();
+    auto fvk = sk.full_viewing_key();
+    auto pa = sk.default_address();
+
+    for (int i = 0; i < SHIELDED_TXS; i++) {
+        auto builder = TransactionBuilder(consensus, &keystore);
+        builder.SetFee(COIN / 10);
+        if (i % 2) {
+            libzcash::SaplingNote note(pa, 3 * COIN);
+            SaplingMerkleTree tree;
+            tree.append(note.cmu().get());
+            builder.AddSaplingSpend(expsk, note, tree.root(), tree.witness());
+        } else {
+            builder.AddTransparentInput(COutPoint(uint256S("1234"), i), scriptPubKey, 3 * COIN);
+        }
+        builder.AddSaplingOutput(fvk.ovk, pa, COIN, {});
+        builder.AddSaplingOutput(fvk.ovk, pa, COIN, {});
+        block.vtx.emplace_back(MakeTransactionRef(builder.Build().GetTxOrThrow()));
+    }
+    return block;
+}
+
+// One transaction after the other, on the calling thread
+static void SaplingBlockProofsSerial(benchmark::State& state)
+{
+    const CBlock& block = GetShieldedBlock();
+    const ECCVerifyHandle verify_handle;
+    nScriptCheckThreads = 0;
+    while (state.KeepRunning()) {
+        for (const auto& res : CheckBlockSaplingProofs(block, SHIELDED_BLOCK_HEIGHT)) {
+            assert(res == SaplingValidation::ProofCheckResult::VALID);
+        }
+    }
+}
+
+// The whole block spread over the check threads
+static void SaplingBlockProofsParallel(benchmark::State& state)
+{
+    const CBlock& block = GetShieldedBlock();
+    const ECCVerifyHandle verify_handle;
+    nScriptCheckThreads = std::max(2, std::min(GetNumCores(), MAX_SCRIPTCHECK_THREADS));
+    boost::thread_group tg;
+    for (int i = 0; i < nScriptCheckThreads - 1; i++) {
+        tg.create_thread(&ThreadSaplingCheck);
+    }
+    while (state.KeepRunning()) {
+        for (const auto& res : CheckBlockSaplingProofs(block, SHIELDED_BLOCK_HEIGHT)) {
+            assert(res == SaplingValidation::ProofCheckResult::VALID);
+        }
+    }
+    tg.interrupt_all();
+    tg.join_all();
+    nScriptCheckThreads = 0;
+}
+
+BENCHMARK(SaplingBlockProofsSerial, 1);
+BENCHMARK(SaplingBlockProofsParallel, 1);
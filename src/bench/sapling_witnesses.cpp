@@ -0,0 +1,76 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "random.h"
+#include "sapling/incrementalmerkletree.h"
+
+// Note commitments in each block
+static const int BLOCK_COMMITMENTS = 50;
+
+// A tree with nNotes wallet notes, witnessed up to the tip
+static void SetupWitnesses(int nNotes, SaplingMerkleTree& tree, std::vector<SaplingWitness>& witnesses)
+{
+    FastRandomContext rng(true);
+    for (int i = 0; i < nNotes; i++) {
+        // a few other notes in between
+        for (int j = 0; j < 3; j++) {
+            const libzcash::PedersenHash cmu(rng.rand256());
+            tree.append(cmu);
+            for (auto& w : witnesses) w.append(cmu);
+        }
+        witnesses.emplace_back(tree.witness());
+    }
+}
+
+static std::vector<libzcash::PedersenHash> BlockCommitments()
+{
+    FastRandomContext rng(true);
+    std::vector<libzcash::PedersenHash> ret;
+    for (int i = 0; i < BLOCK_COMMITMENTS; i++) ret.emplace_back(rng.rand256());
+    return ret;
+}
+
+// Append the commitments of a block to each witness (the cost grows with the number of notes)
+static void SaplingWitnessesAppend(benchmark::State& state, int nNotes)
+{
+    SaplingMerkleTree tree;
+    std::vector<SaplingWitness> witnesses;
+    SetupWitnesses(nNotes, tree, witnesses);
+    const auto& cmus = BlockCommitments();
+    while (state.KeepRunning()) {
+        std::vector<SaplingWitness> block_witnesses(witnesses);
+        for (const auto& cmu : cmus) {
+            for (auto& w : block_witnesses) w.append(cmu);
+        }
+    }
+}
+
+// Append the commitments of a block with the shared tracker (the hashing doesn't depend on the number of notes)
+static void SaplingWitnessesTracker(benchmark::State& state, int nNotes)
+{
+    SaplingMerkleTree tree;
+    std::vector<SaplingWitness> witnesses;
+    SetupWitnesses(nNotes, tree, witnesses);
+    const auto& cmus = BlockCommitments();
+    while (state.KeepRunning()) {
+        std::vector<SaplingWitness> block_witnesses(witnesses);
+        SaplingWitnessTracker tracker;
+        for (auto& w : block_witnesses) tracker.AddWitness(&w);
+        for (const auto& cmu : cmus) tracker.append(cmu);
+        tracker.Flush();
+    }
+}
+
+static void SaplingWitnessesAppend_10(benchmark::State& state) { SaplingWitnessesAppend(state, 10); }
+static void SaplingWitnessesAppend_100(benchmark::State& state) { SaplingWitnessesAppend(state, 100); }
+static void SaplingWitnessesTracker_10(benchmark::State& state) { SaplingWitnessesTracker(state, 10); }
+static void SaplingWitnessesTracker_100(benchmark::State& state) { SaplingWitnessesTracker(state, 100); }
+static void SaplingWitnessesTracker_1000(benchmark::State& state) { SaplingWitnessesTracker(state, 1000); }
+
+BENCHMARK(SaplingWitnessesAppend_10, 10);
+BENCHMARK(SaplingWitnessesAppend_100, 1);
+BENCHMARK(SaplingWitnessesTracker_10, 10);
+BENCHMARK(SaplingWitnessesTracker_100, 10);
+BENCHMARK(SaplingWitnessesTracker_1000, 10);
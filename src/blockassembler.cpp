@@ -234,9 +234,10 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     pblock->nNonce = 0;
     pblocktemplate->vTxSigOps[0] = GetLegacySigOpCount(*(pblock->vtx[0]));
     appendSaplingTreeRoot();
+    pblocktemplate->merkleTree = CMerkleTree(*pblock);
 
     if (fProofOfStake) { // this is only for PoS because the IncrementExtraNonce does it for PoW
-        pblock->hashMerkleRoot = BlockMerkleRoot(*pblock);
+        pblock->hashMerkleRoot = pblocktemplate->merkleTree.GetRoot();
         LogPrintf("CPUMiner : proof-of-stake block found %s \n", pblock->GetHash().GetHex());
         if (!SignBlock(*pblock, *pwallet)) {
             LogPrintf("%s: Signing new block with UTXO key failed \n", __func__);
@@ -532,7 +533,7 @@ bool SolveBlock(std::shared_ptr<CBlock>& pblock, int nHeight)
     return pblock->nNonce != std::numeric_limits<uint32_t>::max();
 }
 
-void IncrementExtraNonce(std::shared_ptr<CBlock>& pblock, int nHeight, unsigned int& nExtraNonce)
+void IncrementExtraNonce(std::shared_ptr<CBlock>& pblock, int nHeight, unsigned int& nExtraNonce, CMerkleTree* pmerkleTree)
 {
     // Update nExtraNonce
     static uint256 hashPrevBlock;
@@ -546,7 +547,13 @@ void IncrementExtraNonce(std::shared_ptr<CBlock>& pblock, int nHeight, unsigned
     assert(txCoinbase.vin[0].scriptSig.size() <= 100);
 
     pblock->vtx[0] = MakeTransactionRef(txCoinbase);
-    pblock->hashMerkleRoot = BlockMerkleRoot(*pblock);
+    if (pmerkleTree && pmerkleTree->GetLeavesCount() == pblock->vtx.size()) {
+        // Only the coinbase changed
+        pmerkleTree->SetLeaf(0, pblock->vtx[0]->GetHash());
+        pblock->hashMerkleRoot = pmerkleTree->GetRoot();
+    } else {
+        pblock->hashMerkleRoot = BlockMerkleRoot(*pblock);
+    }
 }
 
 int32_t ComputeBlockVersion(const Consensus::Params& consensus, int nHeight)
@@ -7,6 +7,7 @@
 #ifndef Hemis_BLOCKASSEMBLER_H
 #define Hemis_BLOCKASSEMBLER_H
 
+#include "consensus/merkle.h"
 #include "primitives/block.h"
 #include "txmempool.h"
 
@@ -29,6 +30,8 @@ struct CBlockTemplate
     CBlock block;
     std::vector<CAmount> vTxFees;
     std::vector<int64_t> vTxSigOps;
+    // All the levels of the merkle tree, to update the root when only the coinbase changes
+    CMerkleTree merkleTree;
 };
 
 // Container for tracking updates to ancestor feerate as we include (parent)
@@ -205,7 +208,8 @@ private:
 
 /** Modify the nonce/extranonce in a block */
 bool SolveBlock(std::shared_ptr<CBlock>& pblock, int nHeight);
-void IncrementExtraNonce(std::shared_ptr<CBlock>& pblock, int nHeight, unsigned int& nExtraNonce);
+/** Modify the extranonce in a block (and update the merkle root, with the cached tree if provided) */
+void IncrementExtraNonce(std::shared_ptr<CBlock>& pblock, int nHeight, unsigned int& nExtraNonce, CMerkleTree* pmerkleTree = nullptr);
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev);
 int32_t ComputeBlockVersion(const Consensus::Params& consensusParams, int nHeight);
 
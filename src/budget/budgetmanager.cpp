@@ -8,6 +8,7 @@
 #include "consensus/validation.h"
 #include "evo/deterministicgms.h"
 #include "gamemasterman.h"
+#include "index/txindex.h"
 #include "netmessagemaker.h"
 #include "tiertwo/tiertwo_sync_state.h"
 #include "tiertwo/netfulfilledman.h"
@@ -1532,6 +1533,12 @@ bool CheckCollateralConfs(const uint256& nTxCollateralHash, int nCurrentHeight,
 
 bool CheckCollateral(const uint256& nTxCollateralHash, const uint256& nExpectedHash, std::string& strError, int64_t& nTime, int nCurrentHeight, bool fBudgetFinalization)
 {
+    // Hold back until the transaction index is built (the collateral can't be found before)
+    if (g_txindex && !g_txindex->GetSummary().synced) {
+        strError = "Transaction index not synced yet";
+        return false;
+    }
+
     CTransactionRef txCollateral;
     uint256 nBlockHash;
     if (!GetTransaction(nTxCollateralHash, txCollateral, nBlockHash, true)) {
@@ -57,9 +57,14 @@ SaltedIdHasher::SaltedIdHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max
 CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn), cachedCoinsUsage(0) {}
 
 size_t CCoinsViewCache::DynamicMemoryUsage() const {
+    size_t nRecentTreesUsage = 0;
+    for (const auto& it : recentSaplingTrees) {
+        nRecentTreesUsage += memusage::MallocUsage(sizeof(it)) + it.second.DynamicMemoryUsage();
+    }
     return memusage::DynamicUsage(cacheCoins) +
            memusage::DynamicUsage(cacheSaplingAnchors) +
            memusage::DynamicUsage(cacheSaplingNullifiers) +
+           nRecentTreesUsage +
            cachedCoinsUsage;
 }
 
@@ -71,7 +76,7 @@ CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint& outpoint) const
     Coin tmp;
     if (!base->GetCoin(outpoint, tmp))
         return cacheCoins.end();
-    CCoinsMap::iterator ret = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::forward_as_tuple(std::move(tmp))).first;
+    CCoinsMap::iterator ret = cacheCoins.try_emplace(outpoint, std::move(tmp)).first;
     if (ret->second.coin.IsSpent()) {
         // The parent only has an empty entry for this outpoint; we can consider our
         // version as fresh.
@@ -97,7 +102,7 @@ void CCoinsViewCache::AddCoin(const COutPoint& outpoint, Coin&& coin, bool possi
     if (coin.out.IsZerocoinMint()) return;
     CCoinsMap::iterator it;
     bool inserted;
-    std::tie(it, inserted) = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::tuple<>());
+    std::tie(it, inserted) = cacheCoins.try_emplace(outpoint);
     bool fresh = false;
     if (!inserted) {
         cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
@@ -170,6 +175,18 @@ bool CCoinsViewCache::HaveCoinInCache(const COutPoint& outpoint) const
     return it != cacheCoins.end();
 }
 
+bool CCoinsViewCache::AddFetchedCoin(const COutPoint& outpoint, Coin&& coin)
+{
+    if (coin.IsSpent()) return false;
+    CCoinsMap::iterator it;
+    bool inserted;
+    std::tie(it, inserted) = cacheCoins.try_emplace(outpoint, std::move(coin));
+    if (inserted) {
+        cachedCoinsUsage += memusage::DynamicUsage(it->second.coin);
+    }
+    return inserted;
+}
+
 uint256 CCoinsViewCache::GetBestBlock() const
 {
     if (hashBlock.IsNull())
@@ -298,6 +315,12 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap& mapCoins,
     }
 
     // Sapling
+    // Anchors popped by the child
+    for (const auto& it : mapSaplingAnchors) {
+        if ((it.second.flags & CAnchorsSaplingCacheEntry::DIRTY) && !it.second.entered) {
+            EraseRecentSaplingTree(it.first);
+        }
+    }
     ::BatchWriteAnchors<CAnchorsSaplingMap, CAnchorsSaplingMap::iterator, CAnchorsSaplingCacheEntry>(mapSaplingAnchors, cacheSaplingAnchors, cachedCoinsUsage);
     ::BatchWriteNullifiers(mapSaplingNullifiers, cacheSaplingNullifiers);
     hashSaplingAnchor = hashSaplingAnchorIn;
@@ -308,6 +331,11 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap& mapCoins,
 
 bool CCoinsViewCache::Flush()
 {
+    // Keep the tree of the best anchor: the next block is connected on top of it
+    auto itBest = cacheSaplingAnchors.find(hashSaplingAnchor);
+    if (itBest != cacheSaplingAnchors.end() && itBest->second.entered) {
+        AddRecentSaplingTree(itBest->first, itBest->second.tree);
+    }
     bool fOk = base->BatchWrite(cacheCoins,
             hashBlock,
             hashSaplingAnchor,
@@ -431,18 +459,48 @@ bool CCoinsViewCache::GetSaplingAnchorAt(const uint256 &rt, SaplingMerkleTree &t
         }
     }
 
+    if (GetRecentSaplingTree(rt, tree)) {
+        return true;
+    }
+
     if (!base->GetSaplingAnchorAt(rt, tree)) {
         return false;
     }
 
-    CAnchorsSaplingMap::iterator ret = cacheSaplingAnchors.insert(std::make_pair(rt, CAnchorsSaplingCacheEntry())).first;
-    ret->second.entered = true;
-    ret->second.tree = tree;
-    cachedCoinsUsage += ret->second.tree.DynamicMemoryUsage();
+    // Clean entry: kept with the recent trees only, so that looking up many old
+    // anchors (e.g. in a wallet rescan) does not grow the cache until the next flush.
+    AddRecentSaplingTree(rt, tree);
 
     return true;
 }
 
+bool CCoinsViewCache::GetRecentSaplingTree(const uint256& rt, SaplingMerkleTree& tree) const
+{
+    for (auto it = recentSaplingTrees.begin(); it != recentSaplingTrees.end(); ++it) {
+        if (it->first == rt) {
+            // Move it to the front
+            recentSaplingTrees.splice(recentSaplingTrees.begin(), recentSaplingTrees, it);
+            tree = it->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CCoinsViewCache::AddRecentSaplingTree(const uint256& rt, const SaplingMerkleTree& tree) const
+{
+    EraseRecentSaplingTree(rt);
+    recentSaplingTrees.emplace_front(rt, tree);
+    if (recentSaplingTrees.size() > MAX_RECENT_SAPLING_TREES) {
+        recentSaplingTrees.pop_back();
+    }
+}
+
+void CCoinsViewCache::EraseRecentSaplingTree(const uint256& rt) const
+{
+    recentSaplingTrees.remove_if([&rt](const std::pair<uint256, SaplingMerkleTree>& e) { return e.first == rt; });
+}
+
 bool CCoinsViewCache::GetNullifier(const uint256 &nullifier) const {
     CNullifiersMap* cacheToUse = &cacheSaplingNullifiers;
     CNullifiersMap::iterator it = cacheToUse->find(nullifier);
@@ -530,6 +588,7 @@ void CCoinsViewCache::AbstractPopAnchor(
 
         // Mark the anchor as unentered, removing it from view
         cacheAnchors[currentRoot].entered = false;
+        EraseRecentSaplingTree(currentRoot);
 
         // Mark the cache entry as dirty so it's propagated
         cacheAnchors[currentRoot].flags = CacheEntry::DIRTY;
@@ -7,6 +7,7 @@
 #ifndef BITCOIN_COINS_H
 #define BITCOIN_COINS_H
 
+#include "compactmap.h"
 #include "compressor.h"
 #include "consensus/consensus.h" // can be removed once policy/ established
 #include "crypto/siphash.h"
@@ -17,6 +18,7 @@
 #include "uint256.h"
 
 #include <assert.h>
+#include <list>
 #include <stdint.h>
 
 #include <unordered_map>
@@ -174,7 +176,7 @@ struct CNullifiersCacheEntry
 typedef std::unordered_map<uint256, CAnchorsSaplingCacheEntry, SaltedIdHasher> CAnchorsSaplingMap;
 typedef std::unordered_map<uint256, CNullifiersCacheEntry, SaltedIdHasher> CNullifiersMap;
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+typedef compactmap<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -294,6 +296,15 @@ protected:
     mutable CAnchorsSaplingMap cacheSaplingAnchors;
     mutable CNullifiersMap cacheSaplingNullifiers;
 
+    /**
+     * Sapling trees recently read from the base view or flushed to it (root --> tree),
+     * most recent first. Unlike cacheSaplingAnchors, they are kept across Flush(), so that
+     * the tree of the previous block is not read and deserialized again from the base.
+     * An anchor popped through this view is removed.
+     */
+    static constexpr size_t MAX_RECENT_SAPLING_TREES = 8;
+    mutable std::list<std::pair<uint256, SaplingMerkleTree>> recentSaplingTrees;
+
     /* Cached dynamic memory usage for the inner Coin objects. */
     mutable size_t cachedCoinsUsage;
 
@@ -346,6 +357,13 @@ public:
      */
     bool HaveCoinInCache(const COutPoint& outpoint) const;
 
+    /**
+     * Add a coin read from the backing view (by another thread), as GetCoin would have
+     * done. Nothing is done if the outpoint is in the cache already.
+     * Returns whether the coin was added.
+     */
+    bool AddFetchedCoin(const COutPoint& outpoint, Coin&& coin);
+
     /**
      * Return a reference to a Coin in the cache, or a pruned one if not found. This is
      * more efficient than GetCoin. Modifications to other cache entries are
@@ -438,6 +456,11 @@ private:
             const uint256 &currentRoot,
             Tree &tree
     );
+
+    //! Recently used Sapling trees
+    bool GetRecentSaplingTree(const uint256& rt, SaplingMerkleTree& tree) const;
+    void AddRecentSaplingTree(const uint256& rt, const SaplingMerkleTree& tree) const;
+    void EraseRecentSaplingTree(const uint256& rt) const;
 };
 
 //! Utility function to add all of a transaction's outputs to a cache.
@@ -0,0 +1,322 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#ifndef Hemis_COMPACTMAP_H
+#define Hemis_COMPACTMAP_H
+
+#include "memusage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/** Hash map with the interface of the subset of std::unordered_map used by the coins caches,
+ *  using less memory per entry and fewer cache misses per lookup.
+ *
+ *  The index is an open-addressing table (linear probing) of one control byte and one
+ *  pointer per slot. The control byte holds 7 bits of the hash of the key, so that a lookup
+ *  dereferences (almost) only the entry it is looking for, and a miss none at all.
+ *
+ *  The entries are allocated from a pool of chunks, without a malloc header or a next
+ *  pointer per entry. They don't move when the index grows: as with std::unordered_map,
+ *  pointers and references to them stay valid until they are erased. Iterators are
+ *  invalidated by an insertion that grows the index, but not by an erasure, so that the
+ *  map can be emptied while iterating over it.
+ *
+ *  The hash function must be salted, and of good quality on all its bits.
+ */
+template <typename K, typename T, typename Hash>
+class compactmap
+{
+public:
+    typedef K key_type;
+    typedef T mapped_type;
+    typedef std::pair<const K, T> value_type;
+    typedef size_t size_type;
+
+private:
+    union Node {
+        value_type value;
+        Node* next; // Free list of the pool
+        Node() {}
+        ~Node() {}
+    };
+
+    enum : uint8_t {
+        // Control bytes: the 7 bits of the hash of a full slot, or one of these
+        CTRL_EMPTY = 0x80,
+        CTRL_DELETED = 0xfe,
+    };
+    enum : size_t {
+        MIN_SLOTS = 16,
+        // The first chunks of the pool are small, for the short-lived caches
+        MIN_CHUNK_NODES = 16,
+        MAX_CHUNK_NODES = 4096,
+    };
+
+    Hash hasher;
+    std::unique_ptr<uint8_t[]> ctrl;
+    std::unique_ptr<Node*[]> slots;
+    size_t nSlots{0};
+    size_t nSize{0};
+    size_t nDeleted{0};
+
+    std::vector<std::pair<std::unique_ptr<Node[]>, size_t>> vChunks;
+    size_t nPoolNodes{0};
+    size_t nChunkUsed{0};
+    Node* freeList{nullptr};
+
+    static bool IsFull(uint8_t c) { return c < (uint8_t)CTRL_EMPTY; }
+    size_t Mask() const { return nSlots - 1; }
+
+    Node* AllocateNode()
+    {
+        if (freeList) {
+            Node* node = freeList;
+            freeList = node->next;
+            return node;
+        }
+        if (vChunks.empty() || nChunkUsed == vChunks.back().second) {
+            const size_t nNodes = std::min<size_t>(std::max<size_t>(nPoolNodes, MIN_CHUNK_NODES), MAX_CHUNK_NODES);
+            vChunks.emplace_back(std::unique_ptr<Node[]>(new Node[nNodes]), nNodes);
+            nPoolNodes += nNodes;
+            nChunkUsed = 0;
+        }
+        return &vChunks.back().first[nChunkUsed++];
+    }
+
+    void FreeNode(Node* node)
+    {
+        node->value.~value_type();
+        node->next = freeList;
+        freeList = node;
+    }
+
+    // Slot of key, or the slot where to insert it
+    size_t FindSlot(const K& key, size_t hash, bool& fFound) const
+    {
+        const uint8_t tag = hash & 0x7f;
+        size_t nInsert = nSlots;
+        for (size_t i = (hash >> 7) & Mask();; i = (i + 1) & Mask()) {
+            const uint8_t c = ctrl[i];
+            if (c == tag && slots[i]->value.first == key) {
+                fFound = true;
+                return i;
+            }
+            if (c == CTRL_EMPTY) {
+                fFound = false;
+                return nInsert == nSlots ? i : nInsert;
+            }
+            if (c == CTRL_DELETED && nInsert == nSlots) nInsert = i;
+        }
+    }
+
+    void Rehash(size_t nNewSlots)
+    {
+        std::unique_ptr<uint8_t[]> oldCtrl = std::move(ctrl);
+        std::unique_ptr<Node*[]> oldSlots = std::move(slots);
+        const size_t nOldSlots = nSlots;
+        ctrl.reset(new uint8_t[nNewSlots]);
+        slots.reset(new Node*[nNewSlots]);
+        memset(ctrl.get(), CTRL_EMPTY, nNewSlots);
+        nSlots = nNewSlots;
+        nDeleted = 0;
+        for (size_t j = 0; j < nOldSlots; j++) {
+            if (!IsFull(oldCtrl[j])) continue;
+            const size_t hash = hasher(oldSlots[j]->value.first);
+            size_t i = (hash >> 7) & Mask();
+            while (ctrl[i] != CTRL_EMPTY) i = (i + 1) & Mask();
+            ctrl[i] = hash & 0x7f;
+            slots[i] = oldSlots[j];
+        }
+    }
+
+    size_t NextFull(size_t i) const
+    {
+        while (i < nSlots && !IsFull(ctrl[i])) i++;
+        return i;
+    }
+
+    template <bool fConst>
+    class Iterator
+    {
+        friend class compactmap;
+        template <bool>
+        friend class Iterator;
+        typedef typename std::conditional<fConst, const compactmap*, compactmap*>::type map_pointer;
+        map_pointer map;
+        size_t i;
+        Iterator(map_pointer mapIn, size_t iIn) : map(mapIn), i(iIn) {}
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename compactmap::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<fConst, const value_type*, value_type*>::type pointer;
+        typedef typename std::conditional<fConst, const value_type&, value_type&>::type reference;
+
+        Iterator() : map(nullptr), i(0) {}
+        // iterator to const_iterator
+        template <bool fOtherConst, typename = typename std::enable_if<fConst && !fOtherConst>::type>
+        Iterator(const Iterator<fOtherConst>& it) : map(it.map), i(it.i) {}
+
+        reference operator*() const { return map->slots[i]->value; }
+        pointer operator->() const { return &map->slots[i]->value; }
+        Iterator& operator++() { i = map->NextFull(i + 1); return *this; }
+        Iterator operator++(int) { Iterator copy(*this); ++(*this); return copy; }
+        bool operator==(const Iterator& it) const { return i == it.i; }
+        bool operator!=(const Iterator& it) const { return i != it.i; }
+    };
+
+public:
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    compactmap() {}
+    ~compactmap() { clear(); }
+
+    compactmap(const compactmap&) = delete;
+    compactmap& operator=(const compactmap&) = delete;
+    compactmap(compactmap&& other) noexcept :
+        hasher(other.hasher),
+        ctrl(std::move(other.ctrl)),
+        slots(std::move(other.slots)),
+        nSlots(other.nSlots),
+        nSize(other.nSize),
+        nDeleted(other.nDeleted),
+        vChunks(std::move(other.vChunks)),
+        nPoolNodes(other.nPoolNodes),
+        nChunkUsed(other.nChunkUsed),
+        freeList(other.freeList)
+    {
+        other.nSlots = other.nSize = other.nDeleted = 0;
+        other.vChunks.clear();
+        other.nPoolNodes = other.nChunkUsed = 0;
+        other.freeList = nullptr;
+    }
+    // Not assignable: the entries are placed according to the salt of the hasher
+
+    iterator begin() { return iterator(this, NextFull(0)); }
+    iterator end() { return iterator(this, nSlots); }
+    const_iterator begin() const { return const_iterator(this, NextFull(0)); }
+    const_iterator end() const { return const_iterator(this, nSlots); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    bool empty() const { return nSize == 0; }
+    size_type size() const { return nSize; }
+    size_type bucket_count() const { return nSlots; }
+
+    iterator find(const K& key)
+    {
+        if (nSize == 0) return end();
+        bool fFound;
+        const size_t i = FindSlot(key, hasher(key), fFound);
+        return fFound ? iterator(this, i) : end();
+    }
+
+    const_iterator find(const K& key) const
+    {
+        return const_cast<compactmap*>(this)->find(key);
+    }
+
+    size_type count(const K& key) const { return find(key) != end() ? 1 : 0; }
+
+    // Construct the mapped value from args, if key is not in the map yet
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args)
+    {
+        const size_t hash = hasher(key);
+        bool fFound = false;
+        size_t i = nSlots ? FindSlot(key, hash, fFound) : 0;
+        if (fFound) return std::make_pair(iterator(this, i), false);
+
+        // Load factor (including the erased slots) at most 7/8, and 7/16 after a growth
+        if ((nSize + nDeleted + 1) * 8 > nSlots * 7) {
+            size_t nNewSlots = std::max<size_t>(nSlots, MIN_SLOTS);
+            while ((nSize + 1) * 16 > nNewSlots * 7) nNewSlots *= 2;
+            Rehash(nNewSlots);
+            i = FindSlot(key, hash, fFound);
+        }
+
+        Node* node = AllocateNode();
+        try {
+            new (&node->value) value_type(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        } catch (...) {
+            node->next = freeList;
+            freeList = node;
+            throw;
+        }
+        if (ctrl[i] == CTRL_DELETED) nDeleted--;
+        ctrl[i] = hash & 0x7f;
+        slots[i] = node;
+        nSize++;
+        return std::make_pair(iterator(this, i), true);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(const K& key, Args&&... args)
+    {
+        return try_emplace(key, std::forward<Args>(args)...);
+    }
+
+    T& operator[](const K& key) { return try_emplace(key).first->second; }
+
+    // Returns the iterator following it
+    iterator erase(iterator it)
+    {
+        const size_t i = it.i;
+        FreeNode(slots[i]);
+        // A lookup stops at the next slot anyway if it is empty
+        if (ctrl[(i + 1) & Mask()] == CTRL_EMPTY) {
+            ctrl[i] = CTRL_EMPTY;
+        } else {
+            ctrl[i] = CTRL_DELETED;
+            nDeleted++;
+        }
+        nSize--;
+        return iterator(this, NextFull(i + 1));
+    }
+
+    size_type erase(const K& key)
+    {
+        iterator it = find(key);
+        if (it == end()) return 0;
+        erase(it);
+        return 1;
+    }
+
+    // Destroy the entries, and release all the memory
+    void clear()
+    {
+        for (size_t i = 0; i < nSlots; i++) {
+            if (IsFull(ctrl[i])) slots[i]->value.~value_type();
+        }
+        ctrl.reset();
+        slots.reset();
+        nSlots = nSize = nDeleted = 0;
+        vChunks.clear();
+        nPoolNodes = nChunkUsed = 0;
+        freeList = nullptr;
+    }
+
+    size_t DynamicMemoryUsage() const
+    {
+        size_t usage = memusage::DynamicUsage(vChunks);
+        if (nSlots) {
+            usage += memusage::MallocUsage(nSlots) + memusage::MallocUsage(nSlots * sizeof(Node*));
+        }
+        for (const auto& chunk : vChunks) {
+            usage += memusage::MallocUsage(chunk.second * sizeof(Node));
+        }
+        return usage;
+    }
+};
+
+#endif // Hemis_COMPACTMAP_H
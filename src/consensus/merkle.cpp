@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "merkle.h"
+#include "crypto/sha256.h"
 #include "hash.h"
 #include "utilstrencodings.h"
 
@@ -126,10 +127,24 @@ static void MerkleComputation(const std::vector<uint256>& leaves, uint256* proot
     if (proot) *proot = h;
 }
 
-uint256 ComputeMerkleRoot(const std::vector<uint256>& leaves, bool* mutated) {
-    uint256 hash;
-    MerkleComputation(leaves, &hash, mutated, -1, nullptr);
-    return hash;
+uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool* mutated) {
+    bool mutation = false;
+    while (hashes.size() > 1) {
+        if (mutated) {
+            for (size_t pos = 0; pos + 1 < hashes.size(); pos += 2) {
+                if (hashes[pos] == hashes[pos + 1]) mutation = true;
+            }
+        }
+        if (hashes.size() & 1) {
+            hashes.push_back(hashes.back());
+        }
+        // Hash the whole level in place, at once
+        SHA256D64(hashes[0].begin(), hashes[0].begin(), hashes.size() / 2);
+        hashes.resize(hashes.size() / 2);
+    }
+    if (mutated) *mutated = mutation;
+    if (hashes.size() == 0) return uint256();
+    return hashes[0];
 }
 
 std::vector<uint256> ComputeMerkleBranch(const std::vector<uint256>& leaves, uint32_t position) {
@@ -158,7 +173,7 @@ uint256 BlockMerkleRoot(const CBlock& block, bool* mutated)
     for (size_t s = 0; s < block.vtx.size(); s++) {
         leaves[s] = block.vtx[s]->GetHash();
     }
-    return ComputeMerkleRoot(leaves, mutated);
+    return ComputeMerkleRoot(std::move(leaves), mutated);
 }
 
 std::vector<uint256> BlockMerkleBranch(const CBlock& block, uint32_t position)
@@ -169,4 +184,70 @@ std::vector<uint256> BlockMerkleBranch(const CBlock& block, uint32_t position)
         leaves[s] = block.vtx[s]->GetHash();
     }
     return ComputeMerkleBranch(leaves, position);
-}
\ No newline at end of file
+}
+
+/* Double-SHA256 of the concatenation of two hashes */
+static uint256 HashPair(const uint256& left, const uint256& right)
+{
+    unsigned char buf[64];
+    memcpy(buf, left.begin(), 32);
+    memcpy(buf + 32, right.begin(), 32);
+    uint256 ret;
+    SHA256D64(ret.begin(), buf, 1);
+    return ret;
+}
+
+CMerkleTree::CMerkleTree(std::vector<uint256> leaves)
+{
+    if (leaves.empty()) return;
+    vLevels.emplace_back(std::move(leaves));
+    while (vLevels.back().size() > 1) {
+        const std::vector<uint256>& level = vLevels.back();
+        std::vector<uint256> next((level.size() + 1) / 2);
+        SHA256D64(next[0].begin(), level[0].begin(), level.size() / 2);
+        if (level.size() & 1) {
+            next.back() = HashPair(level.back(), level.back());
+        }
+        vLevels.emplace_back(std::move(next));
+    }
+}
+
+static std::vector<uint256> BlockLeaves(const CBlock& block)
+{
+    std::vector<uint256> leaves(block.vtx.size());
+    for (size_t s = 0; s < block.vtx.size(); s++) {
+        leaves[s] = block.vtx[s]->GetHash();
+    }
+    return leaves;
+}
+
+CMerkleTree::CMerkleTree(const CBlock& block) : CMerkleTree(BlockLeaves(block)) {}
+
+uint256 CMerkleTree::GetRoot() const
+{
+    return vLevels.empty() ? uint256() : vLevels.back()[0];
+}
+
+std::vector<uint256> CMerkleTree::GetBranch(size_t position) const
+{
+    std::vector<uint256> ret;
+    for (size_t h = 0; h + 1 < vLevels.size(); h++) {
+        const std::vector<uint256>& level = vLevels[h];
+        ret.push_back(level[std::min(position ^ 1, level.size() - 1)]);
+        position >>= 1;
+    }
+    return ret;
+}
+
+void CMerkleTree::SetLeaf(size_t position, const uint256& leaf)
+{
+    assert(position < GetLeavesCount());
+    vLevels[0][position] = leaf;
+    for (size_t h = 0; h + 1 < vLevels.size(); h++) {
+        const std::vector<uint256>& level = vLevels[h];
+        const size_t left = position & ~(size_t)1;
+        const size_t right = std::min(left + 1, level.size() - 1);
+        position >>= 1;
+        vLevels[h + 1][position] = HashPair(level[left], level[right]);
+    }
+}
@@ -12,7 +12,7 @@
 #include "primitives/block.h"
 #include "uint256.h"
 
-uint256 ComputeMerkleRoot(const std::vector<uint256>& leaves, bool* mutated = nullptr);
+uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool* mutated = nullptr);
 std::vector<uint256> ComputeMerkleBranch(const std::vector<uint256>& leaves, uint32_t position);
 uint256 ComputeMerkleRootFromBranch(const uint256& leaf, const std::vector<uint256>& branch, uint32_t position);
 
@@ -29,4 +29,35 @@ uint256 BlockMerkleRoot(const CBlock& block, bool* mutated = nullptr);
  */
 std::vector<uint256> BlockMerkleBranch(const CBlock& block, uint32_t position);
 
+/*
+ * Merkle tree with all the levels of inner hashes kept in memory.
+ * Each level is computed in a single batch of double-SHA256 (see SHA256D64).
+ * When one leaf changes (e.g. the coinbase of a block template) the root is
+ * updated hashing only the path from that leaf to the top.
+ * The odd levels follow the same rule of ComputeMerkleRoot (the last hash is
+ * combined with itself).
+ */
+class CMerkleTree
+{
+private:
+    // vLevels[0] are the leaves, vLevels.back() holds only the root
+    std::vector<std::vector<uint256>> vLevels;
+
+public:
+    CMerkleTree() = default;
+    explicit CMerkleTree(std::vector<uint256> leaves);
+    explicit CMerkleTree(const CBlock& block);
+
+    size_t GetLeavesCount() const { return vLevels.empty() ? 0 : vLevels[0].size(); }
+    // Number of levels above the leaves
+    int GetHeight() const { return vLevels.empty() ? 0 : (int)vLevels.size() - 1; }
+    // Hash of the node at the given height (0 for the leaves) and position
+    const uint256& GetHash(int height, size_t pos) const { return vLevels[height][pos]; }
+    uint256 GetRoot() const;
+    std::vector<uint256> GetBranch(size_t position) const;
+
+    // Replace a leaf and update its path up to the root
+    void SetLeaf(size_t position, const uint256& leaf);
+};
+
 #endif
\ No newline at end of file
@@ -7,6 +7,7 @@
 
 #include "chainparams.h"
 #include "primitives/transaction.h"
+#include "sapling/sapling_validation.h"
 
 #include <stdint.h>
 #include <vector>
@@ -20,8 +21,9 @@ class CValidationState;
 
 /** Context-independent validity checks */
 bool CheckTransaction(const CTransaction& tx, CValidationState& state, bool fColdStakingActive);
-/** Context-dependent validity checks */
-bool ContextualCheckTransaction(const CTransactionRef& tx, CValidationState& state, const CChainParams& chainparams, int nHeight, bool isMined, bool fIBD);
+/** Context-dependent validity checks (saplingProofResult: outcome of the Sapling proofs verification, if already done) */
+bool ContextualCheckTransaction(const CTransactionRef& tx, CValidationState& state, const CChainParams& chainparams, int nHeight, bool isMined, bool fIBD,
+                                SaplingValidation::ProofCheckResult saplingProofResult = SaplingValidation::ProofCheckResult::UNCHECKED);
 
 /**
  * Count ECDSA signature operations the old-fashioned (pre-0.6) way
@@ -6,6 +6,7 @@
 
 #include "chainparams.h"
 #include "consensus/consensus.h"
+#include "index/txindex.h"
 #include "invalid.h"
 #include "script/interpreter.h"
 #include "txdb.h" // for zerocoinDb
@@ -193,10 +194,23 @@ bool IsSerialInBlockchain(const CBigNum& bnSerial, int& nHeightTx)
     // Now get the chain tx
     CTransactionRef tx;
     uint256 hashBlock;
-    if (!GetTransaction(txHash, tx, hashBlock, true))
-        return false;
+    if (!GetTransaction(txHash, tx, hashBlock, true) || hashBlock.IsNull()) {
+        // While the transaction index is being built, a spend with all its outputs spent
+        // is neither in the index nor in the coins cache: look for it in the blocks where
+        // zerocoin spends were allowed (from the zerocoin activation, until v5 enforcement)
+        if (!g_txindex || g_txindex->GetSummary().synced)
+            return false;
+        const Consensus::Params& consensus = Params().GetConsensus();
+        const int nFirstHeight = consensus.vUpgrades[Consensus::UPGRADE_ZC].nActivationHeight;
+        const int nV5Height = consensus.vUpgrades[Consensus::UPGRADE_V5_0].nActivationHeight;
+        const int nLastHeight = nV5Height == Consensus::NetworkUpgrade::NO_ACTIVATION_HEIGHT ?
+                                WITH_LOCK(cs_main, return chainActive.Height()) : nV5Height - 1;
+        if (nFirstHeight == Consensus::NetworkUpgrade::NO_ACTIVATION_HEIGHT || nLastHeight < nFirstHeight ||
+                !FindTxInActiveChain(txHash, tx, hashBlock, nLastHeight, nFirstHeight))
+            return false;
+    }
 
-    if (hashBlock.IsNull() || !mapBlockIndex.count(hashBlock)) {
+    if (!mapBlockIndex.count(hashBlock)) {
         return false;
     }
 
@@ -162,35 +162,18 @@ static int CompareByLastPaidGetHeight(const CDeterministicGM& dgm)
     return height;
 }
 
-static bool CompareByLastPaid(const CDeterministicGM& _a, const CDeterministicGM& _b)
+// Gamemasters are paid by ascending height (see above), then by ascending proTxHash
+static CDeterministicGMList::GmPayeeQueueKey GetPayeeQueueKey(const CDeterministicGM& dgm)
 {
-    int ah = CompareByLastPaidGetHeight(_a);
-    int bh = CompareByLastPaidGetHeight(_b);
-    if (ah == bh) {
-        return _a.proTxHash < _b.proTxHash;
-    } else {
-        return ah < bh;
-    }
-}
-static bool CompareByLastPaid(const CDeterministicGMCPtr& _a, const CDeterministicGMCPtr& _b)
-{
-    return CompareByLastPaid(*_a, *_b);
+    return {CompareByLastPaidGetHeight(dgm), dgm.proTxHash};
 }
 
 CDeterministicGMCPtr CDeterministicGMList::GetGMPayee() const
 {
-    if (gmMap.size() == 0) {
+    if (gmPayeeQueue.empty()) {
         return nullptr;
     }
-
-    CDeterministicGMCPtr best;
-    ForEachGM(true, [&](const CDeterministicGMCPtr& dgm) {
-        if (!best || CompareByLastPaid(dgm, best)) {
-            best = dgm;
-        }
-    });
-
-    return best;
+    return GetGM(gmPayeeQueue.front().second);
 }
 
 std::vector<CDeterministicGMCPtr> CDeterministicGMList::GetProjectedGMPayees(unsigned int nCount) const
@@ -201,16 +184,9 @@ std::vector<CDeterministicGMCPtr> CDeterministicGMList::GetProjectedGMPayees(uns
 
     std::vector<CDeterministicGMCPtr> result;
     result.reserve(nCount);
-
-    ForEachGM(true, [&](const CDeterministicGMCPtr& dgm) {
-        result.emplace_back(dgm);
-    });
-    std::sort(result.begin(), result.end(), [&](const CDeterministicGMCPtr& a, const CDeterministicGMCPtr& b) {
-        return CompareByLastPaid(a, b);
-    });
-
-    result.resize(nCount);
-
+    for (const auto& key : gmPayeeQueue.take(nCount)) {
+        result.emplace_back(GetGM(key.second));
+    }
     return result;
 }
 
@@ -393,6 +369,7 @@ void CDeterministicGMList::AddGM(const CDeterministicGMCPtr& dgm, bool fBumpTota
 
     gmMap = gmMap.set(dgm->proTxHash, dgm);
     gmInternalIdMap = gmInternalIdMap.set(dgm->GetInternalId(), dgm->proTxHash);
+    AddToPayeeQueue(*dgm);
     AddUniqueProperty(dgm, dgm->collateralOutpoint);
     if (dgm->pdgmState->addr != CService()) {
         AddUniqueProperty(dgm, dgm->pdgmState->addr);
@@ -419,6 +396,12 @@ void CDeterministicGMList::UpdateGM(const CDeterministicGMCPtr& oldDgm, const CD
     dgm->pdgmState = pdgmState;
     gmMap = gmMap.set(oldDgm->proTxHash, dgm);
 
+    // payment, PoSe ban or revival
+    if (oldDgm->IsPoSeBanned() != dgm->IsPoSeBanned() || GetPayeeQueueKey(*oldDgm) != GetPayeeQueueKey(*dgm)) {
+        RemoveFromPayeeQueue(*oldDgm);
+        AddToPayeeQueue(*dgm);
+    }
+
     UpdateUniqueProperty(dgm, oldState->addr, pdgmState->addr);
     UpdateUniqueProperty(dgm, oldState->keyIDOwner, pdgmState->keyIDOwner);
     UpdateUniqueProperty(dgm, oldState->pubKeyOperator, pdgmState->pubKeyOperator);
@@ -457,6 +440,30 @@ void CDeterministicGMList::RemoveGM(const uint256& proTxHash)
 
     gmMap = gmMap.erase(proTxHash);
     gmInternalIdMap = gmInternalIdMap.erase(dgm->GetInternalId());
+    RemoveFromPayeeQueue(*dgm);
+}
+
+void CDeterministicGMList::AddToPayeeQueue(const CDeterministicGM& dgm)
+{
+    if (dgm.IsPoSeBanned()) {
+        return;
+    }
+    const auto key = GetPayeeQueueKey(dgm);
+    auto it = std::lower_bound(gmPayeeQueue.begin(), gmPayeeQueue.end(), key);
+    gmPayeeQueue = gmPayeeQueue.insert(it - gmPayeeQueue.begin(), key);
+}
+
+void CDeterministicGMList::RemoveFromPayeeQueue(const CDeterministicGM& dgm)
+{
+    if (dgm.IsPoSeBanned()) {
+        return;
+    }
+    const auto key = GetPayeeQueueKey(dgm);
+    auto it = std::lower_bound(gmPayeeQueue.begin(), gmPayeeQueue.end(), key);
+    if (it == gmPayeeQueue.end() || *it != key) {
+        throw(std::runtime_error(strprintf("%s: Can't find the gamemaster with proTxHash=%s in the payee queue", __func__, dgm.proTxHash.ToString())));
+    }
+    gmPayeeQueue = gmPayeeQueue.erase(it - gmPayeeQueue.begin());
 }
 
 CDeterministicGMManager::CDeterministicGMManager(CEvoDB& _evoDb) :
@@ -18,6 +18,7 @@
 #include "sync.h"
 #include "version.h"
 
+#include <immer/flex_vector.hpp>
 #include <immer/map.hpp>
 #include <immer/map_transient.hpp>
 
@@ -268,6 +269,9 @@ public:
     typedef immer::map<uint256, CDeterministicGMCPtr> GmMap;
     typedef immer::map<uint64_t, uint256> GmInternalIdMap;
     typedef immer::map<uint256, std::pair<uint256, uint32_t> > GmUniquePropertyMap;
+    // (payment queue height, proTxHash)
+    typedef std::pair<int, uint256> GmPayeeQueueKey;
+    typedef immer::flex_vector<GmPayeeQueueKey> GmPayeeQueue;
 
 private:
     uint256 blockHash;
@@ -280,6 +284,10 @@ private:
     // we keep track of this as checking for duplicates would otherwise be painfully slow
     GmUniquePropertyMap gmUniquePropertyMap;
 
+    // valid (not PoSe-banned) gamemasters, sorted in the order they get paid.
+    // Kept up to date on every change, so that the next payees don't need a full scan of the list.
+    GmPayeeQueue gmPayeeQueue;
+
 public:
     CDeterministicGMList() {}
     explicit CDeterministicGMList(const uint256& _blockHash, int _height, uint32_t _totalRegisteredCount) :
@@ -307,6 +315,7 @@ public:
         gmMap = GmMap();
         gmUniquePropertyMap = GmUniquePropertyMap();
         gmInternalIdMap = GmInternalIdMap();
+        gmPayeeQueue = GmPayeeQueue();
 
         s >> blockHash;
         s >> nHeight;
@@ -325,13 +334,7 @@ public:
 
     size_t GetValidGMsCount() const
     {
-        size_t count = 0;
-        for (const auto& p : gmMap) {
-            if (!p.second->IsPoSeBanned()) {
-                count++;
-            }
-        }
-        return count;
+        return gmPayeeQueue.size();
     }
 
     template <typename Callback>
@@ -447,6 +450,9 @@ public:
     }
 
 private:
+    void AddToPayeeQueue(const CDeterministicGM& dgm);
+    void RemoveFromPayeeQueue(const CDeterministicGM& dgm);
+
     template <typename T>
     void AddUniqueProperty(const CDeterministicGMCPtr& dgm, const T& v)
     {
@@ -11,6 +11,7 @@
 #include "gamemaster-sync.h"
 #include "gamemaster.h"
 #include "gamemasterman.h"
+#include "index/txindex.h"
 #include "netmessagemaker.h"
 #include "tiertwo/netfulfilledman.h"
 #include "spork.h"
@@ -48,8 +49,9 @@ void CGamemasterSync::UpdateBlockchainSynced(bool isRegTestNet)
         blockTime = g_best_block_time;
     }
 
-    // Synced only if the last block happened in the last 60 minutes
-    bool is_chain_synced = blockTime + 60 * 60 > lastProcess;
+    // Synced only if the last block happened in the last 60 minutes,
+    // and the transaction index (used to check the budget collaterals) caught up
+    bool is_chain_synced = blockTime + 60 * 60 > lastProcess && (!g_txindex || g_txindex->GetSummary().synced);
     g_tiertwo_sync_state.SetBlockchainSync(is_chain_synced, lastProcess);
 }
 
@@ -0,0 +1,219 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "index/addressindex.h"
+
+#include "coins.h"
+#include "hash.h"
+#include "invalid.h"
+#include "undo.h"
+#include "util/system.h"
+#include "validation.h"
+
+constexpr char DB_ADDRESSINDEX = 'a';
+constexpr char DB_ADDRESSUNSPENT = 'u';
+constexpr char DB_SPENTINDEX = 'p';
+
+std::unique_ptr<AddressIndex> g_addressindex;
+
+uint160 GetScriptIndexHash(const CScript& script)
+{
+    return Hash160(script.begin(), script.end());
+}
+
+/** Outputs that can be spent, and so are indexed */
+static bool IsIndexedOutput(const CTxOut& out)
+{
+    return !out.scriptPubKey.empty() && !out.scriptPubKey.IsUnspendable() && !out.IsZerocoinMint();
+}
+
+/**
+ * Access to the address index database (indexes/addressindex/)
+ *
+ * 'a' + CAddressIndexKey -> CAmount: the credits (positive) and debits (negative) of a script
+ * 'u' + CAddressUnspentKey -> CAddressUnspentValue: the unspent outputs of a script
+ * 'p' + COutPoint -> CSpentIndexValue: the input spending an output
+ */
+class AddressIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+AddressIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe)
+{}
+
+AddressIndex::AddressIndex(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    m_db(new AddressIndex::DB(n_cache_size, f_memory, f_wipe))
+{}
+
+AddressIndex::~AddressIndex() {}
+
+bool AddressIndex::WriteBlockToBatch(CDBBatch& batch, const CBlock& block, const CBlockIndex* pindex, bool fUndo)
+{
+    // The outputs of the genesis block are not spendable
+    if (pindex->nHeight == 0) return true;
+
+    CBlockUndo blockundo;
+    const FlatFilePos pos = WITH_LOCK(cs_main, return pindex->GetUndoPos());
+    if (pos.IsNull() || !UndoReadFromDisk(blockundo, pos, pindex->pprev->GetBlockHash())) {
+        return error("%s: failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    if (blockundo.vtxundo.size() + 1 != block.vtx.size()) {
+        return error("%s: block and undo data inconsistent for block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    const uint32_t nHeight = pindex->nHeight;
+    const size_t nTxs = block.vtx.size();
+    for (size_t n = 0; n < nTxs; n++) {
+        // Undo in reverse order, so that the outputs created and spent in the block are left out
+        const size_t i = fUndo ? nTxs - 1 - n : n;
+        const CTransaction& tx = *block.vtx[i];
+        const uint256& txid = tx.GetHash();
+
+        if (fUndo) {
+            for (uint32_t o = 0; o < tx.vout.size(); o++) {
+                const CTxOut& out = tx.vout[o];
+                if (!IsIndexedOutput(out)) continue;
+                const uint160 scriptHash = GetScriptIndexHash(out.scriptPubKey);
+                batch.Erase(std::make_pair(DB_ADDRESSINDEX, CAddressIndexKey(scriptHash, nHeight, txid, o, false)));
+                batch.Erase(std::make_pair(DB_ADDRESSUNSPENT, CAddressUnspentKey(scriptHash, COutPoint(txid, o))));
+            }
+        }
+
+        // Coinbase and zerocoin spends have no undo data of their inputs
+        if (i > 0 && !tx.HasZerocoinSpendInputs()) {
+            const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+            if (txundo.vprevout.size() != tx.vin.size()) {
+                return error("%s: transaction and undo data inconsistent for tx %s", __func__, txid.ToString());
+            }
+            for (uint32_t j = 0; j < tx.vin.size(); j++) {
+                const Coin& prev = txundo.vprevout[j];
+                if (!IsIndexedOutput(prev.out)) continue;
+                const uint160 scriptHash = GetScriptIndexHash(prev.out.scriptPubKey);
+                const COutPoint& prevout = tx.vin[j].prevout;
+                const auto key = std::make_pair(DB_ADDRESSINDEX, CAddressIndexKey(scriptHash, nHeight, txid, j, true));
+                const auto unspentKey = std::make_pair(DB_ADDRESSUNSPENT, CAddressUnspentKey(scriptHash, prevout));
+                if (fUndo) {
+                    batch.Erase(key);
+                    batch.Write(unspentKey, CAddressUnspentValue(prev.out.nValue, prev.out.scriptPubKey, prev.nHeight));
+                    batch.Erase(std::make_pair(DB_SPENTINDEX, prevout));
+                } else {
+                    batch.Write(key, -prev.out.nValue);
+                    batch.Erase(unspentKey);
+                    batch.Write(std::make_pair(DB_SPENTINDEX, prevout), CSpentIndexValue(txid, j, nHeight, prev.out.nValue, scriptHash));
+                }
+            }
+        }
+
+        if (!fUndo) {
+            for (uint32_t o = 0; o < tx.vout.size(); o++) {
+                const CTxOut& out = tx.vout[o];
+                const COutPoint outpoint(txid, o);
+                // Banned outputs are not added to the UTXO set (see AddCoins)
+                if (!IsIndexedOutput(out) || (SkipInvalidUTXOS(nHeight) && invalid_out::ContainsOutPoint(outpoint))) continue;
+                const uint160 scriptHash = GetScriptIndexHash(out.scriptPubKey);
+                batch.Write(std::make_pair(DB_ADDRESSINDEX, CAddressIndexKey(scriptHash, nHeight, txid, o, false)), out.nValue);
+                batch.Write(std::make_pair(DB_ADDRESSUNSPENT, CAddressUnspentKey(scriptHash, outpoint)),
+                            CAddressUnspentValue(out.nValue, out.scriptPubKey, nHeight));
+            }
+        }
+    }
+    return true;
+}
+
+bool AddressIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    CDBBatch batch(CLIENT_VERSION);
+    if (!WriteBlockToBatch(batch, block, pindex, false)) {
+        return false;
+    }
+    // The entries are not idempotent: write them with the locator, atomically
+    m_db->WriteBestBlock(batch, WITH_LOCK(cs_main, return chainActive.GetLocator(pindex)));
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    for (const CBlockIndex* pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex)) {
+            return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+        CDBBatch batch(CLIENT_VERSION);
+        if (!WriteBlockToBatch(batch, block, pindex, true)) {
+            return false;
+        }
+        m_db->WriteBestBlock(batch, WITH_LOCK(cs_main, return chainActive.GetLocator(pindex->pprev)));
+        if (!m_db->WriteBatch(batch)) {
+            return error("%s: failed to undo block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+BaseIndex::DB& AddressIndex::GetDB() const { return *m_db; }
+
+bool AddressIndex::GetAddressIndex(const uint160& scriptHash, std::vector<std::pair<CAddressIndexKey, CAmount>>& entries,
+                                   int nStart, int nEnd) const
+{
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(scriptHash, std::max(nStart, 0))));
+    for (; pcursor->Valid(); pcursor->Next()) {
+        std::pair<char, CAddressIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSINDEX || key.second.scriptHash != scriptHash) {
+            break;
+        }
+        if (nEnd > 0 && key.second.nHeight > (uint32_t) nEnd) {
+            break;
+        }
+        CAmount nValue;
+        if (!pcursor->GetValue(nValue)) {
+            return error("%s: failed to read address index entry", __func__);
+        }
+        entries.emplace_back(key.second, nValue);
+    }
+    return true;
+}
+
+bool AddressIndex::GetAddressUnspent(const uint160& scriptHash, std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>& unspent) const
+{
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENT, scriptHash));
+    for (; pcursor->Valid(); pcursor->Next()) {
+        std::pair<char, CAddressUnspentKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSUNSPENT || key.second.scriptHash != scriptHash) {
+            break;
+        }
+        CAddressUnspentValue value;
+        if (!pcursor->GetValue(value)) {
+            return error("%s: failed to read address unspent entry", __func__);
+        }
+        unspent.emplace_back(key.second, value);
+    }
+    return true;
+}
+
+bool AddressIndex::GetAddressBalance(const uint160& scriptHash, CAmount& nBalance, CAmount& nReceived) const
+{
+    std::vector<std::pair<CAddressIndexKey, CAmount>> entries;
+    if (!GetAddressIndex(scriptHash, entries)) {
+        return false;
+    }
+    nBalance = nReceived = 0;
+    for (const auto& entry : entries) {
+        nBalance += entry.second;
+        if (entry.second > 0) nReceived += entry.second;
+    }
+    return true;
+}
+
+bool AddressIndex::GetSpentInfo(const COutPoint& outpoint, CSpentIndexValue& value) const
+{
+    return m_db->Read(std::make_pair(DB_SPENTINDEX, outpoint), value);
+}
@@ -0,0 +1,143 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#ifndef Hemis_INDEX_ADDRESSINDEX_H
+#define Hemis_INDEX_ADDRESSINDEX_H
+
+#include "amount.h"
+#include "index/base.h"
+#include "primitives/transaction.h"
+#include "script/script.h"
+#include "serialize.h"
+#include "uint256.h"
+
+#include <memory>
+#include <vector>
+
+static const bool DEFAULT_ADDRESSINDEX = false;
+
+/** The key of the outputs of a script in the address index: the hash160 of the scriptPubKey */
+uint160 GetScriptIndexHash(const CScript& script);
+
+/** A credit (output) or debit (spent input) of a script, ordered by height */
+struct CAddressIndexKey {
+    uint160 scriptHash;
+    uint32_t nHeight{0};
+    uint256 txid;
+    uint32_t nIndex{0};
+    bool fSpending{false};
+
+    CAddressIndexKey() = default;
+    CAddressIndexKey(const uint160& _scriptHash, uint32_t _nHeight, const uint256& _txid, uint32_t _nIndex, bool _fSpending) :
+        scriptHash(_scriptHash), nHeight(_nHeight), txid(_txid), nIndex(_nIndex), fSpending(_fSpending) {}
+
+    // The height is big endian, so that the entries of a script are sorted by height
+    SERIALIZE_METHODS(CAddressIndexKey, obj) { READWRITE(obj.scriptHash, Using<BigEndianFormatter<4>>(obj.nHeight), obj.txid, obj.nIndex, obj.fSpending); }
+};
+
+/** Prefix of CAddressIndexKey, to seek the entries of a script from a given height */
+struct CAddressIndexIteratorKey {
+    uint160 scriptHash;
+    uint32_t nHeight{0};
+
+    CAddressIndexIteratorKey() = default;
+    CAddressIndexIteratorKey(const uint160& _scriptHash, uint32_t _nHeight) : scriptHash(_scriptHash), nHeight(_nHeight) {}
+
+    SERIALIZE_METHODS(CAddressIndexIteratorKey, obj) { READWRITE(obj.scriptHash, Using<BigEndianFormatter<4>>(obj.nHeight)); }
+};
+
+/** An unspent output of a script */
+struct CAddressUnspentKey {
+    uint160 scriptHash;
+    COutPoint outpoint;
+
+    CAddressUnspentKey() = default;
+    CAddressUnspentKey(const uint160& _scriptHash, const COutPoint& _outpoint) : scriptHash(_scriptHash), outpoint(_outpoint) {}
+
+    SERIALIZE_METHODS(CAddressUnspentKey, obj) { READWRITE(obj.scriptHash, obj.outpoint); }
+};
+
+struct CAddressUnspentValue {
+    CAmount nValue{0};
+    CScript script;
+    int nHeight{0};
+
+    CAddressUnspentValue() = default;
+    CAddressUnspentValue(CAmount _nValue, const CScript& _script, int _nHeight) : nValue(_nValue), script(_script), nHeight(_nHeight) {}
+
+    SERIALIZE_METHODS(CAddressUnspentValue, obj) { READWRITE(obj.nValue, obj.script, obj.nHeight); }
+};
+
+/** The input spending an output */
+struct CSpentIndexValue {
+    uint256 txid;
+    uint32_t nInputIndex{0};
+    int nHeight{0};
+    CAmount nValue{0};
+    uint160 scriptHash;
+
+    CSpentIndexValue() = default;
+    CSpentIndexValue(const uint256& _txid, uint32_t _nInputIndex, int _nHeight, CAmount _nValue, const uint160& _scriptHash) :
+        txid(_txid), nInputIndex(_nInputIndex), nHeight(_nHeight), nValue(_nValue), scriptHash(_scriptHash) {}
+
+    SERIALIZE_METHODS(CSpentIndexValue, obj) { READWRITE(obj.txid, obj.nInputIndex, obj.nHeight, obj.nValue, obj.scriptHash); }
+};
+
+/**
+ * AddressIndex is used to look up the history, unspent outputs and balance of
+ * a script (address), and the input spending an output, without scanning the
+ * UTXO set. Only transparent outputs are indexed.
+ *
+ * The index has the data of a block written in one batch, together with its
+ * locator, and undoes it (from the block undo data) when the block is
+ * disconnected, so that it is consistent with the chain it is synced to.
+ */
+class AddressIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    /// Add (or, if fUndo, remove) the entries of a block to the batch
+    bool WriteBlockToBatch(CDBBatch& batch, const CBlock& block, const CBlockIndex* pindex, bool fUndo);
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    /// The locator is written with the entries of each block.
+    void SetBestChain(const CBlockLocator& locator) override {}
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "addressindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~AddressIndex() override;
+
+    /// Get the credits and debits of a script, between the given heights (0 for no end)
+    bool GetAddressIndex(const uint160& scriptHash, std::vector<std::pair<CAddressIndexKey, CAmount>>& entries,
+                         int nStart = 0, int nEnd = 0) const;
+
+    /// Get the unspent outputs of a script
+    bool GetAddressUnspent(const uint160& scriptHash, std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>& unspent) const;
+
+    /// Get the received amount and the balance of a script
+    bool GetAddressBalance(const uint160& scriptHash, CAmount& nBalance, CAmount& nReceived) const;
+
+    /// Get the input spending an output. Returns false if the output is unspent (or not indexed).
+    bool GetSpentInfo(const COutPoint& outpoint, CSpentIndexValue& value) const;
+};
+
+/// The global address index. May be null.
+extern std::unique_ptr<AddressIndex> g_addressindex;
+
+#endif // Hemis_INDEX_ADDRESSINDEX_H
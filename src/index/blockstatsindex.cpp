@@ -0,0 +1,172 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "index/blockstatsindex.h"
+
+#include "chain.h"
+#include "clientversion.h"
+#include "coins.h"
+#include "undo.h"
+#include "util/system.h"
+#include "validation.h"
+
+constexpr char DB_BLOCKSTATS = 's';
+
+std::unique_ptr<BlockStatsIndex> g_blockstatsindex;
+
+CBlockIndexStats& CBlockIndexStats::operator+=(const CBlockIndexStats& other)
+{
+    nTxCount += other.nTxCount;
+    nTxCountAll += other.nTxCountAll;
+    nTxBytes += other.nTxBytes;
+    nFees += other.nFees;
+    nShieldedValueIn += other.nShieldedValueIn;
+    nShieldedValueOut += other.nShieldedValueOut;
+    return *this;
+}
+
+bool ComputeBlockIndexStats(const CBlock& block, const CBlockUndo& blockundo, CBlockIndexStats& stats)
+{
+    if (blockundo.vtxundo.size() + 1 != block.vtx.size()) {
+        return error("%s: block and undo data inconsistent for block %s", __func__, block.GetHash().ToString());
+    }
+
+    stats = CBlockIndexStats();
+    stats.hashBlock = block.GetHash();
+    const size_t nTxs = block.vtx.size();
+    const size_t firstTxIndex = block.IsProofOfStake() ? 2 : 1;
+    stats.nTxCountAll = nTxs;
+    stats.nTxCount = nTxs > firstTxIndex ? nTxs - firstTxIndex : 0;
+
+    for (size_t i = 0; i < nTxs; i++) {
+        const CTransaction& tx = *block.vtx[i];
+
+        if (tx.hasSaplingData()) {
+            stats.nShieldedValueIn += tx.GetShieldedValueIn();
+            if (tx.sapData->valueBalance < 0) stats.nShieldedValueOut += -tx.sapData->valueBalance;
+        }
+
+        // zerocoin txes have fixed fee, don't count them here.
+        if (i < firstTxIndex || tx.ContainsZerocoins()) continue;
+
+        const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+        if (txundo.vprevout.size() != tx.vin.size()) {
+            return error("%s: transaction and undo data inconsistent for tx %s", __func__, tx.GetHash().ToString());
+        }
+
+        CAmount nValueIn = tx.GetShieldedValueIn();
+        for (const Coin& prev : txundo.vprevout) {
+            nValueIn += prev.out.nValue;
+        }
+        stats.nTxBytes += GetSerializeSize(tx, CLIENT_VERSION);
+        stats.nFees += nValueIn - tx.GetValueOut();
+    }
+    return true;
+}
+
+bool ReadBlockIndexStats(const CBlockIndex* pindex, CBlockIndexStats& stats)
+{
+    CBlock block;
+    if (!ReadBlockFromDisk(block, pindex)) {
+        return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    CBlockUndo blockundo;
+    if (pindex->nHeight > 0) {
+        const FlatFilePos pos = WITH_LOCK(cs_main, return pindex->GetUndoPos());
+        if (pos.IsNull() || !UndoReadFromDisk(blockundo, pos, pindex->pprev->GetBlockHash())) {
+            return error("%s: failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+    }
+    return ComputeBlockIndexStats(block, blockundo, stats);
+}
+
+/**
+ * Access to the block statistics database (indexes/blockstatsindex/)
+ *
+ * 's' + big endian height -> CBlockIndexStats: the statistics of the block at
+ * that height on the chain the index was synced to
+ */
+class BlockStatsIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+BlockStatsIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "blockstatsindex", n_cache_size, f_memory, f_wipe)
+{}
+
+/** The key of the statistics of a block: big endian, so that they are sorted by height */
+struct BlockStatsKey {
+    uint32_t nHeight{0};
+
+    BlockStatsKey() = default;
+    explicit BlockStatsKey(int _nHeight) : nHeight(_nHeight) {}
+
+    SERIALIZE_METHODS(BlockStatsKey, obj) { READWRITE(Using<BigEndianFormatter<4>>(obj.nHeight)); }
+};
+
+BlockStatsIndex::BlockStatsIndex(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    m_db(new BlockStatsIndex::DB(n_cache_size, f_memory, f_wipe))
+{}
+
+BlockStatsIndex::~BlockStatsIndex() {}
+
+bool BlockStatsIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    CBlockUndo blockundo;
+    if (pindex->nHeight > 0) {
+        const FlatFilePos pos = WITH_LOCK(cs_main, return pindex->GetUndoPos());
+        if (pos.IsNull() || !UndoReadFromDisk(blockundo, pos, pindex->pprev->GetBlockHash())) {
+            return error("%s: failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+    }
+    CBlockIndexStats stats;
+    if (!ComputeBlockIndexStats(block, blockundo, stats)) {
+        return false;
+    }
+    return m_db->Write(std::make_pair(DB_BLOCKSTATS, BlockStatsKey(pindex->nHeight)), stats);
+}
+
+BaseIndex::DB& BlockStatsIndex::GetDB() const { return *m_db; }
+
+bool BlockStatsIndex::LookupStats(const CBlockIndex* pindex, CBlockIndexStats& stats) const
+{
+    return m_db->Read(std::make_pair(DB_BLOCKSTATS, BlockStatsKey(pindex->nHeight)), stats) &&
+           stats.hashBlock == pindex->GetBlockHash();
+}
+
+bool BlockStatsIndex::LookupStatsRange(int nStartHeight, const CBlockIndex* pindexEnd, CBlockIndexStats& total) const
+{
+    if (nStartHeight < 0 || nStartHeight > pindexEnd->nHeight) {
+        return error("%s: start height %d out of range", __func__, nStartHeight);
+    }
+
+    // The hashes of the blocks of the range, by height
+    std::vector<uint256> vHashes(pindexEnd->nHeight - nStartHeight + 1);
+    for (const CBlockIndex* pindex = pindexEnd; pindex && pindex->nHeight >= nStartHeight; pindex = pindex->pprev) {
+        vHashes[pindex->nHeight - nStartHeight] = pindex->GetBlockHash();
+    }
+
+    total = CBlockIndexStats();
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(DB_BLOCKSTATS, BlockStatsKey(nStartHeight)));
+    for (int nHeight = nStartHeight; nHeight <= pindexEnd->nHeight; nHeight++, pcursor->Next()) {
+        std::pair<char, BlockStatsKey> key;
+        if (!pcursor->Valid() || !pcursor->GetKey(key) || key.first != DB_BLOCKSTATS ||
+            key.second.nHeight != (uint32_t) nHeight) {
+            return false;
+        }
+        CBlockIndexStats stats;
+        if (!pcursor->GetValue(stats)) {
+            return error("%s: failed to read block stats entry at height %d", __func__, nHeight);
+        }
+        // A block disconnected from the chain the range is on
+        if (stats.hashBlock != vHashes[nHeight - nStartHeight]) {
+            return false;
+        }
+        total += stats;
+    }
+    return true;
+}
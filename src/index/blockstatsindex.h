@@ -0,0 +1,87 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#ifndef Hemis_INDEX_BLOCKSTATSINDEX_H
+#define Hemis_INDEX_BLOCKSTATSINDEX_H
+
+#include "amount.h"
+#include "index/base.h"
+#include "serialize.h"
+#include "uint256.h"
+
+#include <memory>
+
+static const bool DEFAULT_BLOCKSTATSINDEX = false;
+
+class CBlockUndo;
+
+/**
+ * Transaction and fee statistics of a block (or, summed, of a range of blocks).
+ * The coinbase and coinstake transactions are only counted in nTxCountAll, and
+ * the zerocoin transactions (which have a fixed fee) are left out of the size
+ * and fee totals.
+ */
+struct CBlockIndexStats {
+    uint256 hashBlock;              //!< the block (unused for a range)
+    int64_t nTxCount{0};            //!< transactions, excluding the coinbase/coinstake
+    int64_t nTxCountAll{0};         //!< transactions, including the coinbase/coinstake
+    int64_t nTxBytes{0};            //!< serialized size of the transactions
+    CAmount nFees{0};               //!< fees paid by the transactions
+    CAmount nShieldedValueIn{0};    //!< value moved out of the shield pool
+    CAmount nShieldedValueOut{0};   //!< value moved into the shield pool
+
+    CBlockIndexStats& operator+=(const CBlockIndexStats& other);
+
+    SERIALIZE_METHODS(CBlockIndexStats, obj) { READWRITE(obj.hashBlock, obj.nTxCount, obj.nTxCountAll, obj.nTxBytes, obj.nFees, obj.nShieldedValueIn, obj.nShieldedValueOut); }
+};
+
+/** Compute the statistics of a block, with the coins it spends taken from its undo data */
+bool ComputeBlockIndexStats(const CBlock& block, const CBlockUndo& blockundo, CBlockIndexStats& stats);
+
+/** Compute the statistics of a block, reading the block and its undo data from disk */
+bool ReadBlockIndexStats(const CBlockIndex* pindex, CBlockIndexStats& stats);
+
+/**
+ * BlockStatsIndex stores the statistics of each block by height, so that the
+ * fee and size totals of a range of blocks can be read without reading the
+ * blocks, and the transactions they spend, from disk.
+ *
+ * The entries are overwritten when a block at the same height is connected,
+ * and carry the hash of their block, so that the ones of disconnected blocks
+ * are not returned.
+ */
+class BlockStatsIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "blockstatsindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit BlockStatsIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~BlockStatsIndex() override;
+
+    /// Get the statistics of a block. Returns false if the block is not indexed.
+    bool LookupStats(const CBlockIndex* pindex, CBlockIndexStats& stats) const;
+
+    /// Sum the statistics of the blocks from nStartHeight to pindexEnd, on the chain of
+    /// pindexEnd. Returns false if any of them is not indexed.
+    bool LookupStatsRange(int nStartHeight, const CBlockIndex* pindexEnd, CBlockIndexStats& total) const;
+};
+
+/// The global block statistics index. May be null.
+extern std::unique_ptr<BlockStatsIndex> g_blockstatsindex;
+
+#endif // Hemis_INDEX_BLOCKSTATSINDEX_H
@@ -0,0 +1,193 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "index/coinstatsindex.h"
+
+#include "chain.h"
+#include "clientversion.h"
+#include "coins.h"
+#include "invalid.h"
+#include "streams.h"
+#include "undo.h"
+#include "util/system.h"
+#include "validation.h"
+
+constexpr char DB_BLOCK_HEIGHT = 't';
+constexpr char DB_MUHASH = 'M';
+
+std::unique_ptr<CoinStatsIndex> g_coinstatsindex;
+
+void ApplyCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin, bool fRemove)
+{
+    CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+    ss << outpoint;
+    ss << static_cast<uint32_t>(coin.nHeight * 4 + (coin.fCoinBase ? 2u : 0u) + (coin.fCoinStake ? 1u : 0u));
+    ss << coin.out;
+    if (fRemove) {
+        muhash.Remove(MakeUCharSpan(ss));
+    } else {
+        muhash.Insert(MakeUCharSpan(ss));
+    }
+}
+
+/** Outputs added to the UTXO set by a block at nHeight (see AddCoins) */
+static bool IsUTXOSetOutput(const COutPoint& outpoint, const CTxOut& out, int nHeight)
+{
+    return !out.scriptPubKey.IsUnspendable() && !out.IsZerocoinMint() &&
+           !(SkipInvalidUTXOS(nHeight) && invalid_out::ContainsOutPoint(outpoint));
+}
+
+/**
+ * Access to the coin statistics database (indexes/coinstatsindex/)
+ *
+ * 't' + big endian height -> CUTXOSetStats: the statistics after the block at
+ * that height on the chain the index was synced to
+ * 'M' -> MuHash3072: the running MuHash, at the locator
+ */
+class CoinStatsIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+CoinStatsIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "coinstatsindex", n_cache_size, f_memory, f_wipe)
+{}
+
+/** The key of the statistics of a block: big endian, so that they are sorted by height */
+struct CoinStatsKey {
+    uint32_t nHeight{0};
+
+    CoinStatsKey() = default;
+    explicit CoinStatsKey(int _nHeight) : nHeight(_nHeight) {}
+
+    SERIALIZE_METHODS(CoinStatsKey, obj) { READWRITE(Using<BigEndianFormatter<4>>(obj.nHeight)); }
+};
+
+CoinStatsIndex::CoinStatsIndex(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    m_db(new CoinStatsIndex::DB(n_cache_size, f_memory, f_wipe))
+{}
+
+CoinStatsIndex::~CoinStatsIndex() {}
+
+bool CoinStatsIndex::Init()
+{
+    if (!BaseIndex::Init()) {
+        return false;
+    }
+
+    const CBlockIndex* pindex = CurrentIndex();
+    if (!pindex) {
+        return true;
+    }
+
+    // Restore the running state, and check that it is the one of the best block
+    CUTXOSetStats stats;
+    if (!m_db->Read(DB_MUHASH, m_muhash) || !LookupStats(pindex, stats)) {
+        return error("%s: cannot read the state of the index at block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    uint256 hashMuHash;
+    m_muhash.Finalize(hashMuHash);
+    if (hashMuHash != stats.hashMuHash) {
+        return error("%s: the state of the index does not match the block %s, the index may be corrupted",
+                     __func__, pindex->GetBlockHash().ToString());
+    }
+    m_transaction_outputs = stats.nTransactionOutputs;
+    m_total_amount = stats.nTotalAmount;
+    return true;
+}
+
+bool CoinStatsIndex::ApplyBlock(const CBlock& block, const CBlockIndex* pindex, bool fUndo)
+{
+    // The outputs of the genesis block are not added to the UTXO set
+    if (pindex->nHeight == 0) return true;
+
+    CBlockUndo blockundo;
+    const FlatFilePos pos = WITH_LOCK(cs_main, return pindex->GetUndoPos());
+    if (pos.IsNull() || !UndoReadFromDisk(blockundo, pos, pindex->pprev->GetBlockHash())) {
+        return error("%s: failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    if (blockundo.vtxundo.size() + 1 != block.vtx.size()) {
+        return error("%s: block and undo data inconsistent for block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    // The MuHash and the totals do not depend on the order: the outputs created
+    // and spent in the block are added, then removed.
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        const CTransaction& tx = *block.vtx[i];
+        const bool fCoinbase = tx.IsCoinBase();
+        const bool fCoinstake = tx.IsCoinStake();
+
+        for (uint32_t o = 0; o < tx.vout.size(); o++) {
+            const COutPoint outpoint(tx.GetHash(), o);
+            const CTxOut& out = tx.vout[o];
+            if (!IsUTXOSetOutput(outpoint, out, pindex->nHeight)) continue;
+            ApplyCoinHash(m_muhash, outpoint, Coin(out, pindex->nHeight, fCoinbase, fCoinstake), fUndo);
+            m_transaction_outputs += fUndo ? -1 : 1;
+            m_total_amount += fUndo ? -out.nValue : out.nValue;
+        }
+
+        // Coinbase and zerocoin spends have no undo data of their inputs
+        if (i == 0 || tx.HasZerocoinSpendInputs()) continue;
+        const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+        if (txundo.vprevout.size() != tx.vin.size()) {
+            return error("%s: transaction and undo data inconsistent for tx %s", __func__, tx.GetHash().ToString());
+        }
+        for (size_t j = 0; j < tx.vin.size(); j++) {
+            const COutPoint& prevout = tx.vin[j].prevout;
+            const Coin& coin = txundo.vprevout[j];
+            if (!IsUTXOSetOutput(prevout, coin.out, coin.nHeight)) continue;
+            ApplyCoinHash(m_muhash, prevout, coin, !fUndo);
+            m_transaction_outputs += fUndo ? 1 : -1;
+            m_total_amount += fUndo ? coin.out.nValue : -coin.out.nValue;
+        }
+    }
+    return true;
+}
+
+bool CoinStatsIndex::WriteState(const CBlockIndex* pindex)
+{
+    CUTXOSetStats stats;
+    stats.hashBlock = pindex->GetBlockHash();
+    stats.nTransactionOutputs = m_transaction_outputs;
+    stats.nTotalAmount = m_total_amount;
+    m_muhash.Finalize(stats.hashMuHash);
+
+    // The running state is not idempotent: write it with the locator, atomically
+    CDBBatch batch(CLIENT_VERSION);
+    batch.Write(std::make_pair(DB_BLOCK_HEIGHT, CoinStatsKey(pindex->nHeight)), stats);
+    batch.Write(DB_MUHASH, m_muhash);
+    m_db->WriteBestBlock(batch, WITH_LOCK(cs_main, return chainActive.GetLocator(pindex)));
+    return m_db->WriteBatch(batch);
+}
+
+bool CoinStatsIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    return ApplyBlock(block, pindex, false) && WriteState(pindex);
+}
+
+bool CoinStatsIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    for (const CBlockIndex* pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex)) {
+            return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+        if (!ApplyBlock(block, pindex, true) || !WriteState(pindex->pprev)) {
+            return error("%s: failed to undo block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+BaseIndex::DB& CoinStatsIndex::GetDB() const { return *m_db; }
+
+bool CoinStatsIndex::LookupStats(const CBlockIndex* pindex, CUTXOSetStats& stats) const
+{
+    return m_db->Read(std::make_pair(DB_BLOCK_HEIGHT, CoinStatsKey(pindex->nHeight)), stats) &&
+           stats.hashBlock == pindex->GetBlockHash();
+}
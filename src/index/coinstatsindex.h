@@ -0,0 +1,91 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#ifndef Hemis_INDEX_COINSTATSINDEX_H
+#define Hemis_INDEX_COINSTATSINDEX_H
+
+#include "amount.h"
+#include "crypto/muhash.h"
+#include "index/base.h"
+#include "serialize.h"
+#include "uint256.h"
+
+#include <memory>
+
+static const bool DEFAULT_COINSTATSINDEX = false;
+
+class Coin;
+class COutPoint;
+
+/** Add a coin to (or, with fRemove, remove it from) the MuHash of a UTXO set */
+void ApplyCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin, bool fRemove = false);
+
+/** The statistics of the UTXO set after a block */
+struct CUTXOSetStats {
+    uint256 hashBlock;
+    uint256 hashMuHash;
+    uint64_t nTransactionOutputs{0};
+    CAmount nTotalAmount{0};
+
+    SERIALIZE_METHODS(CUTXOSetStats, obj) { READWRITE(obj.hashBlock, obj.hashMuHash, obj.nTransactionOutputs, obj.nTotalAmount); }
+};
+
+/**
+ * CoinStatsIndex maintains the MuHash and the totals of the UTXO set, updated
+ * with the coins created and spent by each block, and stores them by height,
+ * so that the statistics of the UTXO set at the tip (or at a previous block of
+ * the chain) are read without walking the chainstate database.
+ *
+ * The entry of a block is written in one batch with the MuHash state and the
+ * locator, and the blocks are undone (from the block undo data) when they are
+ * disconnected, as in the AddressIndex.
+ */
+class CoinStatsIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    /// The running MuHash and totals, at m_best_block_index
+    MuHash3072 m_muhash;
+    uint64_t m_transaction_outputs{0};
+    CAmount m_total_amount{0};
+
+    /// Apply the coins created and spent by a block (or, if fUndo, revert them)
+    bool ApplyBlock(const CBlock& block, const CBlockIndex* pindex, bool fUndo);
+
+    /// Write the entry of the block, the MuHash state and the locator
+    bool WriteState(const CBlockIndex* pindex);
+
+protected:
+    bool Init() override;
+
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    /// The locator is written with the state of each block.
+    void SetBestChain(const CBlockLocator& locator) override {}
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "coinstatsindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit CoinStatsIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~CoinStatsIndex() override;
+
+    /// Get the statistics of the UTXO set after a block of the chain the index is synced to.
+    bool LookupStats(const CBlockIndex* pindex, CUTXOSetStats& stats) const;
+};
+
+/// The global coin statistics index. May be null.
+extern std::unique_ptr<CoinStatsIndex> g_coinstatsindex;
+
+#endif // Hemis_INDEX_COINSTATSINDEX_H
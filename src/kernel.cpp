@@ -7,6 +7,7 @@
 
 #include "kernel.h"
 
+#include "crypto/common.h"
 #include "db.h"
 #include "legacy/stakemodifier.h"
 #include "policy/policy.h"
@@ -26,6 +27,7 @@
  * @param[in]   nTimeTx         time of the kernel block
  */
 CStakeKernel::CStakeKernel(const CBlockIndex* const pindexPrev, CStakeInput* stakeInput, unsigned int nBits, int nTimeTx):
+    pindexPrev(pindexPrev),
     stakeUniqueness(stakeInput->GetUniqueness()),
     nTime(nTimeTx),
     nBits(nBits),
@@ -44,24 +46,43 @@ CStakeKernel::CStakeKernel(const CBlockIndex* const pindexPrev, CStakeInput* sta
     }
     const CBlockIndex* pindexFrom = stakeInput->GetIndexFrom();
     nTimeBlockFrom = pindexFrom->nTime;
+
+    // Hash the fixed part of the kernel message once
+    CDataStream ss(stakeModifier);
+    ss << nTimeBlockFrom << stakeUniqueness;
+    hasherPrefix.Write((const unsigned char*)ss.data(), ss.size());
+
+    // Get weighted target
+    bnTarget.SetCompact(nBits);
+    bnTarget *= (arith_uint256(stakeValue) / 100);
 }
 
-// Return stake kernel hash
-uint256 CStakeKernel::GetHash() const
+// Return stake kernel hash for the block time nTimeTx
+uint256 CStakeKernel::GetHash(int nTimeTx) const
 {
-    CDataStream ss(stakeModifier);
-    ss << nTimeBlockFrom << stakeUniqueness << nTime;
-    return Hash(ss.begin(), ss.end());
+    unsigned char vchTime[4];
+    WriteLE32(vchTime, (uint32_t)nTimeTx);
+    CHash256 hasher(hasherPrefix);
+    uint256 hash;
+    hasher.Write(vchTime, sizeof(vchTime)).Finalize(hash.begin());
+    return hash;
+}
+
+// Check (without logging) that the kernel hash for the block time nTimeTx meets the target required
+bool CStakeKernel::CheckKernelHashAtTime(int nTimeTx) const
+{
+    return UintToArith256(GetHash(nTimeTx)) < bnTarget;
+}
+
+// Whether this kernel can be reused to stake on top of pindexPrev with difficulty nBits
+bool CStakeKernel::IsValidFor(const CBlockIndex* _pindexPrev, unsigned int _nBits) const
+{
+    return pindexPrev == _pindexPrev && nBits == _nBits;
 }
 
 // Check that the kernel hash meets the target required
 bool CStakeKernel::CheckKernelHash(bool fSkipLog) const
 {
-    // Get weighted target
-    arith_uint256 bnTarget;
-    bnTarget.SetCompact(nBits);
-    bnTarget *= (arith_uint256(stakeValue) / 100);
-
     // Check PoS kernel hash
     const arith_uint256& hashProofOfStake = UintToArith256(GetHash());
     const bool res = hashProofOfStake < bnTarget;
@@ -126,6 +147,25 @@ bool Stake(const CBlockIndex* pindexPrev, CStakeInput* stakeInput, unsigned int
     return stakeKernel.CheckKernelHash(true);
 }
 
+/*
+ * Stake                Check if a precomputed stake kernel can stake a block on top of pindexPrev
+ *
+ * @param[in]   pindexPrev      index of the parent block of the block being staked
+ * @param[in]   stakeKernel     kernel of the coinstake input (must be valid for pindexPrev)
+ * @param[in]   nTimeTx         new blocktime
+ * @return      bool            true if stake kernel hash meets target protocol
+ */
+bool Stake(const CBlockIndex* pindexPrev, const CStakeKernel& stakeKernel, int64_t& nTimeTx)
+{
+    // Get the new time slot (and verify it's not the same as previous block)
+    const bool fRegTest = Params().IsRegTestNet();
+    nTimeTx = (fRegTest ? GetAdjustedTime() : GetCurrentTimeSlot());
+    if (nTimeTx <= pindexPrev->nTime && !fRegTest) return false;
+
+    // Verify Proof Of Stake
+    return stakeKernel.CheckKernelHashAtTime(nTimeTx);
+}
+
 
 /*
  * CheckProofOfStake    Check if block has valid proof of stake
@@ -8,6 +8,8 @@
 #ifndef Hemis_KERNEL_H
 #define Hemis_KERNEL_H
 
+#include "arith_uint256.h"
+#include "hash.h"
 #include "stakeinput.h"
 
 class CStakeKernel {
@@ -23,20 +25,34 @@ public:
     CStakeKernel(const CBlockIndex* const pindexPrev, CStakeInput* stakeInput, unsigned int nBits, int nTimeTx);
 
     // Return stake kernel hash
-    uint256 GetHash() const;
+    uint256 GetHash() const { return GetHash(nTime); }
+
+    // Return stake kernel hash for the block time nTimeTx.
+    // Only the time is hashed on top of the precomputed message prefix (no allocations).
+    uint256 GetHash(int nTimeTx) const;
 
     // Check that the kernel hash meets the target required
     bool CheckKernelHash(bool fSkipLog = false) const;
 
+    // Check (without logging) that the kernel hash for the block time nTimeTx meets the target required
+    bool CheckKernelHashAtTime(int nTimeTx) const;
+
+    // Whether this kernel can be reused to stake on top of pindexPrev with difficulty nBits
+    bool IsValidFor(const CBlockIndex* pindexPrev, unsigned int nBits) const;
+
 private:
+    const CBlockIndex* pindexPrev{nullptr};
     // kernel message hashed
     CDataStream stakeModifier{CDataStream(SER_GETHASH, 0)};
     int nTimeBlockFrom{0};
     CDataStream stakeUniqueness{CDataStream(SER_GETHASH, 0)};
     int nTime{0};
+    // SHA-256 midstate of the kernel message, up to (excluding) nTime
+    CHash256 hasherPrefix;
     // hash target
     unsigned int nBits{0};     // difficulty for the target
     CAmount stakeValue{0};     // target multiplier
+    arith_uint256 bnTarget;    // weighted target
 };
 
 /* PoS Validation */
@@ -52,6 +68,16 @@ private:
  */
 bool Stake(const CBlockIndex* pindexPrev, CStakeInput* stakeInput, unsigned int nBits, int64_t& nTimeTx);
 
+/*
+ * Stake                Check if a precomputed stake kernel can stake a block on top of pindexPrev
+ *
+ * @param[in]   pindexPrev      index of the parent block of the block being staked
+ * @param[in]   stakeKernel     kernel of the coinstake input (must be valid for pindexPrev)
+ * @param[in]   nTimeTx         new blocktime
+ * @return      bool            true if stake kernel hash meets target protocol
+ */
+bool Stake(const CBlockIndex* pindexPrev, const CStakeKernel& stakeKernel, int64_t& nTimeTx);
+
 /*
  * CheckProofOfStake    Check if block has valid proof of stake
  *
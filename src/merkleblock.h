@@ -8,6 +8,7 @@
 #define BITCOIN_MERKLEBLOCK_H
 
 #include "bloom.h"
+#include "consensus/merkle.h"
 #include "primitives/block.h"
 #include "serialize.h"
 #include "uint256.h"
@@ -73,11 +74,8 @@ protected:
         return (nTransactions + (1 << height) - 1) >> height;
     }
 
-    /** calculate the hash of a node in the merkle tree (at leaf level: the txid's themselves) */
-    uint256 CalcHash(int height, unsigned int pos, const std::vector<uint256>& vTxid);
-
-    /** recursive function that traverses tree nodes, storing the data as bits and hashes */
-    void TraverseAndBuild(int height, unsigned int pos, const std::vector<uint256>& vTxid, const std::vector<bool>& vMatch);
+    /** recursive function that traverses tree nodes, storing the data as bits and hashes (taken from the full tree) */
+    void TraverseAndBuild(int height, unsigned int pos, const CMerkleTree& tree, const std::vector<bool>& vMatch);
 
     /**
      * recursive function that traverses tree nodes, consuming the bits and hashes produced by TraverseAndBuild.
@@ -23,6 +23,7 @@
 #include "util/system.h"
 #include "utilmoneystr.h"
 #ifdef ENABLE_WALLET
+#include "wallet/stakescheduler.h"
 #include "wallet/wallet.h"
 #endif
 #include "invalid.h"
@@ -152,7 +153,19 @@ void BitcoinMiner(CWallet* pwallet, bool fProofOfStake)
             if (pwallet->pStakerStatus &&
                     pwallet->pStakerStatus->GetLastHash() == pindexPrev->GetBlockHash() &&
                     pwallet->pStakerStatus->GetLastTime() >= GetCurrentTimeSlot()) {
-                MilliSleep(2000);
+                if (stakeScheduler && CStakeScheduler::CanSchedule(pindexPrev)) {
+                    // Sleep until the next time slot with a kernel (or a new tip)
+                    stakeScheduler->Update(pindexPrev, availableCoins);
+                    const int64_t nSlotTime = stakeScheduler->WaitForNextSlot(pindexPrev);
+                    if (nSlotTime > 0) {
+                        stakeScheduler->PrioritizeCoins(nSlotTime, availableCoins);
+                    } else {
+                        // Woken up before the slot: the coins could have changed
+                        fStakeableCoins = pwallet->StakeableCoins(&availableCoins);
+                    }
+                } else {
+                    MilliSleep(2000);
+                }
                 continue;
             }
 
@@ -181,12 +194,13 @@ void BitcoinMiner(CWallet* pwallet, bool fProofOfStake)
                 LogPrintf("%s: New block orphaned\n", __func__);
                 continue;
             }
+            if (stakeScheduler) stakeScheduler->BlockSubmitted(pblock->nTime);
             SetThreadPriority(THREAD_PRIORITY_LOWEST);
             continue;
         }
 
         // POW - miner main
-        IncrementExtraNonce(pblock, pindexPrev->nHeight + 1, nExtraNonce);
+        IncrementExtraNonce(pblock, pindexPrev->nHeight + 1, nExtraNonce, &pblocktemplate->merkleTree);
 
         LogPrintf("Running HemisMiner with %u transactions in block (%u bytes)\n", pblock->vtx.size(),
             ::GetSerializeSize(*pblock, PROTOCOL_VERSION));
@@ -715,6 +715,9 @@ QString formatServicesStr(quint64 mask)
             case NODE_BLOOM_WITHOUT_GM:
                 strList.append(QObject::tr("BLOOM"));
                 break;
+            case NODE_COMPACT_FILTERS:
+                strList.append(QObject::tr("COMPACT_FILTERS"));
+                break;
             default:
                 strList.append(QString("%1[%2]").arg(QObject::tr("UNKNOWN")).arg(check));
             }
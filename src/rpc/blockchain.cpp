@@ -5,12 +5,18 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 
+#include "blockfilter.h"
 #include "budget/budgetmanager.h"
 #include "checkpoints.h"
 #include "clientversion.h"
 #include "consensus/upgrades.h"
 #include "core_io.h"
 #include "hash.h"
+#include "index/addressindex.h"
+#include "index/blockfilterindex.h"
+#include "index/blockstatsindex.h"
+#include "index/coinstatsindex.h"
+#include "index/txindex.h"
 #include "kernel.h"
 #include "key_io.h"
 #include "llmq/quorums_chainlocks.h"
@@ -670,6 +676,83 @@ UniValue getblockheader(const JSONRPCRequest& request)
     return blockheaderToJSON(chainActive.Tip(), pblockindex);
 }
 
+UniValue getblockfilter(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+            "getblockfilter \"blockhash\" ( \"filtertype\" )\n"
+            "\nRetrieve a BIP 157 content filter for a particular block.\n"
+
+            "\nArguments:\n"
+            "1. \"blockhash\"     (string, required) The hash of the block\n"
+            "2. \"filtertype\"    (string, optional, default=basic) The type name of the filter\n"
+
+            "\nResult:\n"
+            "{\n"
+            "  \"filter\" : \"hex\",  (string) the hex-encoded filter data\n"
+            "  \"header\" : \"hex\"   (string) the hex-encoded filter header\n"
+            "}\n"
+
+            "\nExamples:\n" +
+            HelpExampleCli("getblockfilter", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\" \"basic\"") +
+            HelpExampleRpc("getblockfilter", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\", \"basic\""));
+
+    uint256 block_hash = ParseHashV(request.params[0], "blockhash");
+    std::string filtertype_name = "basic";
+    if (!request.params[1].isNull()) {
+        filtertype_name = request.params[1].get_str();
+    }
+
+    BlockFilterType filtertype;
+    if (!BlockFilterTypeByName(filtertype_name, filtertype)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown filtertype");
+    }
+
+    BlockFilterIndex* index = GetBlockFilterIndex(filtertype);
+    if (!index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Index is not enabled for filtertype " + filtertype_name);
+    }
+
+    const CBlockIndex* block_index;
+    bool block_was_connected;
+    {
+        LOCK(cs_main);
+        block_index = LookupBlockIndex(block_hash);
+        if (!block_index) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+        }
+        block_was_connected = block_index->IsValid(BLOCK_VALID_SCRIPTS);
+    }
+
+    bool index_ready = index->BlockUntilSyncedToCurrentChain();
+
+    BlockFilter filter;
+    uint256 filter_header;
+    if (!index->LookupFilter(block_index, filter) ||
+        !index->LookupFilterHeader(block_index, filter_header)) {
+        int err_code;
+        std::string errmsg = "Filter not found.";
+
+        if (!block_was_connected) {
+            err_code = RPC_INVALID_ADDRESS_OR_KEY;
+            errmsg += " Block was not connected to active chain.";
+        } else if (!index_ready) {
+            err_code = RPC_MISC_ERROR;
+            errmsg += " Block filters are still in the process of being indexed.";
+        } else {
+            err_code = RPC_INTERNAL_ERROR;
+            errmsg += " This error is unexpected and indicates index corruption.";
+        }
+
+        throw JSONRPCError(err_code, errmsg);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("filter", HexStr(filter.GetEncodedFilter()));
+    ret.pushKV("header", filter_header.GetHex());
+    return ret;
+}
+
 UniValue getsupplyinfo(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() > 1)
@@ -727,36 +810,55 @@ struct CCoinsStats
     CAmount nTotalAmount{0};
 };
 
-static void ApplyStats(CCoinsStats &stats, CHashWriter& ss, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
+enum class CoinStatsHashType {
+    HASH_SERIALIZED,
+    MUHASH,
+    NONE,
+};
+
+static void ApplyStats(CCoinsStats& stats, CHashWriter& ss, MuHash3072& muhash, CoinStatsHashType hash_type,
+                       const uint256& hash, const std::map<uint32_t, Coin>& outputs)
 {
     assert(!outputs.empty());
-    ss << hash;
-    const Coin& coin = outputs.begin()->second;
-    ss << VARINT(coin.nHeight * 4 + (coin.fCoinBase ? 2u : 0u) + (coin.fCoinStake ? 1u : 0u));
+    const bool fSerialized = hash_type == CoinStatsHashType::HASH_SERIALIZED;
+    if (fSerialized) {
+        ss << hash;
+        const Coin& coin = outputs.begin()->second;
+        ss << VARINT(coin.nHeight * 4 + (coin.fCoinBase ? 2u : 0u) + (coin.fCoinStake ? 1u : 0u));
+    }
     stats.nTransactions++;
     for (const auto& output : outputs) {
-        ss << VARINT(output.first + 1);
-        ss << output.second.out.scriptPubKey;
-        ss << VARINT_MODE(output.second.out.nValue, VarIntMode::NONNEGATIVE_SIGNED);
+        if (fSerialized) {
+            ss << VARINT(output.first + 1);
+            ss << output.second.out.scriptPubKey;
+            ss << VARINT_MODE(output.second.out.nValue, VarIntMode::NONNEGATIVE_SIGNED);
+        } else if (hash_type == CoinStatsHashType::MUHASH) {
+            ApplyCoinHash(muhash, COutPoint(hash, output.first), output.second);
+        }
         stats.nTransactionOutputs++;
         stats.nTotalAmount += output.second.out.nValue;
     }
-    ss << VARINT(0u);
+    if (fSerialized) {
+        ss << VARINT(0u);
+    }
 }
 
 //! Calculate statistics about the unspent transaction output set
-static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
+static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats, CoinStatsHashType hash_type)
 {
     std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
     assert(pcursor);
 
     CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+    MuHash3072 muhash;
     stats.hashBlock = pcursor->GetBestBlock();
     {
         LOCK(cs_main);
         stats.nHeight = LookupBlockIndex(stats.hashBlock)->nHeight;
     }
-    ss << stats.hashBlock;
+    if (hash_type == CoinStatsHashType::HASH_SERIALIZED) {
+        ss << stats.hashBlock;
+    }
     uint256 prevkey;
     std::map<uint32_t, Coin> outputs;
     while (pcursor->Valid()) {
@@ -765,7 +867,7 @@ static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
         Coin coin;
         if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
             if (!outputs.empty() && key.hash != prevkey) {
-                ApplyStats(stats, ss, prevkey, outputs);
+                ApplyStats(stats, ss, muhash, hash_type, prevkey, outputs);
                 outputs.clear();
             }
             prevkey = key.hash;
@@ -776,45 +878,131 @@ static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
         pcursor->Next();
     }
     if (!outputs.empty()) {
-        ApplyStats(stats, ss, prevkey, outputs);
+        ApplyStats(stats, ss, muhash, hash_type, prevkey, outputs);
+    }
+    if (hash_type == CoinStatsHashType::HASH_SERIALIZED) {
+        stats.hashSerialized = ss.GetHash();
+    } else if (hash_type == CoinStatsHashType::MUHASH) {
+        muhash.Finalize(stats.hashSerialized);
     }
-    stats.hashSerialized = ss.GetHash();
     stats.nDiskSize = view->EstimateSize();
     return true;
 }
 
+static CoinStatsHashType ParseHashType(const UniValue& param)
+{
+    const std::string hash_type_input = param.isNull() ? "hash_serialized_2" : param.get_str();
+    if (hash_type_input == "hash_serialized_2") {
+        return CoinStatsHashType::HASH_SERIALIZED;
+    } else if (hash_type_input == "muhash") {
+        return CoinStatsHashType::MUHASH;
+    } else if (hash_type_input == "none") {
+        return CoinStatsHashType::NONE;
+    }
+    throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("%s is not a valid hash_type", hash_type_input));
+}
+
+static const CBlockIndex* ParseHashOrHeight(const UniValue& param)
+{
+    LOCK(cs_main);
+    if (param.isNum()) {
+        const int height = param.get_int();
+        if (height < 0 || height > chainActive.Height()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Target block height %d out of range", height));
+        }
+        return chainActive[height];
+    }
+    const CBlockIndex* pindex = LookupBlockIndex(ParseHashV(param, "hash_or_height"));
+    if (!pindex) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+    }
+    if (!chainActive.Contains(pindex)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Block is not in chain %s", Params().NetworkIDString()));
+    }
+    return pindex;
+}
+
 UniValue gettxoutsetinfo(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 0)
+    if (request.fHelp || request.params.size() > 2)
         throw std::runtime_error(
-            "gettxoutsetinfo\n"
+            "gettxoutsetinfo ( \"hash_type\" hash_or_height )\n"
             "\nReturns statistics about the unspent transaction output set.\n"
-            "Note this call may take some time.\n"
+            "Note this call may take some time, unless it is answered by the coin statistics index (-coinstatsindex),\n"
+            "which is used for the 'muhash' and 'none' hash types.\n"
+
+            "\nArguments:\n"
+            "1. \"hash_type\"        (string, optional, default=hash_serialized_2) Which UTXO set hash should be calculated.\n"
+            "                       Options: 'hash_serialized_2' (the legacy algorithm), 'muhash', 'none'.\n"
+            "2. hash_or_height     (string or numeric, optional) The block hash or height of the target block.\n"
+            "                       Only available with -coinstatsindex.\n"
 
             "\nResult:\n"
             "{\n"
-            "  \"height\":n,     (numeric) The current block height (index)\n"
-            "  \"bestblock\": \"hex\",   (string) the best block hash hex\n"
-            "  \"transactions\": n,      (numeric) The number of transactions\n"
+            "  \"height\":n,     (numeric) The block height (index) of the returned statistics\n"
+            "  \"bestblock\": \"hex\",   (string) The hash of the block at which these statistics are calculated\n"
+            "  \"transactions\": n,      (numeric) The number of transactions (not available when answered by the index)\n"
             "  \"txouts\": n,            (numeric) The number of output transactions\n"
-            "  \"hash_serialized_2\": \"hash\",   (string) The serialized hash\n"
-            "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk\n"
+            "  \"hash_serialized_2\": \"hash\",   (string) The serialized hash (only present if 'hash_serialized_2' hash_type is chosen)\n"
+            "  \"muhash\": \"hash\",      (string) The MuHash of the UTXO set (only present if 'muhash' hash_type is chosen)\n"
+            "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk (not available when answered by the index)\n"
             "  \"total_amount\": x.xxx          (numeric) The total amount\n"
             "}\n"
 
             "\nExamples:\n" +
-            HelpExampleCli("gettxoutsetinfo", "") + HelpExampleRpc("gettxoutsetinfo", ""));
+            HelpExampleCli("gettxoutsetinfo", "") + HelpExampleCli("gettxoutsetinfo", "\"none\"") +
+            HelpExampleCli("gettxoutsetinfo", "\"none\" 1000") +
+            HelpExampleCli("gettxoutsetinfo", "\"muhash\" '\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\"'") +
+            HelpExampleRpc("gettxoutsetinfo", "") + HelpExampleRpc("gettxoutsetinfo", "\"none\"") +
+            HelpExampleRpc("gettxoutsetinfo", "\"none\", 1000"));
 
     UniValue ret(UniValue::VOBJ);
 
+    const CoinStatsHashType hash_type = ParseHashType(request.params[0]);
+    const CBlockIndex* pindex = nullptr;
+    if (!request.params[1].isNull()) {
+        if (!g_coinstatsindex) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Querying specific block heights requires -coinstatsindex");
+        }
+        if (hash_type == CoinStatsHashType::HASH_SERIALIZED) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "hash_serialized_2 hash type cannot be queried for a specific block");
+        }
+        pindex = ParseHashOrHeight(request.params[1]);
+    }
+
+    // Read the statistics from the index, when it can answer
+    if (g_coinstatsindex && hash_type != CoinStatsHashType::HASH_SERIALIZED) {
+        const bool fSynced = g_coinstatsindex->BlockUntilSyncedToCurrentChain();
+        const CBlockIndex* pindexStats = pindex ? pindex : WITH_LOCK(cs_main, return chainActive.Tip());
+        CUTXOSetStats stats;
+        if (fSynced && g_coinstatsindex->LookupStats(pindexStats, stats)) {
+            ret.pushKV("height", pindexStats->nHeight);
+            ret.pushKV("bestblock", stats.hashBlock.GetHex());
+            ret.pushKV("txouts", stats.nTransactionOutputs);
+            if (hash_type == CoinStatsHashType::MUHASH) {
+                ret.pushKV("muhash", stats.hashMuHash.GetHex());
+            }
+            ret.pushKV("total_amount", ValueFromAmount(stats.nTotalAmount));
+            return ret;
+        }
+        if (pindex) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, fSynced ? "Unable to read UTXO set statistics of the block"
+                                                           : "Unable to read UTXO set statistics: coinstatsindex is still syncing");
+        }
+    }
+
     CCoinsStats stats;
     FlushStateToDisk();
-    if (GetUTXOStats(pcoinsTip.get(), stats)) {
+    if (GetUTXOStats(pcoinsTip.get(), stats, hash_type)) {
         ret.pushKV("height", (int64_t)stats.nHeight);
         ret.pushKV("bestblock", stats.hashBlock.GetHex());
         ret.pushKV("transactions", (int64_t)stats.nTransactions);
         ret.pushKV("txouts", (int64_t)stats.nTransactionOutputs);
-        ret.pushKV("hash_serialized_2", stats.hashSerialized.GetHex());
+        if (hash_type == CoinStatsHashType::HASH_SERIALIZED) {
+            ret.pushKV("hash_serialized_2", stats.hashSerialized.GetHex());
+        } else if (hash_type == CoinStatsHashType::MUHASH) {
+            ret.pushKV("muhash", stats.hashSerialized.GetHex());
+        }
         ret.pushKV("total_amount", ValueFromAmount(stats.nTotalAmount));
         ret.pushKV("disk_size", stats.nDiskSize);
     }
@@ -1209,6 +1397,178 @@ UniValue getmempoolinfo(const JSONRPCRequest& request)
     return mempoolInfoToJSON();
 }
 
+UniValue getnullifierfilterinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getnullifierfilterinfo\n"
+            "\nReturns details on the filter in front of the Sapling nullifiers of the coins database.\n"
+
+            "\nResult:\n"
+            "{\n"
+            "  \"enabled\": true|false        (boolean) False if disabled with -maxnullifierfiltersize=0\n"
+            "  \"elements\": xxxxx            (numeric) Nullifiers inserted in the filter\n"
+            "  \"capacity\": xxxxx            (numeric) Nullifiers the filter is sized for, before being rebuilt\n"
+            "  \"bytes\": xxxxx               (numeric) Memory used by the filter\n"
+            "  \"builds\": xxxxx              (numeric) Times the filter was built from the database\n"
+            "  \"filtered\": xxxxx            (numeric) Lookups answered by the filter, without a database read\n"
+            "  \"hits\": xxxxx                (numeric) Lookups passed to the database, nullifier found\n"
+            "  \"false_positives\": xxxxx     (numeric) Lookups passed to the database, nullifier not found\n"
+            "}\n"
+
+            "\nExamples:\n" +
+            HelpExampleCli("getnullifierfilterinfo", "") + HelpExampleRpc("getnullifierfilterinfo", ""));
+
+    CNullifierFilter::Stats stats;
+    {
+        LOCK(cs_main);
+        if (!pcoinsdbview) throw JSONRPCError(RPC_IN_WARMUP, "Coins database not loaded");
+        stats = pcoinsdbview->GetNullifierFilterStats();
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("enabled", stats.fEnabled);
+    ret.pushKV("elements", (uint64_t)stats.nElements);
+    ret.pushKV("capacity", (uint64_t)stats.nCapacity);
+    ret.pushKV("bytes", (uint64_t)stats.nBytes);
+    ret.pushKV("builds", stats.nBuilds);
+    ret.pushKV("filtered", stats.nFiltered);
+    ret.pushKV("hits", stats.nHits);
+    ret.pushKV("false_positives", stats.nFalsePositives);
+    return ret;
+}
+
+UniValue getcoinscacheinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getcoinscacheinfo\n"
+            "\nReturns details on the UTXO cache and its flushes to the coins database.\n"
+
+            "\nResult:\n"
+            "{\n"
+            "  \"coins\": xxxxx               (numeric) Coins in the cache\n"
+            "  \"usage\": xxxxx               (numeric) Memory used by the cache\n"
+            "  \"max_usage\": xxxxx           (numeric) Memory usage triggering a flush (-dbcache)\n"
+            "  \"background_flush\": true|false (boolean) If the flushes are written by a separate thread (-backgroundflush)\n"
+            "  \"flushes\": xxxxx             (numeric) Flushes since the start\n"
+            "  \"flush_in_progress\": true|false (boolean) If a flush is being written in the background\n"
+            "  \"last_flush_coins\": xxxxx    (numeric) Coins changed by the last flush\n"
+            "  \"last_flush_blocking_ms\": xxxxx (numeric) Time the last flush stopped the validation\n"
+            "  \"last_flush_write_ms\": xxxxx (numeric) Time taken to write the last flush in the database\n"
+            "  \"total_flush_blocking_ms\": xxxxx (numeric) Time the flushes stopped the validation\n"
+            "  \"total_flush_write_ms\": xxxxx (numeric) Time taken to write the flushes in the database\n"
+            "  \"prefetch\": {                (json object) Inputs of the connected blocks, loaded in the cache before validating them\n"
+            "     \"blocks\": xxxxx            (numeric) Blocks prefetched\n"
+            "     \"inputs\": xxxxx            (numeric) Inputs spending coins created before the block\n"
+            "     \"cache_hits\": xxxxx        (numeric) Inputs already in the cache\n"
+            "     \"fetched\": xxxxx           (numeric) Inputs read from the database\n"
+            "     \"missing\": xxxxx           (numeric) Inputs not found in the database\n"
+            "     \"hit_ratio\": x.xxx         (numeric) Share of the inputs in the cache when the blocks were validated\n"
+            "     \"cache_hit_ratio\": x.xxx   (numeric) Share of the inputs in the cache before the prefetch\n"
+            "     \"last_hit_ratio\": x.xxx    (numeric) hit_ratio of the last prefetch\n"
+            "     \"last_cache_hit_ratio\": x.xxx (numeric) cache_hit_ratio of the last prefetch\n"
+            "     \"total_ms\": xxxxx          (numeric) Time spent prefetching\n"
+            "  }\n"
+            "}\n"
+
+            "\nExamples:\n" +
+            HelpExampleCli("getcoinscacheinfo", "") + HelpExampleRpc("getcoinscacheinfo", ""));
+
+    UniValue ret(UniValue::VOBJ);
+    CCoinsViewDB::FlushStats stats;
+    {
+        LOCK(cs_main);
+        if (!pcoinsdbview || !pcoinsTip) throw JSONRPCError(RPC_IN_WARMUP, "Coins database not loaded");
+        ret.pushKV("coins", (uint64_t)pcoinsTip->GetCacheSize());
+        ret.pushKV("usage", (uint64_t)pcoinsTip->DynamicMemoryUsage());
+        ret.pushKV("max_usage", (uint64_t)nCoinCacheUsage);
+        stats = pcoinsdbview->GetFlushStats();
+    }
+    const CoinsPrefetchStats prefetch = GetCoinsPrefetchStats();
+    ret.pushKV("background_flush", stats.fBackground);
+    ret.pushKV("flushes", stats.nFlushes);
+    ret.pushKV("flush_in_progress", stats.fInProgress);
+    ret.pushKV("last_flush_coins", (uint64_t)stats.nLastChanged);
+    ret.pushKV("last_flush_blocking_ms", stats.nLastBlockingMicros / 1000);
+    ret.pushKV("last_flush_write_ms", stats.nLastWriteMicros / 1000);
+    ret.pushKV("total_flush_blocking_ms", stats.nTotalBlockingMicros / 1000);
+    ret.pushKV("total_flush_write_ms", stats.nTotalWriteMicros / 1000);
+
+    auto ratio = [](int64_t n, int64_t nTotal) { return nTotal ? (double)n / nTotal : 0.0; };
+    UniValue prefetchObj(UniValue::VOBJ);
+    prefetchObj.pushKV("blocks", prefetch.nBlocks);
+    prefetchObj.pushKV("inputs", prefetch.nInputs);
+    prefetchObj.pushKV("cache_hits", prefetch.nCacheHits);
+    prefetchObj.pushKV("fetched", prefetch.nFetched);
+    prefetchObj.pushKV("missing", prefetch.nMissing);
+    prefetchObj.pushKV("hit_ratio", ratio(prefetch.nCacheHits + prefetch.nFetched, prefetch.nInputs));
+    prefetchObj.pushKV("cache_hit_ratio", ratio(prefetch.nCacheHits, prefetch.nInputs));
+    prefetchObj.pushKV("last_hit_ratio", ratio(prefetch.nLastCacheHits + prefetch.nLastFetched, prefetch.nLastInputs));
+    prefetchObj.pushKV("last_cache_hit_ratio", ratio(prefetch.nLastCacheHits, prefetch.nLastInputs));
+    prefetchObj.pushKV("total_ms", prefetch.nTotalMicros / 1000);
+    ret.pushKV("prefetch", prefetchObj);
+    return ret;
+}
+
+static UniValue SummaryToJSON(const IndexSummary& summary, const std::string& index_name)
+{
+    UniValue ret_summary(UniValue::VOBJ);
+    if (!index_name.empty() && index_name != summary.name) return ret_summary;
+
+    UniValue entry(UniValue::VOBJ);
+    entry.pushKV("synced", summary.synced);
+    entry.pushKV("best_block_height", summary.best_block_height);
+    ret_summary.pushKV(summary.name, entry);
+    return ret_summary;
+}
+
+UniValue getindexinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "getindexinfo ( \"index_name\" )\n"
+            "\nReturns the status of one or all the optional indices, built in the background.\n"
+
+            "\nArguments:\n"
+            "1. \"index_name\"     (string, optional) Filter results for an index with a specific name.\n"
+
+            "\nResult:\n"
+            "{\n"
+            "  \"name\": {                  (json object) The name of the index\n"
+            "     \"synced\": true|false,   (boolean) Whether the index is synced or not\n"
+            "     \"best_block_height\": xxxxx (numeric) The block height to which the index is synced\n"
+            "  }\n"
+            "}\n"
+
+            "\nExamples:\n" +
+            HelpExampleCli("getindexinfo", "") + HelpExampleRpc("getindexinfo", "") +
+            HelpExampleCli("getindexinfo", "txindex") + HelpExampleRpc("getindexinfo", "txindex"));
+
+    UniValue result(UniValue::VOBJ);
+    const std::string index_name = request.params[0].isNull() ? "" : request.params[0].get_str();
+
+    if (g_txindex) {
+        result.pushKVs(SummaryToJSON(g_txindex->GetSummary(), index_name));
+    }
+    if (g_addressindex) {
+        result.pushKVs(SummaryToJSON(g_addressindex->GetSummary(), index_name));
+    }
+
+    if (g_blockstatsindex) {
+        result.pushKVs(SummaryToJSON(g_blockstatsindex->GetSummary(), index_name));
+    }
+    if (g_coinstatsindex) {
+        result.pushKVs(SummaryToJSON(g_coinstatsindex->GetSummary(), index_name));
+    }
+
+    ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
+        result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
+    });
+
+    return result;
+}
+
 UniValue invalidateblock(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -1327,6 +1687,7 @@ UniValue getblockindexstats(const JSONRPCRequest& request) {
                 "getblockindexstats height range\n"
                 "\nReturns aggregated BlockIndex data for blocks "
                 "\n[height, height+1, height+2, ..., height+range-1]\n"
+                "\nThe totals are read from the block statistics index, when it is enabled (-blockstatsindex).\n"
 
                 "\nArguments:\n"
                 "1. height             (numeric, required) block height where the search starts.\n"
@@ -1341,6 +1702,8 @@ UniValue getblockindexstats(const JSONRPCRequest& request) {
                 "  \"txbytes\": xxxxx                (numeric) Sum of the size of all txes over block range\n"
                 "  \"ttlfee\": xxxxx                 (numeric) Sum of the fee amount of all txes over block range\n"
                 "  \"feeperkb\": xxxxx               (numeric) Average fee per kb (excluding zc txes)\n"
+                "  \"shieldvaluein\": xxxxx          (numeric) Value moved out of the shield pool over block range\n"
+                "  \"shieldvalueout\": xxxxx         (numeric) Value moved into the shield pool over block range\n"
                 "}\n"
 
                 "\nExamples:\n" +
@@ -1354,69 +1717,35 @@ UniValue getblockindexstats(const JSONRPCRequest& request) {
     ret.pushKV("Starting block", heightStart);
     ret.pushKV("Ending block", heightEnd);
 
-    CAmount nFees = 0;
-    int64_t nBytes = 0;
-    int64_t nTxCount = 0;
-    int64_t nTxCount_all = 0;
-
     const CBlockIndex* pindex = WITH_LOCK(cs_main, return chainActive[heightEnd]);
     if (!pindex)
         throw JSONRPCError(RPC_INVALID_PARAMETER, "invalid block height");
 
-    while (pindex && pindex->nHeight >= heightStart) {
-        CBlock block;
-        if (!ReadBlockFromDisk(block, pindex)) {
-            throw JSONRPCError(RPC_DATABASE_ERROR, "failed to read block from disk");
-        }
-
-        CAmount nValueIn = 0;
-        CAmount nValueOut = 0;
-        const int ntx = block.vtx.size();
-        const int firstTxIndex = block.IsProofOfStake() ? 2 : 1;
-        nTxCount_all += ntx;
-        nTxCount = nTxCount + ntx - firstTxIndex;
-
-        // loop through each tx in block and save size and fee (except for coinbase/coinstake)
-        for (int idx = firstTxIndex; idx < ntx; idx++) {
-            const CTransaction& tx = *(block.vtx[idx]);
-
-            // zerocoin txes have fixed fee, don't count them here.
-            if (tx.ContainsZerocoins())
-                continue;
-
-            // Transaction size
-            nBytes += GetSerializeSize(tx, CLIENT_VERSION);
-
-            // Transparent inputs
-            for (unsigned int j = 0; j < tx.vin.size(); j++) {
-                COutPoint prevout = tx.vin[j].prevout;
-                CTransactionRef txPrev;
-                uint256 hashBlock;
-                if(!GetTransaction(prevout.hash, txPrev, hashBlock, true))
-                    throw JSONRPCError(RPC_DATABASE_ERROR, "failed to read tx from disk");
-                nValueIn += txPrev->vout[prevout.n].nValue;
+    // Sum the block statistics from the index if it is synced, else compute them from disk
+    CBlockIndexStats stats;
+    if (!g_blockstatsindex || !g_blockstatsindex->BlockUntilSyncedToCurrentChain() ||
+        !g_blockstatsindex->LookupStatsRange(heightStart, pindex, stats)) {
+        stats = CBlockIndexStats();
+        for (; pindex && pindex->nHeight >= heightStart; pindex = pindex->pprev) {
+            CBlockIndexStats blockStats;
+            if (!ReadBlockIndexStats(pindex, blockStats)) {
+                throw JSONRPCError(RPC_DATABASE_ERROR, "failed to read block from disk");
             }
-            // Shield inputs
-            nValueIn += tx.GetShieldedValueIn();
-
-            // Tranparent/Shield outputs
-            nValueOut += tx.GetValueOut();
-
-            // update fee
-            nFees += nValueIn - nValueOut;
+            stats += blockStats;
         }
-        pindex = pindex->pprev;
     }
 
     // get fee rate
-    CFeeRate nFeeRate = CFeeRate(nFees, nBytes);
+    CFeeRate nFeeRate = CFeeRate(stats.nFees, stats.nTxBytes);
 
     // return UniValue object
-    ret.pushKV("txcount", (int64_t)nTxCount);
-    ret.pushKV("txcount_all", (int64_t)nTxCount_all);
-    ret.pushKV("txbytes", (int64_t)nBytes);
-    ret.pushKV("ttlfee", FormatMoney(nFees));
+    ret.pushKV("txcount", stats.nTxCount);
+    ret.pushKV("txcount_all", stats.nTxCountAll);
+    ret.pushKV("txbytes", stats.nTxBytes);
+    ret.pushKV("ttlfee", FormatMoney(stats.nFees));
     ret.pushKV("feeperkb", FormatMoney(nFeeRate.GetFeePerK()));
+    ret.pushKV("shieldvaluein", FormatMoney(stats.nShieldedValueIn));
+    ret.pushKV("shieldvalueout", FormatMoney(stats.nShieldedValueOut));
 
     return ret;
 }
@@ -1683,16 +2012,20 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getblockchaininfo",      &getblockchaininfo,      true,  {} },
     { "blockchain",         "getblockcount",          &getblockcount,          true,  {} },
     { "blockchain",         "getblockhash",           &getblockhash,           true,  {"height"} },
+    { "blockchain",         "getblockfilter",         &getblockfilter,         true,  {"blockhash","filtertype"} },
     { "blockchain",         "getblockheader",         &getblockheader,         false, {"blockhash","verbose"} },
     { "blockchain",         "getblockindexstats",     &getblockindexstats,     true,  {"height","range"} },
     { "blockchain",         "getchaintips",           &getchaintips,           true,  {} },
     { "blockchain",         "getdifficulty",          &getdifficulty,          true,  {} },
     { "blockchain",         "getfeeinfo",             &getfeeinfo,             true,  {"blocks"} },
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         true,  {} },
+    { "blockchain",         "getnullifierfilterinfo", &getnullifierfilterinfo, true,  {} },
+    { "blockchain",         "getcoinscacheinfo",      &getcoinscacheinfo,      true,  {} },
+    { "blockchain",         "getindexinfo",           &getindexinfo,           true,  {"index_name"} },
     { "blockchain",         "getrawmempool",          &getrawmempool,          true,  {"verbose"} },
     { "blockchain",         "getsupplyinfo",          &getsupplyinfo,          true,  {"force_update"} },
     { "blockchain",         "gettxout",               &gettxout,               true,  {"txid","n","include_mempool"} },
-    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        true,  {} },
+    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        true,  {"hash_type","hash_or_height"} },
     { "blockchain",         "scantxoutset",           &scantxoutset,           true,  {"action", "scanobjects"} },
     { "blockchain",         "verifychain",            &verifychain,            true,  {"nblocks"} },
 
@@ -48,6 +48,11 @@ static const CRPCConvertParam vRPCConvertParams[] = {
     { "generate", 0, "nblocks" },
     { "generatetoaddress", 0, "nblocks" },
     { "getaddednodeinfo", 0, "dummy" },
+    { "getaddressbalance", 0, "addresses" },
+    { "getaddresstxids", 0, "addresses" },
+    { "getaddresstxids", 1, "start" },
+    { "getaddresstxids", 2, "end" },
+    { "getaddressutxos", 0, "addresses" },
     { "getbalance", 0, "minconf" },
     { "getbalance", 1, "include_watchonly" },
     { "getbalance", 2, "include_delegated" },
@@ -72,8 +77,10 @@ static const CRPCConvertParam vRPCConvertParams[] = {
     { "getreceivedbyaddress", 1, "minconf" },
     { "getreceivedbylabel", 1, "minconf" },
     { "getsaplingnotescount", 0, "minconf" },
+    { "getspentinfo", 0, "json" },
     { "getsupplyinfo", 0, "force_update" },
     { "gettransaction", 1, "include_watchonly" },
+    { "gettxoutsetinfo", 1, "hash_or_height" },
     { "gettxout", 1, "n" },
     { "gettxout", 2, "include_mempool" },
     { "importaddress", 2, "rescan" },
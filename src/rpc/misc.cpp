@@ -6,7 +6,9 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "clientversion.h"
+#include "crypto/sha256.h"
 #include "httpserver.h"
+#include "index/addressindex.h"
 #include "key_io.h"
 #include "sapling/key_io_sapling.h"
 #include "gamemaster-sync.h"
@@ -81,6 +83,7 @@ UniValue getinfo(const JSONRPCRequest& request)
             "  \"paytxfee\": x.xxxx,           (numeric) the transaction fee set in " + CURRENCY_UNIT + "/kB\n"
             "  \"relayfee\": x.xxxx,           (numeric) minimum relay fee for transactions in " + CURRENCY_UNIT + "/kB\n"
             "  \"errors\": \"...\"             (string) any error messages\n"
+            "  \"sha256\": \"...\"             (string) the SHA256 implementations in use (detected at startup)\n"
             "}\n"
 
             "\nExamples:\n" +
@@ -104,6 +107,9 @@ UniValue getinfo(const JSONRPCRequest& request)
                 case NODE_BLOOM_WITHOUT_GM:
                     services+= "BLOOM/";
                     break;
+                case NODE_COMPACT_FILTERS:
+                    services+= "COMPACT_FILTERS/";
+                    break;
                 default:
                     services+= "UNKNOWN/";
             }
@@ -151,6 +157,7 @@ UniValue getinfo(const JSONRPCRequest& request)
 #endif
     obj.pushKV("relayfee", ValueFromAmount(::minRelayTxFee.GetFeePerK()));
     obj.pushKV("errors", GetWarnings("statusbar"));
+    obj.pushKV("sha256", SHA256Implementation());
     return obj;
 }
 
@@ -832,6 +839,251 @@ UniValue gmconnect(const JSONRPCRequest& request)
     return false;
 }
 
+static void EnsureAddressIndexSynced()
+{
+    if (!g_addressindex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index not enabled. Use -addressindex to enable it");
+    }
+    if (!g_addressindex->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Address index is still being built (height %d). Check getindexinfo",
+                                                     g_addressindex->GetSummary().best_block_height));
+    }
+}
+
+/** Get the addresses, and their scripts hashes, from a string or an object { "addresses": [...] } */
+static std::vector<std::pair<std::string, uint160>> GetAddressesFromParam(const UniValue& param)
+{
+    std::vector<std::string> vAddresses;
+    if (param.isStr()) {
+        vAddresses.emplace_back(param.get_str());
+    } else if (param.isObject()) {
+        const UniValue& addresses = find_value(param.get_obj(), "addresses");
+        if (!addresses.isArray()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Addresses is expected to be an array");
+        }
+        for (const UniValue& address : addresses.getValues()) {
+            vAddresses.emplace_back(address.get_str());
+        }
+    } else {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Expected an address or an object with an addresses array");
+    }
+
+    std::vector<std::pair<std::string, uint160>> ret;
+    for (const std::string& strAddress : vAddresses) {
+        const CTxDestination dest = DecodeDestination(strAddress);
+        if (!IsValidDestination(dest)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address: " + strAddress);
+        }
+        ret.emplace_back(strAddress, GetScriptIndexHash(GetScriptForDestination(dest)));
+    }
+    return ret;
+}
+
+#define ADDRESSES_ARG_HELP \
+    "1. \"addresses\"   (string or json object, required) The address, or an object:\n" \
+    "    {\n" \
+    "      \"addresses\": [  (json array of strings)\n" \
+    "        \"address\"     (string) The Hemis address\n" \
+    "        ,...\n" \
+    "      ]\n" \
+    "    }\n"
+
+UniValue getaddressbalance(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "getaddressbalance \"addresses\"\n"
+            "\nReturns the balance of one or more addresses (requires -addressindex).\n"
+
+            "\nArguments:\n"
+            ADDRESSES_ARG_HELP
+
+            "\nResult:\n"
+            "{\n"
+            "  \"balance\": xxxxx,   (numeric) The current balance in " + CURRENCY_UNIT + "\n"
+            "  \"received\": xxxxx,  (numeric) The total amount received in " + CURRENCY_UNIT + " (including change)\n"
+            "}\n"
+
+            "\nExamples:\n" +
+            HelpExampleCli("getaddressbalance", "'{\"addresses\": [\"DAD3Y6ivr8nPQLT1NEPX84DxGCw9jz9Jvg\"]}'") +
+            HelpExampleRpc("getaddressbalance", "{\"addresses\": [\"DAD3Y6ivr8nPQLT1NEPX84DxGCw9jz9Jvg\"]}"));
+
+    EnsureAddressIndexSynced();
+
+    CAmount nBalance = 0;
+    CAmount nReceived = 0;
+    for (const auto& address : GetAddressesFromParam(request.params[0])) {
+        CAmount nAddressBalance, nAddressReceived;
+        if (!g_addressindex->GetAddressBalance(address.second, nAddressBalance, nAddressReceived)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the address index for " + address.first);
+        }
+        nBalance += nAddressBalance;
+        nReceived += nAddressReceived;
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("balance", ValueFromAmount(nBalance));
+    result.pushKV("received", ValueFromAmount(nReceived));
+    return result;
+}
+
+UniValue getaddressutxos(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "getaddressutxos \"addresses\"\n"
+            "\nReturns the unspent outputs of one or more addresses, in the active chain (requires -addressindex).\n"
+
+            "\nArguments:\n"
+            ADDRESSES_ARG_HELP
+
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"address\": \"address\",  (string) The address\n"
+            "    \"txid\": \"hash\",        (string) The transaction id\n"
+            "    \"outputIndex\": n,      (numeric) The output index\n"
+            "    \"script\": \"hex\",       (string) The script hex\n"
+            "    \"amount\": xxxxx,       (numeric) The amount in " + CURRENCY_UNIT + "\n"
+            "    \"height\": n            (numeric) The height of the block including the transaction\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+
+            "\nExamples:\n" +
+            HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"DAD3Y6ivr8nPQLT1NEPX84DxGCw9jz9Jvg\"]}'") +
+            HelpExampleRpc("getaddressutxos", "{\"addresses\": [\"DAD3Y6ivr8nPQLT1NEPX84DxGCw9jz9Jvg\"]}"));
+
+    EnsureAddressIndexSynced();
+
+    std::vector<std::pair<std::string, std::pair<CAddressUnspentKey, CAddressUnspentValue>>> vUnspent;
+    for (const auto& address : GetAddressesFromParam(request.params[0])) {
+        std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspent;
+        if (!g_addressindex->GetAddressUnspent(address.second, unspent)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the address index for " + address.first);
+        }
+        for (auto& entry : unspent) {
+            vUnspent.emplace_back(address.first, std::move(entry));
+        }
+    }
+    std::stable_sort(vUnspent.begin(), vUnspent.end(), [](const auto& a, const auto& b) {
+        return a.second.second.nHeight < b.second.second.nHeight;
+    });
+
+    UniValue result(UniValue::VARR);
+    for (const auto& entry : vUnspent) {
+        UniValue output(UniValue::VOBJ);
+        output.pushKV("address", entry.first);
+        output.pushKV("txid", entry.second.first.outpoint.hash.GetHex());
+        output.pushKV("outputIndex", (int) entry.second.first.outpoint.n);
+        output.pushKV("script", HexStr(entry.second.second.script));
+        output.pushKV("amount", ValueFromAmount(entry.second.second.nValue));
+        output.pushKV("height", entry.second.second.nHeight);
+        result.push_back(output);
+    }
+    return result;
+}
+
+UniValue getaddresstxids(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.empty() || request.params.size() > 3)
+        throw std::runtime_error(
+            "getaddresstxids \"addresses\" ( start end )\n"
+            "\nReturns the ids of the transactions crediting or debiting one or more addresses, in the active chain,\n"
+            "sorted by height (requires -addressindex).\n"
+
+            "\nArguments:\n"
+            ADDRESSES_ARG_HELP
+            "2. start          (numeric, optional, default=0) The start block height\n"
+            "3. end            (numeric, optional, default=0) The end block height, included (0 for the chain tip)\n"
+
+            "\nResult:\n"
+            "[\n"
+            "  \"transactionid\"  (string) The transaction id\n"
+            "  ,...\n"
+            "]\n"
+
+            "\nExamples:\n" +
+            HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"DAD3Y6ivr8nPQLT1NEPX84DxGCw9jz9Jvg\"]}'") +
+            HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"DAD3Y6ivr8nPQLT1NEPX84DxGCw9jz9Jvg\"]}' 1000 2000") +
+            HelpExampleRpc("getaddresstxids", "{\"addresses\": [\"DAD3Y6ivr8nPQLT1NEPX84DxGCw9jz9Jvg\"]}"));
+
+    const int nStart = request.params.size() > 1 ? request.params[1].get_int() : 0;
+    const int nEnd = request.params.size() > 2 ? request.params[2].get_int() : 0;
+    if (nStart < 0 || nEnd < 0 || (nEnd > 0 && nEnd < nStart)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid start or end height");
+    }
+
+    EnsureAddressIndexSynced();
+
+    // A transaction may credit and debit the same address several times
+    std::set<std::pair<int, uint256>> setTxids;
+    for (const auto& address : GetAddressesFromParam(request.params[0])) {
+        std::vector<std::pair<CAddressIndexKey, CAmount>> entries;
+        if (!g_addressindex->GetAddressIndex(address.second, entries, nStart, nEnd)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the address index for " + address.first);
+        }
+        for (const auto& entry : entries) {
+            setTxids.emplace(entry.first.nHeight, entry.first.txid);
+        }
+    }
+
+    UniValue result(UniValue::VARR);
+    for (const auto& txid : setTxids) {
+        result.push_back(txid.second.GetHex());
+    }
+    return result;
+}
+
+UniValue getspentinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1 || !request.params[0].isObject())
+        throw std::runtime_error(
+            "getspentinfo {\"txid\": \"hash\", \"index\": n}\n"
+            "\nReturns the transaction input spending an output, in the active chain (requires -addressindex).\n"
+
+            "\nArguments:\n"
+            "1. {\n"
+            "     \"txid\": \"hash\",  (string, required) The hex string of the transaction id\n"
+            "     \"index\": n       (numeric, required) The output index\n"
+            "   }\n"
+
+            "\nResult:\n"
+            "{\n"
+            "  \"txid\": \"hash\",  (string) The id of the spending transaction\n"
+            "  \"index\": n,      (numeric) The index of the spending input\n"
+            "  \"height\": n      (numeric) The height of the block including the spending transaction\n"
+            "}\n"
+
+            "\nExamples:\n" +
+            HelpExampleCli("getspentinfo", "'{\"txid\": \"0437cd7f8525ceed2324359c2d0ba26006d92d856a9c20fa0241106ee5a597c9\", \"index\": 0}'") +
+            HelpExampleRpc("getspentinfo", "{\"txid\": \"0437cd7f8525ceed2324359c2d0ba26006d92d856a9c20fa0241106ee5a597c9\", \"index\": 0}"));
+
+    const UniValue& obj = request.params[0].get_obj();
+    const uint256 txid = ParseHashO(obj, "txid");
+    const UniValue& indexValue = find_value(obj, "index");
+    if (!indexValue.isNum()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid index, expected a number");
+    }
+    const int nIndex = indexValue.get_int();
+    if (nIndex < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid index, must be positive");
+    }
+
+    EnsureAddressIndexSynced();
+
+    CSpentIndexValue value;
+    if (!g_addressindex->GetSpentInfo(COutPoint(txid, (uint32_t) nIndex), value)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unable to get spent info: the output is unspent or unknown");
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("txid", value.txid.GetHex());
+    result.pushKV("index", (int) value.nInputIndex);
+    result.pushKV("height", value.nHeight);
+    return result;
+}
+
 // clang-format off
 static const CRPCCommand commands[] =
 { //  category              name                      actor (function)         okSafe argNames
@@ -841,6 +1093,11 @@ static const CRPCCommand commands[] =
     { "control",            "gmsync",                 &gmsync,                 true,  {"mode"} },
     { "control",            "spork",                  &spork,                  true,  {"name","value"} },
 
+    { "addressindex",       "getaddressbalance",      &getaddressbalance,      true,  {"addresses"} },
+    { "addressindex",       "getaddresstxids",        &getaddresstxids,        true,  {"addresses","start","end"} },
+    { "addressindex",       "getaddressutxos",        &getaddressutxos,        true,  {"addresses"} },
+    { "addressindex",       "getspentinfo",           &getspentinfo,           true,  {"json"} },
+
     { "util",               "createmultisig",         &createmultisig,         true,  {"nrequired","keys"} },
     { "util",               "logging",                &logging,                true,  {"include", "exclude"} },
     { "util",               "validateaddress",        &validateaddress,        true,  {"Hemisaddress"} }, /* uses wallet if enabled */
@@ -129,6 +129,14 @@ extern "C" {
         unsigned char *result
     );
 
+    /// Accumulates in the proving context `ctx` the value commitments of
+    /// the descriptions proven with the context `other`, so that the proofs
+    /// of a transaction can be created with separate contexts.
+    void librustzcash_sapling_proving_ctx_merge(
+        void *ctx,
+        const void *other
+    );
+
     /// Frees a Sapling proving context returned from
     /// `librustzcash_sapling_proving_ctx_init`.
     void librustzcash_sapling_proving_ctx_free(void *);
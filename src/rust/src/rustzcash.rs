@@ -20,7 +20,8 @@ use zcash_proofs::circuit::sprout::{self, TREE_DEPTH as SPROUT_TREE_DEPTH};
 
 use bellman::gadgets::multipack;
 use bellman::groth16::{
-    create_random_proof, verify_proof, Parameters, PreparedVerifyingKey, Proof,
+    create_random_proof, prepare_verifying_key, verify_proof, Parameters, PreparedVerifyingKey,
+    Proof,
 };
 
 use blake2s_simd::Params as Blake2sParams;
@@ -56,10 +57,10 @@ use zcash_primitives::{
     transaction::components::Amount,
     zip32, JUBJUB,
 };
-use zcash_proofs::{
-    load_parameters,
-    sapling::{SaplingProvingContext, SaplingVerificationContext},
-};
+use zcash_proofs::{load_parameters, sapling::SaplingVerificationContext};
+
+mod sapling_prover;
+use sapling_prover::SaplingProvingContext;
 
 #[cfg(test)]
 mod tests;
@@ -185,6 +186,98 @@ pub extern "system" fn librustzcash_init_zksnark_params(
     )
 }
 
+/// Contents of a parameter file, memory-mapped where supported.
+#[cfg(not(target_os = "windows"))]
+struct ParamsFile {
+    data: *mut libc::c_void,
+    len: usize,
+}
+
+#[cfg(not(target_os = "windows"))]
+impl ParamsFile {
+    fn open(path: &Path) -> std::io::Result<Self> {
+        use std::os::unix::io::AsRawFd;
+
+        let file = File::open(path)?;
+        let len = file.metadata()?.len() as usize;
+        if len == 0 {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidData,
+                "empty parameter file",
+            ));
+        }
+        let data = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                len,
+                libc::PROT_READ,
+                libc::MAP_PRIVATE,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if data == libc::MAP_FAILED {
+            return Err(std::io::Error::last_os_error());
+        }
+        // The file is read once, from start to end
+        unsafe { libc::madvise(data, len, libc::MADV_SEQUENTIAL) };
+        Ok(ParamsFile { data, len })
+    }
+
+    fn as_slice(&self) -> &[u8] {
+        unsafe { slice::from_raw_parts(self.data as *const u8, self.len) }
+    }
+}
+
+#[cfg(not(target_os = "windows"))]
+impl Drop for ParamsFile {
+    fn drop(&mut self) {
+        unsafe { libc::munmap(self.data, self.len) };
+    }
+}
+
+/// Contents of a parameter file, read at once.
+#[cfg(target_os = "windows")]
+struct ParamsFile(Vec<u8>);
+
+#[cfg(target_os = "windows")]
+impl ParamsFile {
+    fn open(path: &Path) -> std::io::Result<Self> {
+        std::fs::read(path).map(ParamsFile)
+    }
+
+    fn as_slice(&self) -> &[u8] {
+        &self.0[..]
+    }
+}
+
+/// Loads the Sapling parameters of a file, checking its BLAKE2b hash first.
+fn load_sapling_params(
+    path: &Path,
+    expected_hash: &str,
+) -> (Parameters<Bls12>, PreparedVerifyingKey<Bls12>) {
+    let file = ParamsFile::open(path).expect("couldn't load Sapling parameters file");
+    let data = file.as_slice();
+
+    let hash = blake2b_simd::Params::new().hash_length(64).hash(data);
+    if hash.to_hex().as_str() != expected_hash {
+        panic!(
+            "{} failed validation (expected: {}, actual: {}, fetched {} bytes)",
+            path.display(),
+            expected_hash,
+            hash.to_hex(),
+            data.len()
+        );
+    }
+
+    // The hash is verified: no need to check the points
+    let params = Parameters::<Bls12>::read(data, false)
+        .expect("couldn't deserialize Sapling parameters file");
+    let vk = prepare_verifying_key(&params.vk);
+
+    (params, vk)
+}
+
 fn init_zksnark_params(
     spend_path: &Path,
     spend_hash: *const c_char,
@@ -215,14 +308,28 @@ fn init_zksnark_params(
     };
 
     // Load params
-    let (spend_params, spend_vk, output_params, output_vk, sprout_vk) = load_parameters(
-        spend_path,
-        spend_hash,
-        output_path,
-        output_hash,
-        sprout_path,
-        sprout_hash,
-    );
+    let (spend_params, spend_vk, output_params, output_vk, sprout_vk) = match sprout_path {
+        Some(_) => load_parameters(
+            spend_path,
+            spend_hash,
+            output_path,
+            output_hash,
+            sprout_path,
+            sprout_hash,
+        ),
+        None => {
+            // Read and verify the two Sapling files concurrently
+            let output_path = output_path.to_owned();
+            let output_hash = output_hash.to_owned();
+            let output_loader =
+                std::thread::spawn(move || load_sapling_params(&output_path, &output_hash));
+            let (spend_params, spend_vk) = load_sapling_params(spend_path, spend_hash);
+            let (output_params, output_vk) = output_loader
+                .join()
+                .expect("couldn't load Sapling output parameters");
+            (spend_params, spend_vk, output_params, output_vk, None)
+        }
+    };
 
     // Caller is responsible for calling this function once, so
     // these global mutations are safe.
@@ -1141,6 +1248,14 @@ pub extern "system" fn librustzcash_sapling_proving_ctx_init() -> *mut SaplingPr
     Box::into_raw(ctx)
 }
 
+#[no_mangle]
+pub extern "system" fn librustzcash_sapling_proving_ctx_merge(
+    ctx: *mut SaplingProvingContext,
+    other: *const SaplingProvingContext,
+) {
+    unsafe { &mut *ctx }.merge(unsafe { &*other }, &JUBJUB);
+}
+
 #[no_mangle]
 pub extern "system" fn librustzcash_sapling_proving_ctx_free(ctx: *mut SaplingProvingContext) {
     drop(unsafe { Box::from_raw(ctx) });
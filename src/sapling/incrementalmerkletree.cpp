@@ -1138,16 +1138,90 @@ void IncrementalWitness<Depth, Hash>::append(Hash obj) {
     }
 }
 
+template<size_t Depth, typename Hash>
+void IncrementalWitnessTracker<Depth, Hash>::AddWitness(IncrementalWitness<Depth, Hash>* witness) {
+    if (witness->cursor) {
+        SharedCursor& shared = cursors[witness->cursor_depth];
+        if (!shared.tree) {
+            shared.tree = witness->cursor;
+        }
+        shared.witnesses.push_back(witness);
+    } else {
+        noCursor.push_back(witness);
+    }
+}
+
+template<size_t Depth, typename Hash>
+void IncrementalWitnessTracker<Depth, Hash>::append(Hash obj) {
+    // The witnesses completing a cursor don't take obj: process the others first
+    std::vector<IncrementalWitness<Depth, Hash>*> vPending;
+    vPending.swap(noCursor);
+
+    for (size_t d = 1; d < Depth; d++) {
+        SharedCursor& shared = cursors[d];
+        if (shared.witnesses.empty()) continue;
+        shared.tree->append(obj);
+        if (shared.tree->is_complete(d)) {
+            const Hash root = shared.tree->root(d);
+            for (auto* witness : shared.witnesses) {
+                witness->filled.push_back(root);
+                witness->cursor = nullopt;
+                noCursor.push_back(witness);
+            }
+            shared.tree = nullopt;
+            shared.witnesses.clear();
+        }
+    }
+
+    // Same as IncrementalWitness::append, starting (or sharing) a new cursor
+    for (auto* witness : vPending) {
+        witness->cursor_depth = witness->tree.next_depth(witness->filled.size());
+
+        if (witness->cursor_depth >= Depth) {
+            throw std::runtime_error("tree is full");
+        }
+
+        if (witness->cursor_depth == 0) {
+            witness->filled.push_back(obj);
+            noCursor.push_back(witness);
+        } else {
+            SharedCursor& shared = cursors[witness->cursor_depth];
+            if (!shared.tree) {
+                shared.tree = IncrementalMerkleTree<Depth, Hash>();
+                shared.tree->append(obj);
+            }
+            shared.witnesses.push_back(witness);
+        }
+    }
+}
+
+template<size_t Depth, typename Hash>
+void IncrementalWitnessTracker<Depth, Hash>::Flush() {
+    for (size_t d = 1; d < Depth; d++) {
+        SharedCursor& shared = cursors[d];
+        for (auto* witness : shared.witnesses) {
+            witness->cursor = shared.tree;
+            witness->cursor_depth = d;
+        }
+    }
+}
+
 template class IncrementalMerkleTree<INCREMENTAL_MERKLE_TREE_DEPTH, SHA256Compress>;
 template class IncrementalMerkleTree<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, SHA256Compress>;
 
 template class IncrementalWitness<INCREMENTAL_MERKLE_TREE_DEPTH, SHA256Compress>;
 template class IncrementalWitness<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, SHA256Compress>;
 
+template class IncrementalWitnessTracker<INCREMENTAL_MERKLE_TREE_DEPTH, SHA256Compress>;
+template class IncrementalWitnessTracker<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, SHA256Compress>;
+
 template class IncrementalMerkleTree<SAPLING_INCREMENTAL_MERKLE_TREE_DEPTH, PedersenHash>;
 template class IncrementalMerkleTree<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, PedersenHash>;
 
 template class IncrementalWitness<SAPLING_INCREMENTAL_MERKLE_TREE_DEPTH, PedersenHash>;
 template class IncrementalWitness<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, PedersenHash>;
 
+template class IncrementalWitnessTracker<SAPLING_INCREMENTAL_MERKLE_TREE_DEPTH, PedersenHash>;
+template class IncrementalWitnessTracker<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, PedersenHash>;
+
 } // end namespace `libzcash`
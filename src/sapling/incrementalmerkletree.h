@@ -15,6 +15,7 @@
 
 #include <array>
 #include <deque>
+#include <vector>
 
 namespace libzcash {
 
@@ -84,10 +85,14 @@ bool operator==(const EmptyMerkleRoots<Depth, Hash>& a,
 template<size_t Depth, typename Hash>
 class IncrementalWitness;
 
+template<size_t Depth, typename Hash>
+class IncrementalWitnessTracker;
+
 template<size_t Depth, typename Hash>
 class IncrementalMerkleTree {
 
 friend class IncrementalWitness<Depth, Hash>;
+friend class IncrementalWitnessTracker<Depth, Hash>;
 
 public:
     BOOST_STATIC_ASSERT(Depth >= 1);
@@ -152,6 +157,7 @@ bool operator==(const IncrementalMerkleTree<Depth, Hash>& a,
 template <size_t Depth, typename Hash>
 class IncrementalWitness {
 friend class IncrementalMerkleTree<Depth, Hash>;
+friend class IncrementalWitnessTracker<Depth, Hash>;
 
 public:
     // Required for Unserialize()
@@ -205,6 +211,38 @@ bool operator==(const IncrementalWitness<Depth, Hash>& a,
             a.cursor_depth == b.cursor_depth);
 }
 
+/**
+ * Appends the same commitments to a set of witnesses, sharing the hashing.
+ *
+ * The cursor of a witness is the partial subtree, at depth cursor_depth, containing the
+ * next position of the tree. There is only one such subtree per depth, so all the
+ * witnesses with the cursor at the same depth share it: each commitment is appended
+ * once per depth (at most Depth cursors) instead of once per witness, and the root of a
+ * completed subtree is computed once for all of them. The witnesses are only touched
+ * when their cursor is completed (or created), and by Flush().
+ *
+ * The witnesses added must be at the current position of the tree (i.e. contain all the
+ * commitments appended so far), and must not be changed or moved until Flush().
+ */
+template <size_t Depth, typename Hash>
+class IncrementalWitnessTracker {
+public:
+    void AddWitness(IncrementalWitness<Depth, Hash>* witness);
+    void append(Hash obj);
+    // Write the shared cursors back into the witnesses
+    void Flush();
+
+private:
+    struct SharedCursor {
+        Optional<IncrementalMerkleTree<Depth, Hash>> tree;
+        std::vector<IncrementalWitness<Depth, Hash>*> witnesses;
+    };
+    // shared cursor, by depth
+    std::array<SharedCursor, Depth> cursors;
+    // witnesses without a cursor (the next commitment fills a leaf or starts a new cursor)
+    std::vector<IncrementalWitness<Depth, Hash>*> noCursor;
+};
+
 class SHA256Compress : public uint256 {
 public:
     SHA256Compress() : uint256() {}
@@ -248,4 +286,7 @@ typedef libzcash::IncrementalMerkleTree<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, l
 typedef libzcash::IncrementalWitness<SAPLING_INCREMENTAL_MERKLE_TREE_DEPTH, libzcash::PedersenHash> SaplingWitness;
 typedef libzcash::IncrementalWitness<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, libzcash::PedersenHash> SaplingTestingWitness;
 
+typedef libzcash::IncrementalWitnessTracker<SAPLING_INCREMENTAL_MERKLE_TREE_DEPTH, libzcash::PedersenHash> SaplingWitnessTracker;
+typedef libzcash::IncrementalWitnessTracker<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, libzcash::PedersenHash> SaplingTestingWitnessTracker;
+
 #endif /* INCREMENTALMERKLETREE_H_ */
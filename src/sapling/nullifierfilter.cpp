@@ -0,0 +1,134 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "sapling/nullifierfilter.h"
+
+#include "random.h"
+
+#include <algorithm>
+#include <limits>
+
+constexpr size_t CNullifierFilter::MIN_CAPACITY;
+
+void CNullifierFilter::Reset(size_t nExpected, size_t nMaxBytesIn)
+{
+    LOCK(cs);
+    nMaxBytes = nMaxBytesIn;
+    nCapacity = std::max(nExpected, MIN_CAPACITY);
+    const size_t nBlockBytes = BLOCK_WORDS * sizeof(uint64_t);
+    const size_t nBytes = std::min(nCapacity * BITS_PER_ELEMENT / 8, nMaxBytes);
+    nBlocks = std::max<size_t>(nBytes / nBlockBytes, 1);
+    vData.assign(nBlocks * BLOCK_WORDS, 0);
+    nElements = 0;
+    k0 = GetRand(std::numeric_limits<uint64_t>::max());
+    k1 = GetRand(std::numeric_limits<uint64_t>::max());
+    fEnabled = true;
+}
+
+void CNullifierFilter::Replace(CNullifierFilter& other)
+{
+    LOCK2(cs, other.cs);
+    vData.swap(other.vData);
+    nBlocks = other.nBlocks;
+    nElements = other.nElements;
+    nCapacity = other.nCapacity;
+    nMaxBytes = other.nMaxBytes;
+    k0 = other.k0;
+    k1 = other.k1;
+    fEnabled = other.fEnabled;
+    nBuilds++;
+}
+
+void CNullifierFilter::Disable()
+{
+    LOCK(cs);
+    fEnabled = false;
+    std::vector<uint64_t>().swap(vData);
+    nBlocks = nElements = nCapacity = 0;
+}
+
+void CNullifierFilter::GetPositions(const uint256& nf, size_t& nBlock, uint64_t (&vMask)[BLOCK_WORDS]) const
+{
+    // Nullifiers are uniformly distributed already: no need to hash them again
+    const uint64_t h0 = nf.GetUint64(0) ^ k0;
+    uint64_t h1 = nf.GetUint64(1) ^ k1;
+    // Map h0 to [0, nBlocks) without a division (nBlocks < 2^32)
+    nBlock = (size_t)(((h0 & 0xffffffff) * (uint64_t)nBlocks) >> 32);
+    std::fill(std::begin(vMask), std::end(vMask), 0);
+    for (int i = 0; i < BITS_PER_KEY; i++) {
+        // 9 bits select one of the 512 bits of the block
+        const unsigned int nBit = h1 & 511;
+        vMask[nBit >> 6] |= (uint64_t)1 << (nBit & 63);
+        h1 >>= 9;
+    }
+}
+
+void CNullifierFilter::Insert(const uint256& nf)
+{
+    LOCK(cs);
+    if (!fEnabled) return;
+    size_t nBlock;
+    uint64_t vMask[BLOCK_WORDS];
+    GetPositions(nf, nBlock, vMask);
+    uint64_t* pBlock = &vData[nBlock * BLOCK_WORDS];
+    for (int i = 0; i < BLOCK_WORDS; i++) {
+        pBlock[i] |= vMask[i];
+    }
+    nElements++;
+}
+
+bool CNullifierFilter::MayContain(const uint256& nf) const
+{
+    LOCK(cs);
+    if (!fEnabled) return true;
+    size_t nBlock;
+    uint64_t vMask[BLOCK_WORDS];
+    GetPositions(nf, nBlock, vMask);
+    const uint64_t* pBlock = &vData[nBlock * BLOCK_WORDS];
+    for (int i = 0; i < BLOCK_WORDS; i++) {
+        if ((pBlock[i] & vMask[i]) != vMask[i]) {
+            nFiltered++;
+            return false;
+        }
+    }
+    return true;
+}
+
+void CNullifierFilter::CountRead(bool fFound) const
+{
+    if (fFound) {
+        nHits++;
+    } else {
+        nFalsePositives++;
+    }
+}
+
+bool CNullifierFilter::NeedsRebuild() const
+{
+    LOCK(cs);
+    return fEnabled && nElements > nCapacity && (nBlocks + 1) * BLOCK_WORDS * sizeof(uint64_t) <= nMaxBytes;
+}
+
+size_t CNullifierFilter::GetMaxBytes() const
+{
+    LOCK(cs);
+    return nMaxBytes;
+}
+
+CNullifierFilter::Stats CNullifierFilter::GetStats() const
+{
+    Stats stats;
+    {
+        LOCK(cs);
+        stats.fEnabled = fEnabled;
+        stats.nElements = nElements;
+        stats.nCapacity = nCapacity;
+        stats.nBytes = vData.size() * sizeof(uint64_t);
+        stats.nBuilds = nBuilds;
+    }
+    stats.nFiltered = nFiltered;
+    stats.nHits = nHits;
+    stats.nFalsePositives = nFalsePositives;
+    return stats;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#ifndef Hemis_SAPLING_NULLIFIERFILTER_H
+#define Hemis_SAPLING_NULLIFIERFILTER_H
+
+#include "sync.h"
+#include "uint256.h"
+
+#include <atomic>
+#include <vector>
+
+//! -maxnullifierfiltersize default (MiB)
+static const int64_t DEFAULT_MAX_NULLIFIER_FILTER_SIZE = 16;
+
+/**
+ * Blocked Bloom filter over the Sapling nullifiers of the coins database.
+ * A nullifier not in the filter is certainly not in the database, so the lookup is answered
+ * without reading it: this is the common case for the fresh nullifiers of new spends.
+ *
+ * The nullifiers removed by a block disconnection stay in the filter: they only cause a
+ * database read, until the next rebuild. The filter is built from the database at startup,
+ * and rebuilt with a bigger size once it holds more nullifiers than it was sized for.
+ */
+class CNullifierFilter
+{
+public:
+    struct Stats {
+        bool fEnabled{false};
+        size_t nElements{0};
+        size_t nCapacity{0};
+        size_t nBytes{0};
+        int nBuilds{0};
+        // Lookups answered by the filter, and passed to the database (found or not)
+        uint64_t nFiltered{0};
+        uint64_t nHits{0};
+        uint64_t nFalsePositives{0};
+    };
+
+    // Enable the filter, empty, sized for nExpected nullifiers within nMaxBytes
+    void Reset(size_t nExpected, size_t nMaxBytes);
+    // Take the content of a filter built aside, so that lookups never see it partially built
+    void Replace(CNullifierFilter& other);
+    void Disable();
+    void Insert(const uint256& nf);
+    // False if nf is certainly not in the database (or true if the filter is disabled)
+    bool MayContain(const uint256& nf) const;
+    // Result of the database read of a nullifier that the filter may contain
+    void CountRead(bool fFound) const;
+    // More nullifiers than the filter was sized for, and it can still grow
+    bool NeedsRebuild() const;
+    Stats GetStats() const;
+    size_t GetMaxBytes() const;
+
+private:
+    // Bits set for each nullifier, all in the same block of 512 bits (one cache line)
+    static constexpr int BLOCK_WORDS = 8;
+    static constexpr int BITS_PER_KEY = 6;
+    static constexpr size_t BITS_PER_ELEMENT = 16;
+    static constexpr size_t MIN_CAPACITY = 1 << 16;
+
+    mutable Mutex cs;
+    bool fEnabled GUARDED_BY(cs){false};
+    std::vector<uint64_t> vData GUARDED_BY(cs);
+    size_t nBlocks GUARDED_BY(cs){0};
+    size_t nElements GUARDED_BY(cs){0};
+    size_t nCapacity GUARDED_BY(cs){0};
+    size_t nMaxBytes GUARDED_BY(cs){0};
+    int nBuilds GUARDED_BY(cs){0};
+    // Salt, so that the bits of a nullifier differ between nodes
+    uint64_t k0 GUARDED_BY(cs){0};
+    uint64_t k1 GUARDED_BY(cs){0};
+
+    mutable std::atomic<uint64_t> nFiltered{0};
+    mutable std::atomic<uint64_t> nHits{0};
+    mutable std::atomic<uint64_t> nFalsePositives{0};
+
+    // Block index and bit positions of a nullifier
+    void GetPositions(const uint256& nf, size_t& nBlock, uint64_t (&vMask)[BLOCK_WORDS]) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+};
+
+#endif // Hemis_SAPLING_NULLIFIERFILTER_H
@@ -247,6 +247,10 @@ OperationResult SaplingOperation::build()
     // Clear dummy signatures/proofs and add real ones
     txBuilder.ClearProofsAndSignatures();
     TransactionBuilderResult txResult = txBuilder.ProveAndSign();
+    const TransactionBuilder::ProvingStats& stats = txBuilder.GetProvingStats();
+    LogPrint(BCLog::SAPLING, "%s: %d spend proofs (%.2fms) and %d output proofs (%.2fms) in %.2fms with %d threads, signatures in %.2fms\n",
+             __func__, stats.nSpends, stats.nSpendMicros * 0.001, stats.nOutputs, stats.nOutputMicros * 0.001,
+             stats.nProveMicros * 0.001, stats.nThreads, stats.nSignMicros * 0.001);
     auto opTx = txResult.GetTx();
     // Check existent tx
     if (!opTx) {
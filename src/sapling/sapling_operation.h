@@ -100,10 +100,13 @@ public:
     SaplingOperation* setMinDepth(int _mindepth) { assert(_mindepth >= 0); mindepth = _mindepth; return this; }
     SaplingOperation* setTransparentKeyChange(CReserveKey* reserveKey) { tkeyChange = reserveKey; return this; }
     SaplingOperation* setCoinControl(const CCoinControl* _coinControl) { coinControl = _coinControl; return this; }
+    // Flag owned by the caller, can be set from another thread: build() fails as soon as the proofs in progress are done.
+    SaplingOperation* setCancelFlag(const std::atomic<bool>* pfCancel) { txBuilder.SetCancelFlag(pfCancel); return this; }
 
     CAmount getFee() { return fee; }
     CTransaction getFinalTx() { return *finalTx; }
     CTransactionRef getFinalTxRef() { return finalTx; }
+    const TransactionBuilder::ProvingStats& getProvingStats() const { return txBuilder.GetProvingStats(); }
 
 private:
     /*
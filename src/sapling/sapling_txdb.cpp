@@ -4,6 +4,8 @@
 
 #include "txdb.h"
 
+#include "utiltime.h"
+
 // Db keys
 static const char DB_SAPLING_ANCHOR = 'Z';
 static const char DB_SAPLING_NULLIFIER = 'S';
@@ -17,48 +19,77 @@ bool CCoinsViewDB::GetSaplingAnchorAt(const uint256 &rt, SaplingMerkleTree &tree
         return true;
     }
 
+    if (fBackgroundFlush) {
+        LOCK(cs_flush);
+        if (pendingFlush) {
+            auto it = pendingFlush->mapSaplingAnchors.find(rt);
+            if (it != pendingFlush->mapSaplingAnchors.end()) {
+                if (!it->second.entered) return false;
+                tree = it->second.tree;
+                return true;
+            }
+        }
+    }
+
     bool read = db.Read(std::make_pair(DB_SAPLING_ANCHOR, rt), tree);
 
     return read;
 }
 
 bool CCoinsViewDB::GetNullifier(const uint256 &nf) const {
+    if (fBackgroundFlush) {
+        LOCK(cs_flush);
+        if (pendingFlush) {
+            auto it = pendingFlush->mapSaplingNullifiers.find(nf);
+            if (it != pendingFlush->mapSaplingNullifiers.end()) return it->second.entered;
+        }
+    }
+    if (!nullifierFilter.MayContain(nf)) {
+        return false;
+    }
     bool spent = false;
-    return db.Read(std::make_pair(DB_SAPLING_NULLIFIER, nf), spent);
+    bool read = db.Read(std::make_pair(DB_SAPLING_NULLIFIER, nf), spent);
+    nullifierFilter.CountRead(read);
+    return read;
 }
 
 uint256 CCoinsViewDB::GetBestAnchor() const {
+    if (fBackgroundFlush) {
+        LOCK(cs_flush);
+        if (pendingFlush && !pendingFlush->hashSaplingAnchor.IsNull()) return pendingFlush->hashSaplingAnchor;
+    }
     uint256 hashBestAnchor;
     if (!db.Read(DB_BEST_SAPLING_ANCHOR, hashBestAnchor))
         return SaplingMerkleTree::empty_root();
     return hashBestAnchor;
 }
 
-void BatchWriteNullifiers(CDBBatch& batch, CNullifiersMap& mapToUse, const char& dbChar)
+void BatchWriteNullifiers(CDBBatch& batch, const CNullifiersMap& mapToUse, const char& dbChar, CNullifierFilter& filter)
 {
     size_t count = 0;
     size_t changed = 0;
-    for (CNullifiersMap::iterator it = mapToUse.begin(); it != mapToUse.end();) {
+    for (CNullifiersMap::const_iterator it = mapToUse.begin(); it != mapToUse.end(); it++) {
         if (it->second.flags & CNullifiersCacheEntry::DIRTY) {
             if (!it->second.entered)
                 batch.Erase(std::make_pair(dbChar, it->first));
-            else
+            else {
                 batch.Write(std::make_pair(dbChar, it->first), true);
+                // Erased nullifiers stay in the filter, it only costs a read
+                filter.Insert(it->first);
+            }
             changed++;
         }
         count++;
-        CNullifiersMap::iterator itOld = it++;
-        mapToUse.erase(itOld);
     }
     LogPrint(BCLog::COINDB, "Committed %u changed nullifiers (out of %u) to coin database...\n", (unsigned int)changed, (unsigned int)count);
 }
 
 template<typename Map, typename MapIterator, typename MapEntry, typename Tree>
-void BatchWriteAnchors(CDBBatch& batch, Map& mapToUse, const char& dbChar)
+void BatchWriteAnchors(CDBBatch& batch, const Map& mapToUse, const char& dbChar)
 {
     size_t count = 0;
     size_t changed = 0;
-    for (MapIterator it = mapToUse.begin(); it != mapToUse.end();) {
+    for (MapIterator it = mapToUse.begin(); it != mapToUse.end(); it++) {
         if (it->second.flags & MapEntry::DIRTY) {
             if (!it->second.entered)
                 batch.Erase(std::make_pair(dbChar, it->first));
@@ -70,20 +101,60 @@ void BatchWriteAnchors(CDBBatch& batch, Map& mapToUse, const char& dbChar)
             changed++;
         }
         count++;
-        MapIterator itOld = it++;
-        mapToUse.erase(itOld);
     }
     LogPrint(BCLog::COINDB, "Committed %u changed sapling anchors (out of %u) to coin database...\n", (unsigned int)changed, (unsigned int)count);
 }
 
 bool CCoinsViewDB::BatchWriteSapling(const uint256& hashSaplingAnchor,
-                              CAnchorsSaplingMap& mapSaplingAnchors,
-                              CNullifiersMap& mapSaplingNullifiers,
+                              const CAnchorsSaplingMap& mapSaplingAnchors,
+                              const CNullifiersMap& mapSaplingNullifiers,
                               CDBBatch& batch) {
 
-    ::BatchWriteAnchors<CAnchorsSaplingMap, CAnchorsSaplingMap::iterator, CAnchorsSaplingCacheEntry, SaplingMerkleTree>(batch, mapSaplingAnchors, DB_SAPLING_ANCHOR);
-    ::BatchWriteNullifiers(batch, mapSaplingNullifiers, DB_SAPLING_NULLIFIER);
+    ::BatchWriteAnchors<CAnchorsSaplingMap, CAnchorsSaplingMap::const_iterator, CAnchorsSaplingCacheEntry, SaplingMerkleTree>(batch, mapSaplingAnchors, DB_SAPLING_ANCHOR);
+    ::BatchWriteNullifiers(batch, mapSaplingNullifiers, DB_SAPLING_NULLIFIER, nullifierFilter);
     if (!hashSaplingAnchor.IsNull())
         batch.Write(DB_BEST_SAPLING_ANCHOR, hashSaplingAnchor);
     return true;
 }
+
+bool CCoinsViewDB::LoadNullifierFilter(size_t nMaxBytes)
+{
+    if (nMaxBytes == 0) {
+        nullifierFilter.Disable();
+        return true;
+    }
+
+    // The number of nullifiers is known only after the scan: size the filter for the
+    // previous count, and scan again in the unlikely case that it turns out too small.
+    int64_t nStart = GetTimeMillis();
+    size_t nExpected = nullifierFilter.GetStats().nElements * 2;
+    CNullifierFilter newFilter;
+    for (int nPass = 0; nPass < 2; nPass++) {
+        newFilter.Reset(nExpected, nMaxBytes);
+        std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+        pcursor->Seek(std::make_pair(DB_SAPLING_NULLIFIER, UINT256_ZERO));
+        size_t nCount = 0;
+        while (pcursor->Valid()) {
+            std::pair<char, uint256> key;
+            if (!pcursor->GetKey(key) || key.first != DB_SAPLING_NULLIFIER) {
+                break;
+            }
+            newFilter.Insert(key.second);
+            nCount++;
+            pcursor->Next();
+        }
+        if (!newFilter.NeedsRebuild()) break;
+        nExpected = nCount * 2;
+    }
+    nullifierFilter.Replace(newFilter);
+
+    const CNullifierFilter::Stats stats = nullifierFilter.GetStats();
+    LogPrint(BCLog::COINDB, "Loaded %u Sapling nullifiers in a %u KiB filter in %dms\n",
+             (unsigned int)stats.nElements, (unsigned int)(stats.nBytes >> 10), GetTimeMillis() - nStart);
+    return true;
+}
+
+CNullifierFilter::Stats CCoinsViewDB::GetNullifierFilterStats() const
+{
+    return nullifierFilter.GetStats();
+}
@@ -9,12 +9,37 @@
 #include "script/interpreter.h" // for SigHash
 #include "consensus/validation.h" // for CValidationState
 #include "util/system.h" // for error()
-#include "consensus/upgrades.h" // for CurrentEpochBranchId()
+#include "consensus/upgrades.h" // for CurrentEpoch()
+#include "crypto/sha256.h"
+#include "random.h"
 
 #include <librustzcash.h>
 
 namespace SaplingValidation {
 
+static CProofCache proofCache;
+
+CProofCache::CProofCache()
+{
+    GetRandBytes(nonce.begin(), 32);
+}
+
+void CProofCache::ComputeEntry(uint256& entry, const CTransaction& tx, int nEpoch) const
+{
+    CSHA256().Write(nonce.begin(), 32)
+             .Write(tx.GetHash().begin(), 32)
+             .Write((const unsigned char*)&nEpoch, sizeof(nEpoch))
+             .Finalize(entry.begin());
+}
+
+void InitProofCache()
+{
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-maxsaplingproofcachesize", DEFAULT_MAX_SAPLING_PROOF_CACHE_SIZE)), MAX_MAX_SAPLING_PROOF_CACHE_SIZE) * ((size_t) 1 << 20);
+    size_t nElems = proofCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for Sapling proof cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
+
 // Verifies that Shielded txs are properly formed and performs content-independent checks
 bool CheckTransaction(const CTransaction& tx, CValidationState& state, CAmount& nValueOut)
 {
@@ -116,7 +141,8 @@ bool ContextualCheckTransaction(
         const CChainParams& chainparams,
         const int nHeight,
         const bool isMined,
-        bool isInitBlockDownload)
+        bool isInitBlockDownload,
+        ProofCheckResult proofResult)
 {
     const int DOS_LEVEL_BLOCK = 100;
     // DoS level set to 10 to be more forgiving.
@@ -159,71 +185,108 @@ bool ContextualCheckTransaction(
     }
 
     if (hasShieldedData) {
-        uint256 dataToBeSigned;
-        // Empty output script.
-        CScript scriptCode;
-        try {
-            dataToBeSigned = SignatureHash(scriptCode, tx, NOT_AN_INPUT, SIGHASH_ALL, 0, SIGVERSION_SAPLING);
-        } catch (const std::logic_error& ex) {
-            // A logic error should never occur because we pass NOT_AN_INPUT and
-            // SIGHASH_ALL to SignatureHash().
-            return state.DoS(100, error("%s: error computing signature hash", __func__ ),
-                             REJECT_INVALID, "error-computing-signature-hash");
+        if (proofResult == ProofCheckResult::UNCHECKED) {
+            // Cache the proofs checked for the mempool, so they don't need to be verified again in the block
+            proofResult = CheckProofs(tx, nHeight, !isMined);
         }
-
-        // Sapling verification process
-        auto ctx = librustzcash_sapling_verification_ctx_init();
-
-        for (const SpendDescription &spend : tx.sapData->vShieldedSpend) {
-            if (!librustzcash_sapling_check_spend(
-                    ctx,
-                    spend.cv.begin(),
-                    spend.anchor.begin(),
-                    spend.nullifier.begin(),
-                    spend.rk.begin(),
-                    spend.zkproof.begin(),
-                    spend.spendAuthSig.begin(),
-                    dataToBeSigned.begin())) {
-                librustzcash_sapling_verification_ctx_free(ctx);
+        switch (proofResult) {
+            case ProofCheckResult::VALID:
+                break;
+            case ProofCheckResult::SIGHASH_ERROR:
+                // A logic error should never occur because we pass NOT_AN_INPUT and
+                // SIGHASH_ALL to SignatureHash().
+                return state.DoS(100, error("%s: error computing signature hash", __func__ ),
+                                 REJECT_INVALID, "error-computing-signature-hash");
+            case ProofCheckResult::INVALID_SPEND:
                 return state.DoS(
                         dosLevelPotentiallyRelaxing,
                         error("%s: Sapling spend description invalid", __func__ ),
                         REJECT_INVALID, "bad-txns-sapling-spend-description-invalid");
-            }
-        }
-
-        for (const OutputDescription &output : tx.sapData->vShieldedOutput) {
-            if (!librustzcash_sapling_check_output(
-                    ctx,
-                    output.cv.begin(),
-                    output.cmu.begin(),
-                    output.ephemeralKey.begin(),
-                    output.zkproof.begin())) {
-                librustzcash_sapling_verification_ctx_free(ctx);
+            case ProofCheckResult::INVALID_OUTPUT:
                 // This should be a non-contextual check, but we check it here
                 // as we need to pass over the outputs anyway in order to then
                 // call librustzcash_sapling_final_check().
                 return state.DoS(100, error("%s: Sapling output description invalid", __func__ ),
                                  REJECT_INVALID, "bad-txns-sapling-output-description-invalid");
-            }
+            case ProofCheckResult::INVALID_BINDING_SIG:
+            case ProofCheckResult::UNCHECKED:
+                return state.DoS(
+                        dosLevelPotentiallyRelaxing,
+                        error("%s: Sapling binding signature invalid", __func__ ),
+                        REJECT_INVALID, "bad-txns-sapling-binding-signature-invalid");
         }
+    }
+    return true;
+}
 
-        if (!librustzcash_sapling_final_check(
+ProofCheckResult CheckProofs(const CTransaction& tx, int nHeight, bool fStore)
+{
+    uint256 entry;
+    proofCache.ComputeEntry(entry, tx, CurrentEpoch(nHeight, Params().GetConsensus()));
+    if (proofCache.Get(entry, !fStore)) {
+        return ProofCheckResult::VALID;
+    }
+
+    uint256 dataToBeSigned;
+    // Empty output script.
+    CScript scriptCode;
+    try {
+        dataToBeSigned = SignatureHash(scriptCode, tx, NOT_AN_INPUT, SIGHASH_ALL, 0, SIGVERSION_SAPLING);
+    } catch (const std::logic_error& ex) {
+        return ProofCheckResult::SIGHASH_ERROR;
+    }
+
+    // Sapling verification process
+    WaitForZKSNARKS();
+    auto ctx = librustzcash_sapling_verification_ctx_init();
+
+    for (const SpendDescription &spend : tx.sapData->vShieldedSpend) {
+        if (!librustzcash_sapling_check_spend(
                 ctx,
-                tx.sapData->valueBalance,
-                tx.sapData->bindingSig.begin(),
+                spend.cv.begin(),
+                spend.anchor.begin(),
+                spend.nullifier.begin(),
+                spend.rk.begin(),
+                spend.zkproof.begin(),
+                spend.spendAuthSig.begin(),
                 dataToBeSigned.begin())) {
             librustzcash_sapling_verification_ctx_free(ctx);
-            return state.DoS(
-                    dosLevelPotentiallyRelaxing,
-                    error("%s: Sapling binding signature invalid", __func__ ),
-                    REJECT_INVALID, "bad-txns-sapling-binding-signature-invalid");
+            return ProofCheckResult::INVALID_SPEND;
+        }
+    }
+
+    for (const OutputDescription &output : tx.sapData->vShieldedOutput) {
+        if (!librustzcash_sapling_check_output(
+                ctx,
+                output.cv.begin(),
+                output.cmu.begin(),
+                output.ephemeralKey.begin(),
+                output.zkproof.begin())) {
+            librustzcash_sapling_verification_ctx_free(ctx);
+            return ProofCheckResult::INVALID_OUTPUT;
         }
+    }
 
+    if (!librustzcash_sapling_final_check(
+            ctx,
+            tx.sapData->valueBalance,
+            tx.sapData->bindingSig.begin(),
+            dataToBeSigned.begin())) {
         librustzcash_sapling_verification_ctx_free(ctx);
+        return ProofCheckResult::INVALID_BINDING_SIG;
     }
-    return true;
+
+    librustzcash_sapling_verification_ctx_free(ctx);
+    if (fStore) {
+        proofCache.Set(entry);
+    }
+    return ProofCheckResult::VALID;
 }
 
+bool CProofCheck::operator()()
+{
+    *pResult = CheckProofs(*ptx, nHeight);
+    return *pResult == ProofCheckResult::VALID;
+}
 
 } // End SaplingValidation namespace
@@ -7,12 +7,81 @@
 #define Hemis_SAPLING_VALIDATION_H
 
 #include "chainparams.h"
+#include "cuckoocache.h"
+#include "script/sigcache.h" // for SignatureCacheHasher
+#include "uint256.h"
+
+#include <boost/thread/shared_mutex.hpp>
 
 class CTransaction;
 class CValidationState;
 
+// Limit the size of the Sapling proof cache to 4MB (over 130000 shielded transactions)
+static const unsigned int DEFAULT_MAX_SAPLING_PROOF_CACHE_SIZE = 4;
+// Maximum Sapling proof cache size allowed
+static const int64_t MAX_MAX_SAPLING_PROOF_CACHE_SIZE = 1024;
+
 namespace SaplingValidation {
 
+/** Outcome of the verification of the zk-proofs and signatures of a shielded transaction */
+enum class ProofCheckResult {
+    UNCHECKED,
+    VALID,
+    SIGHASH_ERROR,
+    INVALID_SPEND,
+    INVALID_OUTPUT,
+    INVALID_BINDING_SIG,
+};
+
+/**
+ * Valid proofs cache, to avoid verifying the zk-proofs and the signatures of a
+ * shielded transaction twice (once when accepted into memory pool, and again
+ * when accepted into the block chain).
+ */
+class CProofCache
+{
+private:
+    //! Entries are SHA256(nonce || txid || epoch). The txid commits to the whole shielded
+    //! bundle, and to the transparent data covered by the signature hash. The epoch (the last
+    //! network upgrade active) makes the transactions checked before an upgrade be checked again.
+    uint256 nonce;
+    CuckooCache::cache<uint256, SignatureCacheHasher> setValid;
+    boost::shared_mutex cs_proofcache;
+
+public:
+    CProofCache();
+
+    void ComputeEntry(uint256& entry, const CTransaction& tx, int nEpoch) const;
+
+    bool Get(const uint256& entry, const bool erase)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+        return setValid.contains(entry, erase);
+    }
+
+    void Set(uint256& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+        setValid.insert(entry);
+    }
+
+    uint32_t setup_bytes(size_t n)
+    {
+        return setValid.setup_bytes(n);
+    }
+};
+
+/** To be called once in AppInitMain/BasicTestingSetup to initialize the proof cache */
+void InitProofCache();
+
+/**
+ * Verify the spend/output proofs, the spend auth signatures and the binding signature of a shielded transaction.
+ * Transactions already verified (when accepted to the mempool) are found in the proof cache,
+ * unless a network upgrade activated since (nHeight is the height of the block including tx).
+ * If fStore is true, a valid transaction is added to the cache, otherwise it's removed from it.
+ */
+ProofCheckResult CheckProofs(const CTransaction& tx, int nHeight, bool fStore = false);
+
 /** Context-independent validity checks */
 // Note: for v3+, if the tx has no shielded data, this method returns true.
 // Note2: This function only performs shielded data related checks, it does NOT checks regular inputs and outputs.
@@ -21,9 +90,33 @@ bool CheckTransactionWithoutProofVerification(const CTransaction& tx, CValidatio
 
 /** Check a transaction contextually against a set of consensus rules */
 // Note: if v5 upgrade wasn't enforced, this method returns true without performing any check.
+// Note2: proofResult can carry the outcome of CheckProofs, if already computed (e.g. for the whole block).
 bool ContextualCheckTransaction(const CTransaction &tx, CValidationState &state,
                                 const CChainParams &chainparams, int nHeight, bool isMined,
-                                bool sInitBlockDownload);
+                                bool sInitBlockDownload,
+                                ProofCheckResult proofResult = ProofCheckResult::UNCHECKED);
+
+/** Sapling proofs of a transaction, to be verified on a CCheckQueue */
+class CProofCheck
+{
+private:
+    const CTransaction* ptx{nullptr};
+    int nHeight{0};
+    ProofCheckResult* pResult{nullptr};
+
+public:
+    CProofCheck() = default;
+    CProofCheck(const CTransaction& tx, int nHeightIn, ProofCheckResult* pResultIn) : ptx(&tx), nHeight(nHeightIn), pResult(pResultIn) {}
+
+    bool operator()();
+
+    void swap(CProofCheck& check)
+    {
+        std::swap(ptx, check.ptx);
+        std::swap(nHeight, check.nHeight);
+        std::swap(pResult, check.pResult);
+    }
+};
 
 }; // End SaplingValidation namespace
 
@@ -149,19 +149,6 @@ void CopyPreviousWitnesses(NoteDataMap& noteDataMap, int indexHeight, int64_t nW
     }
 }
 
-void AppendNoteCommitment(SaplingNoteData* nd, int indexHeight, int64_t nWitnessCacheSize, const uint256& note_commitment)
-{
-    // skip externally sent notes
-    if (!nd->IsMyNote()) return;
-    // No empty witnesses can reach here. Before any append, the note must be already witnessed.
-    if (nd->witnessHeight < indexHeight && nd->witnesses.size() > 0) {
-        // Check the validity of the cache
-        // See comment in CopyPreviousWitnesses about validity.
-        assert(nWitnessCacheSize >= (int64_t) nd->witnesses.size());
-        nd->witnesses.front().append(note_commitment);
-    }
-}
-
 template<typename Witness>
 void WitnessNoteIfMine(SaplingNoteData* nd,
                        int indexHeight,
@@ -224,67 +211,69 @@ void SaplingScriptPubKeyMan::IncrementNoteWitnesses(const CBlockIndex* pindex,
         nWitnessCacheNeedsUpdate = true;
     }
 
-    // 1) Loop over the block txs and gather the note commitments ordered.
-    // If the wtx is from this wallet, witness it and append the following block note commitments on top.
-    std::vector<uint256> noteCommitments;
-    std::vector<std::pair<CWalletTx*, SaplingNoteData*>> inBlockArrivingNotes;
+    // The wallet txs arriving in this block are witnessed below, when their notes are appended
+    std::set<uint256> inBlockWalletTxs;
+    for (const auto& tx : pblock->vtx) {
+        if (tx->IsShieldedTx() && wallet->mapWallet.count(tx->GetHash())) {
+            inBlockWalletTxs.emplace(tx->GetHash());
+        }
+    }
+
+    // 1) Loop over the shield txs in the wallet's map (excluding the wtx arriving in this block) and
+    //    for each note not processed yet, copy the previous witness and add the copy to the tracker.
+    //    All these witnesses are at the tip of the previous block, so they share the tracker's cursors,
+    //    and each block note commitment is hashed once per tree level instead of once per note.
+    SaplingWitnessTracker tracker;
+    for (auto& it : wallet->mapWallet) {
+        CWalletTx& wtx = it.second;
+        if (wtx.mapSaplingNoteData.empty() || inBlockWalletTxs.count(it.first)) continue;
+        // Create copy of the previous witness (verifying pre-arriving block witness cache size)
+        ::CopyPreviousWitnesses(wtx.mapSaplingNoteData, chainHeight, prevWitCacheSize);
+        for (auto& item : wtx.mapSaplingNoteData) {
+            SaplingNoteData* nd = &item.second;
+            // No empty witnesses can be incremented. Before any append, the note must be already witnessed.
+            if (nd->IsMyNote() && nd->witnessHeight < chainHeight && !nd->witnesses.empty()) {
+                assert(nWitnessCacheSize >= (int64_t) nd->witnesses.size());
+                tracker.AddWitness(&nd->witnesses.front());
+            }
+        }
+    }
+
+    // 2) Loop over the block txs and append the note commitments, in order.
+    //    If the wtx is from this wallet, witness its notes, and add them to the tracker
+    //    to append the following block note commitments on top.
     for (const auto& tx : pblock->vtx) {
         if (!tx->IsShieldedTx()) continue;
 
         const auto& hash = tx->GetHash();
-        auto it = wallet->mapWallet.find(hash);
+        auto it = inBlockWalletTxs.count(hash) ? wallet->mapWallet.find(hash) : wallet->mapWallet.end();
         bool txIsOurs = it != wallet->mapWallet.end();
 
         for (uint32_t i = 0; i < tx->sapData->vShieldedOutput.size(); i++) {
             const auto& cmu = tx->sapData->vShieldedOutput[i].cmu;
-            noteCommitments.emplace_back(cmu);
-
-            // Append note commitment to the in-block wallet's notes.
-            // This is processed here because we already looked for the wtx on
-            // the WitnessNoteIfMine call and only need to append the follow-up block notes,
-            // not every block note (check below).
-            for (auto& item : inBlockArrivingNotes) {
-                ::AppendNoteCommitment(item.second, chainHeight, nWitnessCacheSize, cmu);
-            }
+            tracker.append(cmu);
+            saplingTreeRes.append(cmu);
 
             // If tx is from this wallet, try to witness the note for the first time (if exists).
-            // And add it to the in-block arriving txs.
-            saplingTreeRes.append(cmu);
             if (txIsOurs) {
                 CWalletTx* wtx = &it->second;
                 auto ndIt = wtx->mapSaplingNoteData.find({hash, i});
                 if (ndIt != wtx->mapSaplingNoteData.end()) {
                     SaplingNoteData* nd = &ndIt->second;
                     ::WitnessNoteIfMine(nd, chainHeight, nWitnessCacheSize, saplingTreeRes.witness());
-                    inBlockArrivingNotes.emplace_back(std::make_pair(wtx, nd));
+                    if (nd->IsMyNote() && nd->witnessHeight < chainHeight) {
+                        tracker.AddWitness(&nd->witnesses.front());
+                    }
                 }
             }
         }
     }
+    tracker.Flush();
 
-    // 2) Mark already sync wtx, so we don't process them again.
-    for (auto& item : inBlockArrivingNotes) {
-        ::UpdateWitnessHeights(item.first->mapSaplingNoteData, chainHeight, nWitnessCacheSize);
-    }
-
-    // 3) Loop over the shield txs in the wallet's map (excluding the wtx arriving in this block) and for each tx:
-    //    a) Copy the previous witness.
-    //    b) Append all new notes commitments
-    //    c) Update witness last processed height
+    // 3) Set the last processed height.
     for (auto& it : wallet->mapWallet) {
         CWalletTx& wtx = it.second;
         if (!wtx.mapSaplingNoteData.empty()) {
-            // Create copy of the previous witness (verifying pre-arriving block witness cache size)
-            ::CopyPreviousWitnesses(wtx.mapSaplingNoteData, chainHeight, prevWitCacheSize);
-
-            // Append new notes commitments.
-            for (auto& noteComm : noteCommitments) {
-                for (auto& item : wtx.mapSaplingNoteData) {
-                    AppendNoteCommitment(&(item.second), chainHeight, nWitnessCacheSize, noteComm);
-                }
-            }
-
-            // Set last processed height.
             ::UpdateWitnessHeights(wtx.mapSaplingNoteData, chainHeight, nWitnessCacheSize);
         }
     }
@@ -370,42 +359,48 @@ std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap> SaplingScriptPubKe
         return {};
     }
 
+    // Decrypt with a copy of the keys, so the key store isn't locked during the trials
+    std::vector<libzcash::SaplingIncomingViewingKey> vIvks;
+    {
+        LOCK(wallet->cs_KeyStore);
+        vIvks.reserve(wallet->mapSaplingFullViewingKeys.size());
+        for (const auto& it : wallet->mapSaplingFullViewingKeys) {
+            vIvks.emplace_back(it.first);
+        }
+    }
+    if (vIvks.empty()) {
+        return {};
+    }
+
+    // Protocol Spec: 4.19 Block Chain Scanning (Sapling)
+    const auto& vMatches = trialDecryptor.Decrypt(tx.sapData->vShieldedOutput, vIvks);
+
     LOCK(wallet->cs_KeyStore);
     const uint256& hash = tx.GetHash();
 
     mapSaplingNoteData_t noteData;
     SaplingIncomingViewingKeyMap viewingKeysToAdd;
 
-    // Protocol Spec: 4.19 Block Chain Scanning (Sapling)
-    for (uint32_t i = 0; i < tx.sapData->vShieldedOutput.size(); ++i) {
-        const OutputDescription output = tx.sapData->vShieldedOutput[i];
-        for (auto it = wallet->mapSaplingFullViewingKeys.begin(); it != wallet->mapSaplingFullViewingKeys.end(); ++it) {
-            libzcash::SaplingIncomingViewingKey ivk = it->first;
-            auto result = libzcash::SaplingNotePlaintext::decrypt(output.encCiphertext, ivk, output.ephemeralKey, output.cmu);
-            if (!result) {
-                continue;
-            }
-
-            // Check if we already have it.
-            Optional<libzcash::SaplingPaymentAddress> address = ivk.address(result.get().d);
-            if (address && wallet->mapSaplingIncomingViewingKeys.count(address.get()) == 0) {
-                viewingKeysToAdd[address.get()] = ivk;
-            }
-            // We don't cache the nullifier here as computing it requires knowledge of the note position
-            // in the commitment tree, which can only be determined when the transaction has been mined.
-            SaplingOutPoint op {hash, i};
-            SaplingNoteData nd;
-            nd.ivk = ivk;
-            nd.amount = result->value();
-            nd.address = address;
-            const auto& memo = result->memo();
-            // don't save empty memo (starting with 0xF6)
-            if (memo[0] < 0xF6) {
-                nd.memo = memo;
-            }
-            noteData.insert(std::make_pair(op, nd));
-            break;
+    for (const auto& match : vMatches) {
+        const libzcash::SaplingIncomingViewingKey& ivk = match.ivk;
+        // Check if we already have it.
+        Optional<libzcash::SaplingPaymentAddress> address = ivk.address(match.plaintext.d);
+        if (address && wallet->mapSaplingIncomingViewingKeys.count(address.get()) == 0) {
+            viewingKeysToAdd[address.get()] = ivk;
+        }
+        // We don't cache the nullifier here as computing it requires knowledge of the note position
+        // in the commitment tree, which can only be determined when the transaction has been mined.
+        SaplingOutPoint op {hash, match.nOutput};
+        SaplingNoteData nd;
+        nd.ivk = ivk;
+        nd.amount = match.plaintext.value();
+        nd.address = address;
+        const auto& memo = match.plaintext.memo();
+        // don't save empty memo (starting with 0xF6)
+        if (memo[0] < 0xF6) {
+            nd.memo = memo;
         }
+        noteData.insert(std::make_pair(op, nd));
     }
 
     return std::make_pair(noteData, viewingKeysToAdd);
@@ -434,6 +429,16 @@ std::vector<libzcash::SaplingPaymentAddress> SaplingScriptPubKeyMan::FindMySapli
     return ret;
 }
 
+void SaplingScriptPubKeyMan::StartDecryptionWorkers(int nThreads)
+{
+    trialDecryptor.StartWorkers(nThreads);
+}
+
+SaplingTrialDecryptor::Stats SaplingScriptPubKeyMan::GetTrialDecryptionStats() const
+{
+    return trialDecryptor.GetStats();
+}
+
 void SaplingScriptPubKeyMan::GetNotes(const std::vector<SaplingOutPoint>& saplingOutpoints,
                                       std::vector<SaplingNoteEntry>& saplingEntriesRet) const
 {
@@ -8,6 +8,7 @@
 #include "consensus/consensus.h"
 #include "sapling/incrementalmerkletree.h"
 #include "sapling/note.h"
+#include "sapling/trialdecryption.h"
 #include "wallet/hdchain.h"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
@@ -272,6 +273,11 @@ public:
     //! SaplingPaymentAddress in this wallet
     std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap> FindMySaplingNotes(const CTransaction& tx) const;
 
+    //! Split the trial decryption of FindMySaplingNotes over nThreads threads (-saplingdecryptthreads)
+    void StartDecryptionWorkers(int nThreads);
+    //! Throughput of the trial decryption of FindMySaplingNotes
+    SaplingTrialDecryptor::Stats GetTrialDecryptionStats() const;
+
     //! Find all of the addresses in the given tx that have been sent to a SaplingPaymentAddress in this wallet.
     std::vector<libzcash::SaplingPaymentAddress> FindMySaplingAddresses(const CTransaction& tx) const;
 
@@ -415,6 +421,8 @@ private:
     /* cached common OVK for sapling spends from t addresses */
     Optional<uint256> commonOVK;
     uint256 getCommonOVKFromSeed() const;
+    /* trial decryption of the shielded outputs with the wallet viewing keys */
+    SaplingTrialDecryptor trialDecryptor;
 
 
     /**
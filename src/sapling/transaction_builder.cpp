@@ -5,12 +5,18 @@
 
 #include "sapling/transaction_builder.h"
 
+#include "ctpl_stl.h"
 #include "script/sign.h"
 #include "utilmoneystr.h"
 #include "consensus/upgrades.h"
 #include "policy/policy.h"
+#include "util/system.h"
+#include "util/threadnames.h"
+#include "utiltime.h"
 #include "validation.h"
 
+#include <future>
+
 #include <librustzcash.h>
 
 SpendDescriptionInfo::SpendDescriptionInfo(const libzcash::SaplingExpandedSpendingKey& _expsk,
@@ -231,66 +237,141 @@ void TransactionBuilder::SendChangeTo(const CTxDestination& changeAddr)
     saplingChangeAddr = nullopt;
 }
 
-TransactionBuilderResult TransactionBuilder::ProveAndSign()
+bool TransactionBuilder::ProveOutput(size_t nPos, void* ctx, OutputDescription& odesc, std::string& strError)
+{
+    OutputDescriptionInfo& output = outputs[nPos];
+    // Check this out here as well to provide better logging.
+    if (!output.note.cmu()) {
+        strError = "Output is invalid";
+        return false;
+    }
+
+    auto res = output.Build(ctx);
+    if (!res) {
+        strError = "Failed to create output description";
+        return false;
+    }
+    odesc = *res;
+    return true;
+}
+
+bool TransactionBuilder::ProveSpend(size_t nPos, void* ctx, SpendDescription& sdesc, std::string& strError)
+{
+    const SpendDescriptionInfo& spend = spends[nPos];
+    auto cm = spend.note.cmu();
+    auto nf = spend.note.nullifier(
+            spend.expsk.full_viewing_key(), spend.witness.position());
+    if (!cm || !nf) {
+        strError = "Spend is invalid";
+        return false;
+    }
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << spend.witness.path();
+    std::vector<unsigned char> witness(ss.begin(), ss.end());
+
+    if (!librustzcash_sapling_spend_proof(
+            ctx,
+            spend.expsk.full_viewing_key().ak.begin(),
+            spend.expsk.nsk.begin(),
+            spend.note.d.data(),
+            spend.note.r.begin(),
+            spend.alpha.begin(),
+            spend.note.value(),
+            spend.anchor.begin(),
+            witness.data(),
+            sdesc.cv.begin(),
+            sdesc.rk.begin(),
+            sdesc.zkproof.data())) {
+        strError = "Spend proof failed";
+        return false;
+    }
+
+    sdesc.anchor = spend.anchor;
+    sdesc.nullifier = *nf;
+    return true;
+}
+
+TransactionBuilderResult TransactionBuilder::ProveAndSign(int nThreads)
 {
+    provingStats = ProvingStats();
+    provingStats.nSpends = spends.size();
+    provingStats.nOutputs = outputs.size();
+
     //
     // Sapling spend descriptions
     //
     if (!spends.empty() || !outputs.empty()) {
-
-        auto ctx = librustzcash_sapling_proving_ctx_init();
-
-        // Create Sapling OutputDescriptions
-        for (auto output : outputs) {
-            // Check this out here as well to provide better logging.
-            if (!output.note.cmu()) {
-                librustzcash_sapling_proving_ctx_free(ctx);
-                return TransactionBuilderResult("Output is invalid");
-            }
-
-            auto odesc = output.Build(ctx);
-            if (!odesc) {
-                librustzcash_sapling_proving_ctx_free(ctx);
-                return TransactionBuilderResult("Failed to create output description");
+        const int64_t nTimeStart = GetTimeMicros();
+
+        // One job (and one proving context) for each output, and then each spend.
+        // The value commitments of the job contexts are merged afterwards, so the
+        // binding signature covers all of them.
+        const size_t nJobs = outputs.size() + spends.size();
+        std::vector<OutputDescription> vOutputs(outputs.size());
+        std::vector<SpendDescription> vSpends(spends.size());
+        std::vector<void*> vCtx(nJobs, nullptr);
+        std::vector<std::string> vErrors(nJobs);
+        std::vector<int64_t> vMicros(nJobs, 0);
+        std::atomic<bool> fFailed{false};
+
+        auto prove = [&](size_t nJob) {
+            if (fFailed || (pfCancel && *pfCancel)) return;
+            const int64_t nJobStart = GetTimeMicros();
+            vCtx[nJob] = librustzcash_sapling_proving_ctx_init();
+            const bool fOk = nJob < outputs.size() ?
+                    ProveOutput(nJob, vCtx[nJob], vOutputs[nJob], vErrors[nJob]) :
+                    ProveSpend(nJob - outputs.size(), vCtx[nJob], vSpends[nJob - outputs.size()], vErrors[nJob]);
+            if (!fOk) fFailed = true;
+            vMicros[nJob] = GetTimeMicros() - nJobStart;
+        };
+
+        WaitForZKSNARKS();
+        if (nThreads <= 0) nThreads = GetNumCores();
+        nThreads = (int) std::max<size_t>(1, std::min<size_t>(nThreads, nJobs));
+        if (nThreads == 1) {
+            for (size_t i = 0; i < nJobs; i++) prove(i);
+        } else {
+            ctpl::thread_pool pool(nThreads);
+            RenameThreadPool(pool, "Hemis-zprove");
+            std::vector<std::future<void>> vFutures;
+            vFutures.reserve(nJobs);
+            for (size_t i = 0; i < nJobs; i++) {
+                vFutures.emplace_back(pool.push([&prove, i](int) { prove(i); }));
             }
+            for (auto& f : vFutures) f.get();
+        }
 
-            mtx.sapData->vShieldedOutput.push_back(odesc.get());
+        provingStats.nThreads = nThreads;
+        for (size_t i = 0; i < nJobs; i++) {
+            (i < outputs.size() ? provingStats.nOutputMicros : provingStats.nSpendMicros) += vMicros[i];
         }
+        provingStats.nProveMicros = GetTimeMicros() - nTimeStart;
 
-        // Create Sapling SpendDescriptions
-        for (auto spend : spends) {
-            auto cm = spend.note.cmu();
-            auto nf = spend.note.nullifier(
-                    spend.expsk.full_viewing_key(), spend.witness.position());
-            if (!cm || !nf) {
-                librustzcash_sapling_proving_ctx_free(ctx);
-                return TransactionBuilderResult("Spend is invalid");
-            }
+        auto ctx = librustzcash_sapling_proving_ctx_init();
+        for (void* jobCtx : vCtx) {
+            if (!jobCtx) continue;
+            librustzcash_sapling_proving_ctx_merge(ctx, jobCtx);
+            librustzcash_sapling_proving_ctx_free(jobCtx);
+        }
 
-            CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-            ss << spend.witness.path();
-            std::vector<unsigned char> witness(ss.begin(), ss.end());
-
-            SpendDescription sdesc;
-            if (!librustzcash_sapling_spend_proof(
-                    ctx,
-                    spend.expsk.full_viewing_key().ak.begin(),
-                    spend.expsk.nsk.begin(),
-                    spend.note.d.data(),
-                    spend.note.r.begin(),
-                    spend.alpha.begin(),
-                    spend.note.value(),
-                    spend.anchor.begin(),
-                    witness.data(),
-                    sdesc.cv.begin(),
-                    sdesc.rk.begin(),
-                    sdesc.zkproof.data())) {
+        // Report the error of the first failed description
+        for (const std::string& strError : vErrors) {
+            if (!strError.empty()) {
                 librustzcash_sapling_proving_ctx_free(ctx);
-                return TransactionBuilderResult("Spend proof failed");
+                return TransactionBuilderResult(strError);
             }
+        }
+        if (pfCancel && *pfCancel) {
+            librustzcash_sapling_proving_ctx_free(ctx);
+            return TransactionBuilderResult("Proof generation cancelled");
+        }
 
-            sdesc.anchor = spend.anchor;
-            sdesc.nullifier = *nf;
+        const int64_t nTimeSign = GetTimeMicros();
+        for (const OutputDescription& odesc : vOutputs) {
+            mtx.sapData->vShieldedOutput.push_back(odesc);
+        }
+        for (const SpendDescription& sdesc : vSpends) {
             mtx.sapData->vShieldedSpend.push_back(sdesc);
         }
 
@@ -324,6 +405,7 @@ TransactionBuilderResult TransactionBuilder::ProveAndSign()
                 mtx.sapData->bindingSig.data());
 
         librustzcash_sapling_proving_ctx_free(ctx);
+        provingStats.nSignMicros = GetTimeMicros() - nTimeSign;
     }
 
     // Transparent signatures
@@ -19,6 +19,8 @@
 #include "sapling/note.h"
 #include "sapling/noteencryption.h"
 
+#include <atomic>
+
 struct SpendDescriptionInfo {
     libzcash::SaplingExpandedSpendingKey expsk;
     libzcash::SaplingNote note;
@@ -82,6 +84,20 @@ public:
 
 class TransactionBuilder
 {
+public:
+    // Proof generation of the last ProveAndSign call
+    struct ProvingStats {
+        int nThreads{0};
+        size_t nSpends{0};
+        size_t nOutputs{0};
+        // Time spent in the spend/output proofs, summed over the threads
+        int64_t nSpendMicros{0};
+        int64_t nOutputMicros{0};
+        // Wall-clock time of the proofs and of the signatures
+        int64_t nProveMicros{0};
+        int64_t nSignMicros{0};
+    };
+
 private:
     Consensus::Params consensusParams;
     const CKeyStore* keystore;
@@ -95,6 +111,15 @@ private:
     Optional<std::pair<uint256, libzcash::SaplingPaymentAddress>> saplingChangeAddr;
     Optional<CTxDestination> tChangeAddr;
 
+    // Checked before each proof. Once set, ProveAndSign fails.
+    const std::atomic<bool>* pfCancel{nullptr};
+    ProvingStats provingStats;
+
+    // Create the description of the output/spend at index nPos,
+    // accumulating its value commitment in the proving context ctx
+    bool ProveOutput(size_t nPos, void* ctx, OutputDescription& odesc, std::string& strError);
+    bool ProveSpend(size_t nPos, void* ctx, SpendDescription& sdesc, std::string& strError);
+
 public:
     TransactionBuilder(
         const Consensus::Params& consensusParams,
@@ -138,12 +163,17 @@ public:
     void SendChangeTo(const CTxDestination& changeAddr);
 
     TransactionBuilderResult Build(bool fDummySig = false);
-    // Add Sapling Spend/Output descriptions, binding sig, and transparent signatures
-    TransactionBuilderResult ProveAndSign();
+    // Add Sapling Spend/Output descriptions, binding sig, and transparent signatures.
+    // The proofs of the descriptions are created concurrently, with up to nThreads threads
+    // (0 = number of cores).
+    TransactionBuilderResult ProveAndSign(int nThreads = 0);
     // Add dummy Sapling Spend/Output descriptions, binding sig, and transparent signatures
     TransactionBuilderResult AddDummySignatures();
     // Remove Sapling Spend/Output descriptions, binding sig, and transparent signatures
     void ClearProofsAndSignatures();
+
+    void SetCancelFlag(const std::atomic<bool>* _pfCancel) { pfCancel = _pfCancel; }
+    const ProvingStats& GetProvingStats() const { return provingStats; }
 };
 
 #endif /* TRANSACTION_BUILDER_H */
@@ -0,0 +1,119 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "sapling/trialdecryption.h"
+
+#include "ctpl_stl.h"
+#include "util/system.h"
+#include "util/threadnames.h"
+#include "utiltime.h"
+
+#include <future>
+
+SaplingTrialDecryptor::SaplingTrialDecryptor() = default;
+
+SaplingTrialDecryptor::~SaplingTrialDecryptor()
+{
+    StopWorkers();
+}
+
+void SaplingTrialDecryptor::StartWorkers(int nThreads)
+{
+    // each loaded wallet has its own workers: don't go over the number of cores
+    if (nThreads <= 0 || nThreads > GetNumCores()) nThreads = GetNumCores();
+    StopWorkers();
+    // the calling thread takes its share of the trials too
+    if (nThreads <= 1) return;
+
+    workerPool = std::make_unique<ctpl::thread_pool>(nThreads - 1);
+    RenameThreadPool(*workerPool, "Hemis-zdecrypt");
+    LogPrintf("Using %d threads for the Sapling trial decryption\n", nThreads);
+}
+
+void SaplingTrialDecryptor::StopWorkers()
+{
+    if (workerPool) {
+        workerPool->stop(true);
+        workerPool.reset();
+    }
+}
+
+std::vector<SaplingTrialDecryptor::Match> SaplingTrialDecryptor::Decrypt(const std::vector<OutputDescription>& vOutputs,
+                                                                         const std::vector<libzcash::SaplingIncomingViewingKey>& vIvks) const
+{
+    const int64_t nTimeStart = GetTimeMicros();
+    const size_t nKeys = vIvks.size();
+    const size_t nTotalTrials = vOutputs.size() * nKeys;
+
+    // Set as soon as a key decrypts the output: its remaining trials are skipped
+    std::unique_ptr<std::atomic<bool>[]> vFound(new std::atomic<bool>[vOutputs.size()]);
+    for (size_t i = 0; i < vOutputs.size(); i++) vFound[i] = false;
+    std::atomic<uint64_t> nDone{0};
+
+    // Trials [nBegin, nEnd), in output-major order
+    auto worker = [&](size_t nBegin, size_t nEnd) {
+        std::vector<Match> vMatches;
+        uint64_t nRun = 0;
+        for (size_t n = nBegin; n < nEnd; n++) {
+            const size_t nOut = n / nKeys;
+            if (vFound[nOut]) {
+                // jump to the first trial of the next output
+                n = (nOut + 1) * nKeys - 1;
+                continue;
+            }
+            const OutputDescription& output = vOutputs[nOut];
+            const libzcash::SaplingIncomingViewingKey& ivk = vIvks[n % nKeys];
+            nRun++;
+            auto result = libzcash::SaplingNotePlaintext::decrypt(output.encCiphertext, ivk, output.ephemeralKey, output.cmu);
+            if (result) {
+                vFound[nOut] = true;
+                vMatches.push_back({(uint32_t) nOut, ivk, *result});
+            }
+        }
+        nDone += nRun;
+        return vMatches;
+    };
+
+    std::vector<Match> vRet;
+    if (!workerPool || nTotalTrials < MIN_PARALLEL_TRIALS) {
+        vRet = worker(0, nTotalTrials);
+    } else {
+        const size_t nTasks = std::min((size_t) workerPool->size() + 1, nTotalTrials);
+        const size_t nTaskSize = (nTotalTrials + nTasks - 1) / nTasks;
+        std::vector<std::future<std::vector<Match>>> futures;
+        for (size_t nBegin = nTaskSize; nBegin < nTotalTrials; nBegin += nTaskSize) {
+            const size_t nEnd = std::min(nBegin + nTaskSize, nTotalTrials);
+            futures.emplace_back(workerPool->push([&worker, nBegin, nEnd](int) { return worker(nBegin, nEnd); }));
+        }
+        vRet = worker(0, std::min(nTaskSize, nTotalTrials));
+        for (auto& f : futures) {
+            for (Match& m : f.get()) {
+                vRet.emplace_back(std::move(m));
+            }
+        }
+        std::stable_sort(vRet.begin(), vRet.end(), [](const Match& a, const Match& b) { return a.nOutput < b.nOutput; });
+        // two workers could have decrypted the same output with different keys: keep the first
+        vRet.erase(std::unique(vRet.begin(), vRet.end(), [](const Match& a, const Match& b) { return a.nOutput == b.nOutput; }),
+                   vRet.end());
+    }
+
+    nTxs++;
+    nOutputs += vOutputs.size();
+    nTrials += nDone;
+    nNotes += vRet.size();
+    nMicros += GetTimeMicros() - nTimeStart;
+    return vRet;
+}
+
+SaplingTrialDecryptor::Stats SaplingTrialDecryptor::GetStats() const
+{
+    Stats stats;
+    stats.nThreads = workerPool ? workerPool->size() + 1 : 1;
+    stats.nTxs = nTxs;
+    stats.nOutputs = nOutputs;
+    stats.nTrials = nTrials;
+    stats.nNotes = nNotes;
+    stats.nMicros = nMicros;
+    return stats;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#ifndef Hemis_SAPLING_TRIALDECRYPTION_H
+#define Hemis_SAPLING_TRIALDECRYPTION_H
+
+#include "primitives/transaction.h"
+#include "sapling/address.h"
+#include "sapling/note.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace ctpl {
+    class thread_pool;
+}
+
+/**
+ * Trial decryption of shielded outputs with a set of incoming viewing keys.
+ * The (output x ivk) trials are split in contiguous ranges over a pool of worker threads
+ * (plus the calling thread). Each output keeps the state shared by its trials (the
+ * ephemeral key, the ciphertext and whether a key already decrypted it), so the
+ * remaining trials of an output are skipped as soon as one of the workers finds its key.
+ */
+class SaplingTrialDecryptor
+{
+public:
+    /** An output decrypted by one of the keys */
+    struct Match {
+        uint32_t nOutput;
+        libzcash::SaplingIncomingViewingKey ivk;
+        libzcash::SaplingNotePlaintext plaintext;
+    };
+
+    /** Throughput counters, since startup */
+    struct Stats {
+        int nThreads{1};
+        uint64_t nTxs{0};
+        uint64_t nOutputs{0};
+        uint64_t nTrials{0};
+        uint64_t nNotes{0};
+        int64_t nMicros{0};
+    };
+
+    SaplingTrialDecryptor();
+    ~SaplingTrialDecryptor();
+
+    /** Split the trials over nThreads threads (<= 0 = all cores, capped at the cores). With one thread, everything runs serially */
+    void StartWorkers(int nThreads);
+    void StopWorkers();
+
+    /** Try each key on each output. Returns the decrypted outputs, sorted by output index */
+    std::vector<Match> Decrypt(const std::vector<OutputDescription>& vOutputs,
+                               const std::vector<libzcash::SaplingIncomingViewingKey>& vIvks) const;
+
+    Stats GetStats() const;
+
+private:
+    // Below this number of trials, splitting the work costs more than it saves
+    static const size_t MIN_PARALLEL_TRIALS = 32;
+
+    std::unique_ptr<ctpl::thread_pool> workerPool;
+
+    mutable std::atomic<uint64_t> nTxs{0};
+    mutable std::atomic<uint64_t> nOutputs{0};
+    mutable std::atomic<uint64_t> nTrials{0};
+    mutable std::atomic<uint64_t> nNotes{0};
+    mutable std::atomic<int64_t> nMicros{0};
+};
+
+#endif // Hemis_SAPLING_TRIALDECRYPTION_H
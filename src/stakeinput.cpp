@@ -5,6 +5,7 @@
 #include "stakeinput.h"
 
 #include "chain.h"
+#include "stakeorigins.h"
 #include "txdb.h"
 #include "validation.h"
 
@@ -26,31 +27,14 @@ CPivStake* CPivStake::NewPivStake(const CTxIn& txin, int nHeight, uint32_t nTime
         return nullptr;
     }
 
-    // Look for the stake input in the coins cache first
-    const Coin& coin = pcoinsTip->AccessCoin(txin.prevout);
-    if (!coin.IsSpent()) {
-        const CBlockIndex* pindexFrom = mapBlockIndex.at(chainActive[coin.nHeight]->GetBlockHash());
-        // Check that the stake has the required depth/age
-        if (!HasStakeMinAgeOrDepth(nHeight, nTime, pindexFrom)) {
-            return nullptr;
-        }
-        // All good
-        return new CPivStake(coin.out, txin.prevout, pindexFrom);
-    }
-
-    // Otherwise find the previous transaction in database
-    uint256 hashBlock;
-    CTransactionRef txPrev;
-    if (!GetTransaction(txin.prevout.hash, txPrev, hashBlock, true)) {
-        error("%s : INFO: read txPrev failed, tx id prev: %s", __func__, txin.prevout.hash.GetHex());
+    // Look for the stake input in the coins cache first.
+    // Otherwise, it was spent on the active chain (by one of the last blocks, if the stake is on a valid fork).
+    Coin coin = pcoinsTip->AccessCoin(txin.prevout);
+    if (coin.IsSpent() && !g_stake_origins.GetSpentCoin(txin.prevout, coin)) {
+        error("%s : Failed to find the stake origin %s", __func__, txin.prevout.ToString());
         return nullptr;
     }
-    const CBlockIndex* pindexFrom = nullptr;
-    if (mapBlockIndex.count(hashBlock)) {
-        CBlockIndex* pindex = mapBlockIndex.at(hashBlock);
-        if (chainActive.Contains(pindex)) pindexFrom = pindex;
-    }
-    // Check that the input is in the active chain
+    const CBlockIndex* pindexFrom = chainActive[coin.nHeight];
     if (!pindexFrom) {
         error("%s : Failed to find the block index for stake origin", __func__);
         return nullptr;
@@ -60,7 +44,7 @@ CPivStake* CPivStake::NewPivStake(const CTxIn& txin, int nHeight, uint32_t nTime
         return nullptr;
     }
     // All good
-    return new CPivStake(txPrev->vout[txin.prevout.n], txin.prevout, pindexFrom);
+    return new CPivStake(coin.out, txin.prevout, pindexFrom);
 }
 
 bool CPivStake::GetTxOutFrom(CTxOut& out) const
@@ -0,0 +1,112 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "stakeorigins.h"
+
+#include "chain.h"
+#include "consensus/consensus.h"
+#include "undo.h"
+#include "util/system.h"
+#include "validation.h"
+
+CStakeOrigins g_stake_origins;
+
+int CStakeOrigins::GetWindowSize()
+{
+    return 2 * (int) gArgs.GetArg("-maxreorg", DEFAULT_MAX_REORG_DEPTH);
+}
+
+void CStakeOrigins::EraseSpentAt(int nHeight)
+{
+    auto it = mapSpentByHeight.find(nHeight);
+    if (it == mapSpentByHeight.end()) return;
+    for (const COutPoint& outpoint : it->second) {
+        mapSpentCoins.erase(outpoint);
+    }
+    mapSpentByHeight.erase(it);
+}
+
+void CStakeOrigins::BlockConnected(const CBlock& block, const CBlockUndo& blockundo, int nHeight)
+{
+    AssertLockHeld(cs_main);
+    // A block at the same height could be left from a failed reorg
+    EraseSpentAt(nHeight);
+
+    std::vector<COutPoint>& vSpent = mapSpentByHeight[nHeight];
+    for (size_t i = 1; i < block.vtx.size(); i++) {
+        const CTransaction& tx = *block.vtx[i];
+        const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+        // no undo data for the inputs of zerocoin spends
+        if (txundo.vprevout.size() != tx.vin.size()) continue;
+        for (size_t j = 0; j < tx.vin.size(); j++) {
+            const COutPoint& outpoint = tx.vin[j].prevout;
+            mapSpentCoins[outpoint] = std::make_pair(txundo.vprevout[j], nHeight);
+            vSpent.emplace_back(outpoint);
+        }
+    }
+
+    // Remove the blocks out of the window
+    const int nMinHeight = nHeight - GetWindowSize();
+    while (!mapSpentByHeight.empty() && mapSpentByHeight.begin()->first <= nMinHeight) {
+        EraseSpentAt(mapSpentByHeight.begin()->first);
+    }
+}
+
+void CStakeOrigins::BlockDisconnected(int nHeight)
+{
+    AssertLockHeld(cs_main);
+    // Remove the coins spent at nHeight and above
+    while (!mapSpentByHeight.empty() && mapSpentByHeight.rbegin()->first >= nHeight) {
+        EraseSpentAt(mapSpentByHeight.rbegin()->first);
+    }
+}
+
+bool CStakeOrigins::Load(const CBlockIndex* pindexTip)
+{
+    AssertLockHeld(cs_main);
+    Clear();
+    const int64_t nStart = GetTimeMillis();
+    const int nWindowSize = GetWindowSize();
+    std::vector<const CBlockIndex*> vIndexes;
+    for (const CBlockIndex* pindex = pindexTip; pindex && pindex->pprev && (int) vIndexes.size() < nWindowSize; pindex = pindex->pprev) {
+        vIndexes.emplace_back(pindex);
+    }
+    for (auto it = vIndexes.rbegin(); it != vIndexes.rend(); ++it) {
+        const CBlockIndex* pindex = *it;
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex)) {
+            return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+        CBlockUndo blockundo;
+        const FlatFilePos pos = pindex->GetUndoPos();
+        if (pos.IsNull() || !UndoReadFromDisk(blockundo, pos, pindex->pprev->GetBlockHash())) {
+            return error("%s: failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+        if (blockundo.vtxundo.size() + 1 != block.vtx.size()) {
+            return error("%s: block and undo data inconsistent for block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+        BlockConnected(block, blockundo, pindex->nHeight);
+    }
+    LogPrintf("%s: %d spent coins loaded from the last %d blocks in %dms\n",
+              __func__, mapSpentCoins.size(), vIndexes.size(), GetTimeMillis() - nStart);
+    return true;
+}
+
+void CStakeOrigins::Clear()
+{
+    AssertLockHeld(cs_main);
+    mapSpentCoins.clear();
+    mapSpentByHeight.clear();
+}
+
+bool CStakeOrigins::GetSpentCoin(const COutPoint& outpoint, Coin& coinRet) const
+{
+    AssertLockHeld(cs_main);
+    auto it = mapSpentCoins.find(outpoint);
+    if (it == mapSpentCoins.end()) {
+        return false;
+    }
+    coinRet = it->second.first;
+    return true;
+}
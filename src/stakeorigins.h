@@ -0,0 +1,61 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef Hemis_STAKEORIGINS_H
+#define Hemis_STAKEORIGINS_H
+
+#include "coins.h"
+#include "primitives/transaction.h"
+#include "sync.h"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+class CBlockUndo;
+
+extern RecursiveMutex cs_main;
+
+/**
+ * Index of the coins spent by the most recent blocks of the active chain (outpoint --> coin,
+ * with its height, value and script), filled from the block undo data.
+ *
+ * The stake input of a block on a fork can be already spent on the active chain, so it's not
+ * in the coins cache anymore. Its origin is looked up here, instead of reading the whole
+ * previous transaction from disk (which required -txindex).
+ * A valid fork can't go back more than -maxreorg blocks, and neither can the stake input spend
+ * on the active chain, so the coins spent in the last 2 * maxreorg blocks are enough.
+ * The index is not written to disk: it is rebuilt at startup from the undo data of those blocks.
+ */
+class CStakeOrigins
+{
+private:
+    // spent coin, and height of the block that spent it
+    std::unordered_map<COutPoint, std::pair<Coin, int>, SaltedOutpointHasher> mapSpentCoins GUARDED_BY(cs_main);
+    // height --> outpoints spent by the block at that height
+    std::map<int, std::vector<COutPoint>> mapSpentByHeight GUARDED_BY(cs_main);
+
+    // Number of recent blocks indexed
+    static int GetWindowSize();
+    void EraseSpentAt(int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+public:
+    // Add the coins spent by the block at nHeight (and remove the ones out of the window)
+    void BlockConnected(const CBlock& block, const CBlockUndo& blockundo, int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    // Remove the coins spent by the block at nHeight (they are back in the coins cache)
+    void BlockDisconnected(int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    // Rebuild the index from the undo data of the last blocks up to pindexTip
+    bool Load(const CBlockIndex* pindexTip) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    void Clear() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    // Coin spent by one of the last blocks of the active chain
+    bool GetSpentCoin(const COutPoint& outpoint, Coin& coinRet) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return mapSpentCoins.size(); }
+};
+
+extern CStakeOrigins g_stake_origins;
+
+#endif // Hemis_STAKEORIGINS_H
@@ -0,0 +1,117 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "test/test_Hemis.h"
+
+#include "consensus/validation.h"
+#include "index/addressindex.h"
+#include "script/sign.h"
+#include "script/standard.h"
+#include "utiltime.h"
+#include "validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+static void WaitForSync(AddressIndex& index)
+{
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(addressindex_connect_disconnect, TestChain100Setup)
+{
+    AddressIndex addressindex(1 << 20, true);
+    addressindex.Start();
+    WaitForSync(addressindex);
+
+    // All the coinbase outputs of the chain are unspent, and credit the coinbase script
+    const CScript coinbaseScript = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    const uint160 coinbaseHash = GetScriptIndexHash(coinbaseScript);
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspent;
+    BOOST_CHECK(addressindex.GetAddressUnspent(coinbaseHash, unspent));
+    BOOST_CHECK_EQUAL(unspent.size(), coinbaseTxns.size());
+    CAmount nUnspent = 0;
+    for (const auto& entry : unspent) nUnspent += entry.second.nValue;
+    CAmount nBalance, nReceived;
+    BOOST_CHECK(addressindex.GetAddressBalance(coinbaseHash, nBalance, nReceived));
+    BOOST_CHECK_EQUAL(nBalance, nUnspent);
+    BOOST_CHECK_EQUAL(nReceived, nUnspent);
+
+    // Spend the first coinbase to a new key
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript destScript = GetScriptForDestination(key.GetPubKey().GetID());
+    const uint160 destHash = GetScriptIndexHash(destScript);
+    const COutPoint prevout(coinbaseTxns[0].GetHash(), 0);
+    const CAmount nCoinbaseValue = coinbaseTxns[0].vout[0].nValue;
+    CMutableTransaction spend;
+    spend.vin.emplace_back(prevout);
+    spend.vout.emplace_back(nCoinbaseValue - 10000, destScript);
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(coinbaseScript, spend, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+
+    const CBlock block = CreateAndProcessBlock({spend}, coinbaseScript);
+    BOOST_CHECK(WITH_LOCK(cs_main, return chainActive.Tip()->GetBlockHash()) == block.GetHash());
+    const int nSpendHeight = WITH_LOCK(cs_main, return chainActive.Height());
+    WaitForSync(addressindex);
+
+    CSpentIndexValue spent;
+    BOOST_CHECK(addressindex.GetSpentInfo(prevout, spent));
+    BOOST_CHECK(spent.txid == spend.GetHash());
+    BOOST_CHECK_EQUAL(spent.nInputIndex, 0);
+    BOOST_CHECK_EQUAL(spent.nHeight, nSpendHeight);
+    BOOST_CHECK_EQUAL(spent.nValue, nCoinbaseValue);
+
+    unspent.clear();
+    BOOST_CHECK(addressindex.GetAddressUnspent(destHash, unspent));
+    BOOST_CHECK_EQUAL(unspent.size(), 1);
+    BOOST_CHECK(unspent[0].first.outpoint == COutPoint(spend.GetHash(), 0));
+    BOOST_CHECK_EQUAL(unspent[0].second.nHeight, nSpendHeight);
+
+    // The coinbase script lost the spent coinbase, and got the one of the new block
+    const CAmount nNewCoinbaseValue = block.vtx[0]->vout[0].nValue;
+    BOOST_CHECK(addressindex.GetAddressBalance(coinbaseHash, nBalance, nReceived));
+    BOOST_CHECK_EQUAL(nBalance, nUnspent - nCoinbaseValue + nNewCoinbaseValue);
+    BOOST_CHECK_EQUAL(nReceived, nUnspent + nNewCoinbaseValue);
+
+    std::vector<std::pair<CAddressIndexKey, CAmount>> entries;
+    BOOST_CHECK(addressindex.GetAddressIndex(coinbaseHash, entries, nSpendHeight, nSpendHeight));
+    BOOST_CHECK_EQUAL(entries.size(), 2); // the debit of the spend, and the new coinbase
+
+    // Replace the block with one without the spend: the index is rewound
+    {
+        LOCK(cs_main);
+        CValidationState state;
+        BOOST_CHECK(InvalidateBlock(state, Params(), chainActive.Tip()));
+    }
+    mempool.clear();
+    SetMockTime(GetTime() + 60); // to generate a different block hash
+    CreateAndProcessBlock({}, coinbaseScript);
+    SetMockTime(0);
+    WaitForSync(addressindex);
+
+    BOOST_CHECK(!addressindex.GetSpentInfo(prevout, spent));
+    unspent.clear();
+    BOOST_CHECK(addressindex.GetAddressUnspent(destHash, unspent));
+    BOOST_CHECK(unspent.empty());
+    entries.clear();
+    BOOST_CHECK(addressindex.GetAddressIndex(destHash, entries));
+    BOOST_CHECK(entries.empty());
+    unspent.clear();
+    BOOST_CHECK(addressindex.GetAddressUnspent(coinbaseHash, unspent));
+    BOOST_CHECK_EQUAL(unspent.size(), coinbaseTxns.size() + 1);
+
+    addressindex.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "test/test_Hemis.h"
+
+#include "clientversion.h"
+#include "consensus/validation.h"
+#include "index/blockstatsindex.h"
+#include "script/sign.h"
+#include "script/standard.h"
+#include "utiltime.h"
+#include "validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(blockstatsindex_tests)
+
+static void WaitForSync(BlockStatsIndex& index)
+{
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+}
+
+static CMutableTransaction SpendCoinbase(const CTransaction& coinbase, const CKey& key, const CScript& script, CAmount nFee)
+{
+    CMutableTransaction spend;
+    spend.vin.emplace_back(COutPoint(coinbase.GetHash(), 0));
+    spend.vout.emplace_back(coinbase.vout[0].nValue - nFee, script);
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(script, spend, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(key.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+    return spend;
+}
+
+BOOST_FIXTURE_TEST_CASE(blockstatsindex_fees, TestChain100Setup)
+{
+    BlockStatsIndex statsindex(1 << 20, true);
+    statsindex.Start();
+    WaitForSync(statsindex);
+
+    // The blocks of the chain have only the coinbase
+    const CBlockIndex* tip = WITH_LOCK(cs_main, return chainActive.Tip());
+    CBlockIndexStats stats;
+    BOOST_CHECK(statsindex.LookupStatsRange(1, tip, stats));
+    BOOST_CHECK_EQUAL(stats.nTxCountAll, tip->nHeight);
+    BOOST_CHECK_EQUAL(stats.nTxCount, 0);
+    BOOST_CHECK_EQUAL(stats.nFees, 0);
+
+    // A block with two transactions, each paying a fee (after one more block, for the
+    // second coinbase to be mature)
+    const CScript coinbaseScript = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CreateAndProcessBlock({}, coinbaseScript);
+    const CMutableTransaction spend1 = SpendCoinbase(coinbaseTxns[0], coinbaseKey, coinbaseScript, 10000);
+    const CMutableTransaction spend2 = SpendCoinbase(coinbaseTxns[1], coinbaseKey, coinbaseScript, 25000);
+    const CBlock block = CreateAndProcessBlock({spend1, spend2}, coinbaseScript);
+    WaitForSync(statsindex);
+
+    tip = WITH_LOCK(cs_main, return chainActive.Tip());
+    BOOST_CHECK(tip->GetBlockHash() == block.GetHash());
+    BOOST_CHECK(statsindex.LookupStats(tip, stats));
+    BOOST_CHECK_EQUAL(stats.nTxCountAll, 3);
+    BOOST_CHECK_EQUAL(stats.nTxCount, 2);
+    BOOST_CHECK_EQUAL(stats.nFees, 35000);
+    BOOST_CHECK_EQUAL(stats.nTxBytes, (int64_t) (GetSerializeSize(CTransaction(spend1), CLIENT_VERSION) +
+                                                 GetSerializeSize(CTransaction(spend2), CLIENT_VERSION)));
+
+    // The index gives the same totals as the blocks and undo data on disk
+    CBlockIndexStats fromDisk, total;
+    for (const CBlockIndex* pindex = tip; pindex->nHeight >= 1; pindex = pindex->pprev) {
+        CBlockIndexStats blockStats;
+        BOOST_CHECK(ReadBlockIndexStats(pindex, blockStats));
+        fromDisk += blockStats;
+    }
+    BOOST_CHECK(statsindex.LookupStatsRange(1, tip, total));
+    BOOST_CHECK_EQUAL(total.nTxCountAll, fromDisk.nTxCountAll);
+    BOOST_CHECK_EQUAL(total.nTxCount, fromDisk.nTxCount);
+    BOOST_CHECK_EQUAL(total.nTxBytes, fromDisk.nTxBytes);
+    BOOST_CHECK_EQUAL(total.nFees, fromDisk.nFees);
+    BOOST_CHECK_EQUAL(total.nFees, 35000);
+
+    // Replace the block with an empty one: the stats of the old one are not returned anymore
+    const CBlockIndex* stale = tip;
+    {
+        LOCK(cs_main);
+        CValidationState state;
+        BOOST_CHECK(InvalidateBlock(state, Params(), chainActive.Tip()));
+    }
+    mempool.clear();
+    SetMockTime(GetTime() + 60); // to generate a different block hash
+    CreateAndProcessBlock({}, coinbaseScript);
+    SetMockTime(0);
+    WaitForSync(statsindex);
+
+    tip = WITH_LOCK(cs_main, return chainActive.Tip());
+    BOOST_CHECK(!statsindex.LookupStats(stale, stats));
+    BOOST_CHECK(!statsindex.LookupStatsRange(1, stale, stats));
+    BOOST_CHECK(statsindex.LookupStatsRange(1, tip, total));
+    BOOST_CHECK_EQUAL(total.nFees, 0);
+
+    statsindex.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
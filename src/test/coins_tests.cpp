@@ -11,6 +11,7 @@
 #include "undo.h"
 #include "utilstrencodings.h"
 #include "random.h"
+#include "txdb.h"
 
 #include "sapling/incrementalmerkletree.h"
 
@@ -478,6 +479,65 @@ BOOST_AUTO_TEST_CASE(anchor_regression_test)
     anchorRegressionTestImpl<SaplingMerkleTree>();
 }
 
+namespace {
+class CCoinsViewCountAnchors : public CCoinsViewBacked
+{
+public:
+    mutable int nAnchorReads{0};
+    explicit CCoinsViewCountAnchors(CCoinsView* viewIn) : CCoinsViewBacked(viewIn) {}
+    bool GetSaplingAnchorAt(const uint256& rt, SaplingMerkleTree& tree) const override
+    {
+        nAnchorReads++;
+        return CCoinsViewBacked::GetSaplingAnchorAt(rt, tree);
+    }
+};
+}
+
+BOOST_AUTO_TEST_CASE(recent_sapling_trees_test)
+{
+    CCoinsViewTest base;
+    CCoinsViewCountAnchors counter(&base);
+    CCoinsViewCache cache1(&counter);
+
+    std::vector<SaplingMerkleTree> vTrees;
+    SaplingMerkleTree tree;
+    for (int i = 0; i < 12; i++) {
+        tree.append(GetRandHash());
+        vTrees.emplace_back(tree);
+        cache1.PushAnchor(tree);
+        cache1.Flush();
+    }
+
+    // The best tree is kept after the flush, and shared with the views on top
+    SaplingMerkleTree checkTree;
+    BOOST_CHECK(cache1.GetSaplingAnchorAt(tree.root(), checkTree));
+    BOOST_CHECK(checkTree.root() == tree.root());
+    {
+        CCoinsViewCache cache2(&cache1);
+        BOOST_CHECK(cache2.GetSaplingAnchorAt(tree.root(), checkTree));
+    }
+    BOOST_CHECK_EQUAL(counter.nAnchorReads, 0);
+
+    // An old tree is read once from the base
+    BOOST_CHECK(cache1.GetSaplingAnchorAt(vTrees[0].root(), checkTree));
+    BOOST_CHECK(cache1.GetSaplingAnchorAt(vTrees[0].root(), checkTree));
+    BOOST_CHECK(checkTree.root() == vTrees[0].root());
+    BOOST_CHECK_EQUAL(counter.nAnchorReads, 1);
+
+    // Popped by a view on top: not found anymore, even after the flush
+    {
+        CCoinsViewCache cache2(&cache1);
+        cache2.PopAnchor(vTrees[10].root());
+        cache2.Flush();
+    }
+    BOOST_CHECK(cache1.GetBestAnchor() == vTrees[10].root());
+    BOOST_CHECK(!cache1.GetSaplingAnchorAt(tree.root(), checkTree));
+    cache1.Flush();
+    BOOST_CHECK(!cache1.GetSaplingAnchorAt(tree.root(), checkTree));
+    BOOST_CHECK(cache1.GetSaplingAnchorAt(vTrees[10].root(), checkTree));
+    BOOST_CHECK(checkTree.root() == vTrees[10].root());
+}
+
 BOOST_AUTO_TEST_CASE(nullifiers_test)
 {
     CCoinsViewTest base;
@@ -1320,4 +1380,75 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+
+BOOST_AUTO_TEST_CASE(ccoins_add_fetched)
+{
+    CCoinsView base;
+    CCoinsViewCacheTest cache(&base);
+    const COutPoint outpoint(InsecureRand256(), 0);
+    Coin coin;
+    coin.out.nValue = 1;
+    // Stored out of the Coin
+    coin.out.scriptPubKey.resize(100);
+    const size_t nUsage = coin.DynamicMemoryUsage();
+
+    BOOST_CHECK(!cache.AddFetchedCoin(COutPoint(InsecureRand256(), 0), Coin()));
+    BOOST_CHECK(cache.AddFetchedCoin(outpoint, Coin(coin)));
+    BOOST_CHECK(!cache.AddFetchedCoin(outpoint, Coin(coin)));
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 1);
+    cache.SelfTest();
+    BOOST_CHECK_EQUAL(cache.usage(), nUsage);
+    BOOST_CHECK(cache.HaveCoinInCache(outpoint));
+    BOOST_CHECK_EQUAL(cache.AccessCoin(outpoint).out.nValue, 1);
+
+    // Not dirty: nothing to write to the base view
+    CCoinsMap& map = cache.map();
+    BOOST_CHECK_EQUAL(map.find(outpoint)->second.flags, 0);
+}
+
+BOOST_AUTO_TEST_CASE(coinsdb_background_flush)
+{
+    CCoinsViewDB db(1 << 20, true, true);
+    db.StartBackgroundFlush();
+    BOOST_CHECK(db.GetFlushStats().fBackground);
+
+    std::vector<COutPoint> vOutPoints;
+    for (int nFlush = 0; nFlush < 10; nFlush++) {
+        CCoinsViewCache cache(&db);
+        // Spend the coins of the previous flush, while it may still be written
+        for (const COutPoint& outpoint : vOutPoints) {
+            BOOST_CHECK(cache.HaveCoin(outpoint));
+            cache.SpendCoin(outpoint);
+        }
+        vOutPoints.clear();
+        for (int i = 0; i < 100; i++) {
+            Coin coin;
+            coin.out.nValue = InsecureRand32();
+            coin.nHeight = nFlush;
+            vOutPoints.emplace_back(InsecureRand256(), 0);
+            cache.AddCoin(vOutPoints.back(), std::move(coin), false);
+        }
+        const uint256 hashBlock = InsecureRand256();
+        cache.SetBestBlock(hashBlock);
+        BOOST_CHECK(cache.Flush());
+        BOOST_CHECK(db.GetBestBlock() == hashBlock);
+    }
+    BOOST_CHECK(db.WaitForFlush());
+
+    const CCoinsViewDB::FlushStats stats = db.GetFlushStats();
+    BOOST_CHECK_EQUAL(stats.nFlushes, 10);
+    BOOST_CHECK(!stats.fInProgress);
+    BOOST_CHECK(!stats.fFailed);
+    for (const COutPoint& outpoint : vOutPoints) {
+        Coin coin;
+        BOOST_CHECK(db.GetCoin(outpoint, coin));
+        BOOST_CHECK_EQUAL(coin.nHeight, 9);
+    }
+    // Only the coins of the last flush are left
+    size_t nCoins = 0;
+    std::unique_ptr<CCoinsViewCursor> pcursor(db.Cursor());
+    for (; pcursor->Valid(); pcursor->Next()) nCoins++;
+    BOOST_CHECK_EQUAL(nCoins, vOutPoints.size());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
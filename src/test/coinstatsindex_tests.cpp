@@ -0,0 +1,106 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "test/test_Hemis.h"
+
+#include "consensus/validation.h"
+#include "index/coinstatsindex.h"
+#include "script/sign.h"
+#include "utiltime.h"
+#include "validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(coinstatsindex_tests)
+
+static void WaitForSync(CoinStatsIndex& index)
+{
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+}
+
+//! Check the statistics of the index at the tip against a full walk of the coins database
+static void CheckTipStats(const CoinStatsIndex& index)
+{
+    FlushStateToDisk();
+    MuHash3072 muhash;
+    uint64_t nOutputs = 0;
+    CAmount nTotal = 0;
+    std::unique_ptr<CCoinsViewCursor> pcursor(pcoinsTip->Cursor());
+    for (; pcursor->Valid(); pcursor->Next()) {
+        COutPoint key;
+        Coin coin;
+        BOOST_REQUIRE(pcursor->GetKey(key) && pcursor->GetValue(coin));
+        ApplyCoinHash(muhash, key, coin);
+        nOutputs++;
+        nTotal += coin.out.nValue;
+    }
+    uint256 hashMuHash;
+    muhash.Finalize(hashMuHash);
+
+    const CBlockIndex* pindexTip = WITH_LOCK(cs_main, return chainActive.Tip());
+    CUTXOSetStats stats;
+    BOOST_REQUIRE(index.LookupStats(pindexTip, stats));
+    BOOST_CHECK(stats.hashBlock == pindexTip->GetBlockHash());
+    BOOST_CHECK(stats.hashMuHash == hashMuHash);
+    BOOST_CHECK_EQUAL(stats.nTransactionOutputs, nOutputs);
+    BOOST_CHECK_EQUAL(stats.nTotalAmount, nTotal);
+}
+
+BOOST_FIXTURE_TEST_CASE(coinstatsindex_connect_disconnect, TestChain100Setup)
+{
+    CoinStatsIndex coinstatsindex(1 << 20, true);
+
+    // The index has no statistics before it is started
+    CUTXOSetStats stats;
+    const CBlockIndex* pindexTip = WITH_LOCK(cs_main, return chainActive.Tip());
+    BOOST_CHECK(!coinstatsindex.LookupStats(pindexTip, stats));
+
+    coinstatsindex.Start();
+    WaitForSync(coinstatsindex);
+    CheckTipStats(coinstatsindex);
+    BOOST_CHECK(coinstatsindex.LookupStats(pindexTip, stats));
+    const uint256 hashMuHashTip = stats.hashMuHash;
+
+    // Spend the first coinbase
+    const CScript coinbaseScript = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction spend;
+    spend.vin.emplace_back(COutPoint(coinbaseTxns[0].GetHash(), 0));
+    spend.vout.emplace_back(coinbaseTxns[0].vout[0].nValue - 10000, coinbaseScript);
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(coinbaseScript, spend, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+
+    const CBlock block = CreateAndProcessBlock({spend}, coinbaseScript);
+    BOOST_CHECK(WITH_LOCK(cs_main, return chainActive.Tip()->GetBlockHash()) == block.GetHash());
+    WaitForSync(coinstatsindex);
+    CheckTipStats(coinstatsindex);
+
+    // The statistics of the previous tip are still available
+    BOOST_CHECK(coinstatsindex.LookupStats(pindexTip, stats));
+    BOOST_CHECK(stats.hashMuHash == hashMuHashTip);
+
+    // Replace the block with one without the spend: the index is rewound
+    {
+        LOCK(cs_main);
+        CValidationState state;
+        BOOST_CHECK(InvalidateBlock(state, Params(), chainActive.Tip()));
+    }
+    mempool.clear();
+    SetMockTime(GetTime() + 60); // to generate a different block hash
+    CreateAndProcessBlock({}, coinbaseScript);
+    SetMockTime(0);
+    WaitForSync(coinstatsindex);
+    CheckTipStats(coinstatsindex);
+
+    coinstatsindex.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
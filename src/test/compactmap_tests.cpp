@@ -0,0 +1,132 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "compactmap.h"
+#include "arith_uint256.h"
+#include "coins.h"
+#include "script/standard.h"
+#include "test/test_Hemis.h"
+
+#include <unordered_map>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(compactmap_tests, BasicTestingSetup)
+
+static COutPoint RandomOutPoint(uint32_t nMaxTx)
+{
+    // A few outputs per transaction, so that the keys collide in the low bits
+    return COutPoint(ArithToUint256(arith_uint256(InsecureRandRange(nMaxTx))), InsecureRandRange(4));
+}
+
+BOOST_AUTO_TEST_CASE(compactmap_random_ops)
+{
+    compactmap<COutPoint, CAmount, SaltedOutpointHasher> map;
+    std::unordered_map<COutPoint, CAmount, SaltedOutpointHasher> expected;
+
+    for (int i = 0; i < 100000; i++) {
+        const COutPoint outpoint = RandomOutPoint(2000);
+        const CAmount value = InsecureRandRange(1000 * COIN);
+        switch (InsecureRandRange(5)) {
+        case 0: {
+            auto ret = map.try_emplace(outpoint, value);
+            auto ret2 = expected.emplace(outpoint, value);
+            BOOST_CHECK_EQUAL(ret.second, ret2.second);
+            BOOST_CHECK_EQUAL(ret.first->second, ret2.first->second);
+            break;
+        }
+        case 1:
+            map[outpoint] = value;
+            expected[outpoint] = value;
+            break;
+        case 2:
+            BOOST_CHECK_EQUAL(map.erase(outpoint), expected.erase(outpoint));
+            break;
+        case 3: {
+            auto it = map.find(outpoint);
+            auto it2 = expected.find(outpoint);
+            BOOST_CHECK_EQUAL(it == map.end(), it2 == expected.end());
+            if (it != map.end() && it2 != expected.end()) BOOST_CHECK_EQUAL(it->second, it2->second);
+            break;
+        }
+        case 4:
+            // Erase some of the entries while iterating, as BatchWrite does
+            if (InsecureRandRange(500) == 0) {
+                for (auto it = map.begin(); it != map.end();) {
+                    if (it->second & 1) {
+                        expected.erase(it->first);
+                        it = map.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            break;
+        }
+        BOOST_CHECK_EQUAL(map.size(), expected.size());
+    }
+
+    size_t nCount = 0;
+    for (const auto& entry : map) {
+        BOOST_CHECK_EQUAL(entry.second, expected.at(entry.first));
+        nCount++;
+    }
+    BOOST_CHECK_EQUAL(nCount, expected.size());
+
+    for (auto it = map.begin(); it != map.end();) {
+        it = map.erase(it);
+    }
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK(map.begin() == map.end());
+}
+
+BOOST_AUTO_TEST_CASE(compactmap_stable_references)
+{
+    compactmap<COutPoint, CAmount, SaltedOutpointHasher> map;
+    const COutPoint first = RandomOutPoint(1000000);
+    CAmount& value = map[first];
+    value = 42;
+    // Grow the index many times
+    for (int i = 0; i < 10000; i++) {
+        map[RandomOutPoint(1000000)] = i;
+    }
+    BOOST_CHECK_EQUAL(&map.find(first)->second, &value);
+    BOOST_CHECK_EQUAL(value, 42);
+
+    // The memory is released on clear, as with a new map
+    BOOST_CHECK(map.DynamicMemoryUsage() > 0);
+    map.clear();
+    BOOST_CHECK_EQUAL(map.DynamicMemoryUsage(), 0);
+    BOOST_CHECK(map.find(first) == map.end());
+}
+
+BOOST_AUTO_TEST_CASE(compactmap_coins_usage)
+{
+    // Same coins in both maps: P2PKH outputs, a few per transaction, as most of the UTXO set
+    const size_t nCoins = 100000;
+    CCoinsMap map;
+    std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> map2;
+    for (size_t i = 0; i < nCoins; i++) {
+        const COutPoint outpoint(InsecureRand256(), InsecureRandRange(4));
+        Coin coin;
+        coin.out.nValue = InsecureRandRange(1000 * COIN);
+        coin.out.scriptPubKey = GetScriptForDestination(CKeyID(uint160(InsecureRandBytes(20))));
+        BOOST_CHECK_EQUAL(coin.out.scriptPubKey.size(), 25);
+        coin.nHeight = i;
+        map.try_emplace(outpoint, Coin(coin));
+        map2.emplace(outpoint, CCoinsCacheEntry(std::move(coin)));
+    }
+    BOOST_REQUIRE_EQUAL(map.size(), nCoins);
+    BOOST_CHECK_EQUAL(map.size(), map2.size());
+
+    // Each coin takes its entry in the pool, and at most 32 bytes of index slots and unused pool entries
+    const size_t nBytesPerCoin = memusage::DynamicUsage(map) / nCoins;
+    const size_t nBytesPerCoin2 = memusage::DynamicUsage(map2) / nCoins;
+    BOOST_TEST_MESSAGE(strprintf("bytes per coin: %d (std::unordered_map: %d), coins per GiB: %d (std::unordered_map: %d)",
+                                 nBytesPerCoin, nBytesPerCoin2, (1 << 30) / nBytesPerCoin, (1 << 30) / nBytesPerCoin2));
+    BOOST_CHECK(nBytesPerCoin <= sizeof(CCoinsMap::value_type) + 32);
+    BOOST_CHECK(nBytesPerCoin < nBytesPerCoin2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1333,4 +1333,89 @@ BOOST_FIXTURE_TEST_CASE(dkg_pose_and_qfc_invalid_paths, TestChain400Setup)
     UpdateNetworkUpgradeParameters(Consensus::UPGRADE_V6_0, Consensus::NetworkUpgrade::NO_ACTIVATION_HEIGHT);
 }
 
+// Payment order, sorting all the valid gamemasters of the list
+static std::vector<uint256> SortedPayees(const CDeterministicGMList& gmList)
+{
+    std::vector<std::pair<int, uint256>> vec;
+    gmList.ForEachGM(true, [&](const CDeterministicGMCPtr& dgm) {
+        const auto& state = dgm->pdgmState;
+        int height = state->nLastPaidHeight;
+        if (state->nPoSeRevivedHeight != -1 && state->nPoSeRevivedHeight > height) {
+            height = state->nPoSeRevivedHeight;
+        } else if (height == 0) {
+            height = state->nRegisteredHeight;
+        }
+        vec.emplace_back(height, dgm->proTxHash);
+    });
+    std::sort(vec.begin(), vec.end());
+    std::vector<uint256> res;
+    for (const auto& p : vec) res.emplace_back(p.second);
+    return res;
+}
+
+static void CheckPayeeQueue(const CDeterministicGMList& gmList)
+{
+    const std::vector<uint256> expected = SortedPayees(gmList);
+    BOOST_CHECK_EQUAL(gmList.GetValidGMsCount(), expected.size());
+    std::vector<uint256> projected;
+    for (const auto& dgm : gmList.GetProjectedGMPayees(gmList.GetAllGMsCount())) {
+        projected.emplace_back(dgm->proTxHash);
+    }
+    BOOST_CHECK(projected == expected);
+    const auto payee = gmList.GetGMPayee();
+    BOOST_CHECK(expected.empty() ? payee == nullptr : payee->proTxHash == expected.front());
+}
+
+BOOST_FIXTURE_TEST_CASE(payee_queue, BasicTestingSetup)
+{
+    CDeterministicGMList gmList(UINT256_ZERO, 100, 0);
+    CheckPayeeQueue(gmList);
+
+    // Registrations, some at the same height
+    std::vector<uint256> proTxHashes;
+    for (int i = 0; i < 30; i++) {
+        auto dgm = std::make_shared<CDeterministicGM>(gmList.GetTotalRegisteredCount());
+        dgm->proTxHash = InsecureRand256();
+        dgm->collateralOutpoint = COutPoint(InsecureRand256(), 0);
+        auto state = std::make_shared<CDeterministicGMState>();
+        state->nRegisteredHeight = 10 + i / 3;
+        state->keyIDOwner = GetRandomKey().GetPubKey().GetID();
+        state->pubKeyOperator.Set(GetRandomBLSKey().GetPublicKey());
+        dgm->pdgmState = state;
+        gmList.AddGM(dgm);
+        proTxHashes.emplace_back(dgm->proTxHash);
+        CheckPayeeQueue(gmList);
+    }
+
+    // Payments, bans, revivals and removals
+    for (int nHeight = 101; nHeight < 300; nHeight++) {
+        const auto payee = gmList.GetGMPayee();
+        BOOST_ASSERT(payee != nullptr);
+        auto newState = std::make_shared<CDeterministicGMState>(*payee->pdgmState);
+        newState->nLastPaidHeight = nHeight;
+        // The copies of the list keep their own order
+        const CDeterministicGMList gmListCopy = gmList;
+        gmList.UpdateGM(payee, newState);
+        CheckPayeeQueue(gmList);
+        CheckPayeeQueue(gmListCopy);
+        BOOST_CHECK(gmListCopy.GetGMPayee()->proTxHash == payee->proTxHash);
+
+        const auto dgm = gmList.GetGM(proTxHashes[InsecureRandRange(proTxHashes.size())]);
+        if (!dgm) continue;
+        newState = std::make_shared<CDeterministicGMState>(*dgm->pdgmState);
+        if (nHeight % 7 == 0 && gmList.GetValidGMsCount() > 10) {
+            newState->BanIfNotBanned(nHeight);
+        } else if (nHeight % 3 == 0 && dgm->IsPoSeBanned()) {
+            newState->nPoSeBanHeight = -1;
+            newState->nPoSeRevivedHeight = nHeight;
+        } else if (nHeight % 29 == 0 && gmList.GetValidGMsCount() > 10) {
+            gmList.RemoveGM(dgm->proTxHash);
+            CheckPayeeQueue(gmList);
+            continue;
+        }
+        gmList.UpdateGM(dgm, newState);
+        CheckPayeeQueue(gmList);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "test/test_hemis.h"
+
+#include "chain.h"
+#include "hash.h"
+#include "kernel.h"
+#include "random.h"
+#include "stakeinput.h"
+#include "stakeorigins.h"
+#include "undo.h"
+#include "validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(kernel_tests, BasicTestingSetup)
+
+// Hash of the full kernel message, serialized as in the original CStakeKernel::GetHash
+static uint256 FullKernelHash(const uint256& nStakeModifier, int nTimeBlockFrom, const COutPoint& outpoint, int nTime)
+{
+    CDataStream ssUniqueness(SER_NETWORK, 0);
+    ssUniqueness << outpoint.n << outpoint.hash;
+    CDataStream ss(SER_GETHASH, 0);
+    ss << nStakeModifier << nTimeBlockFrom << ssUniqueness << nTime;
+    return Hash(ss.begin(), ss.end());
+}
+
+BOOST_AUTO_TEST_CASE(kernel_prefix_hash)
+{
+    CBlockIndex indexFrom;
+    indexFrom.nHeight = 10000;
+    indexFrom.nTime = 1600000000;
+
+    CBlockIndex indexPrev;
+    indexPrev.nHeight = 20000;
+    indexPrev.nTime = 1600100000;
+    const uint256 nStakeModifier = InsecureRand256();
+    indexPrev.SetStakeModifier(nStakeModifier);
+    BOOST_CHECK(indexPrev.GetStakeModifierV2() == nStakeModifier);
+
+    const COutPoint outpoint(InsecureRand256(), InsecureRandRange(100));
+    CPivStake stakeInput(CTxOut(250 * COIN, CScript()), outpoint, &indexFrom);
+
+    const unsigned int nBits = 0x1e0fffff;
+    const int nTime = indexPrev.nTime + 60;
+    CStakeKernel kernel(&indexPrev, &stakeInput, nBits, nTime);
+    BOOST_CHECK(kernel.IsValidFor(&indexPrev, nBits));
+    BOOST_CHECK(!kernel.IsValidFor(&indexFrom, nBits));
+    BOOST_CHECK(!kernel.IsValidFor(&indexPrev, nBits + 1));
+
+    // The midstate hashing must match the full kernel message, for any time slot
+    BOOST_CHECK(kernel.GetHash() == FullKernelHash(nStakeModifier, indexFrom.nTime, outpoint, nTime));
+    for (int i = 0; i < 100; i++) {
+        const int nTimeTx = nTime + 15 * i;
+        BOOST_CHECK(kernel.GetHash(nTimeTx) == FullKernelHash(nStakeModifier, indexFrom.nTime, outpoint, nTimeTx));
+    }
+
+    // Same target as CheckKernelHash
+    CStakeKernel kernel2(&indexPrev, &stakeInput, nBits, nTime + 15);
+    BOOST_CHECK_EQUAL(kernel.CheckKernelHashAtTime(nTime + 15), kernel2.CheckKernelHash(true));
+}
+
+// Block at nHeight spending one coin created at nHeight - 1000
+static COutPoint ConnectSpendingBlock(CStakeOrigins& origins, int nHeight)
+{
+    CMutableTransaction mtx;
+    mtx.vin.emplace_back(InsecureRand256(), 0);
+    CBlock block;
+    block.vtx.emplace_back(MakeTransactionRef(CMutableTransaction()));
+    block.vtx.emplace_back(MakeTransactionRef(mtx));
+    CBlockUndo blockundo;
+    blockundo.vtxundo.emplace_back();
+    blockundo.vtxundo.back().vprevout.emplace_back(CTxOut(nHeight * COIN, CScript()), nHeight - 1000, false, false);
+    origins.BlockConnected(block, blockundo, nHeight);
+    return mtx.vin[0].prevout;
+}
+
+BOOST_AUTO_TEST_CASE(stake_origins)
+{
+    LOCK(cs_main);
+    CStakeOrigins origins;
+    const int nWindow = 2 * DEFAULT_MAX_REORG_DEPTH;
+    std::vector<COutPoint> spent;
+    for (int nHeight = 1001; nHeight <= 1000 + 2 * nWindow; nHeight++) {
+        spent.emplace_back(ConnectSpendingBlock(origins, nHeight));
+    }
+    BOOST_CHECK_EQUAL(origins.Size(), (size_t) nWindow);
+
+    // Only the coins spent by the last blocks are kept
+    Coin coin;
+    BOOST_CHECK(!origins.GetSpentCoin(spent[nWindow - 1], coin));
+    for (int i = nWindow; i < 2 * nWindow; i++) {
+        BOOST_CHECK(origins.GetSpentCoin(spent[i], coin));
+        BOOST_CHECK_EQUAL(coin.nHeight, (uint32_t) i + 1);
+        BOOST_CHECK_EQUAL(coin.out.nValue, (i + 1001) * COIN);
+    }
+
+    // Disconnecting blocks removes the coins they spent
+    const int nTipHeight = 1000 + 2 * nWindow;
+    origins.BlockDisconnected(nTipHeight - 9);
+    BOOST_CHECK_EQUAL(origins.Size(), (size_t) nWindow - 10);
+    BOOST_CHECK(!origins.GetSpentCoin(spent.back(), coin));
+    BOOST_CHECK(origins.GetSpentCoin(spent[spent.size() - 11], coin));
+
+    // Another block at a disconnected height
+    const COutPoint out = ConnectSpendingBlock(origins, nTipHeight - 9);
+    BOOST_CHECK(origins.GetSpentCoin(out, coin));
+    BOOST_CHECK(!origins.GetSpentCoin(spent[spent.size() - 10], coin));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
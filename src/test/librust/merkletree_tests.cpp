@@ -173,4 +173,36 @@ BOOST_AUTO_TEST_CASE(EmptyrootSapling) {
     BOOST_CHECK(SaplingMerkleTree::empty_root() == expected);
 }
 
+BOOST_AUTO_TEST_CASE(SaplingWitnessTracker) {
+    // The tracker must produce the same witnesses as appending to each one of them
+    SaplingMerkleTree tree;
+    std::vector<SaplingWitness> witnesses;
+    std::vector<SaplingWitness> tracked;
+    // no reallocation (the tracker holds pointers to the witnesses)
+    tracked.reserve(200);
+    for (int block = 0; block < 20; block++) {
+        SaplingWitnessTracker tracker;
+        for (auto& w : tracked) tracker.AddWitness(&w);
+        const int nCommitments = InsecureRandRange(40);
+        for (int i = 0; i < nCommitments; i++) {
+            const libzcash::PedersenHash cmu(InsecureRand256());
+            tree.append(cmu);
+            for (auto& w : witnesses) w.append(cmu);
+            tracker.append(cmu);
+            // witness a new note, arriving in the block
+            if (InsecureRandBool() && tracked.size() < tracked.capacity()) {
+                witnesses.emplace_back(tree.witness());
+                tracked.emplace_back(tree.witness());
+                tracker.AddWitness(&tracked.back());
+            }
+        }
+        tracker.Flush();
+        BOOST_CHECK_EQUAL(witnesses.size(), tracked.size());
+        for (size_t i = 0; i < witnesses.size(); i++) {
+            BOOST_CHECK(witnesses[i] == tracked[i]);
+            BOOST_CHECK(tracked[i].root() == tree.root());
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
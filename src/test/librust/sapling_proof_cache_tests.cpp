@@ -0,0 +1,112 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "test/test_Hemis.h"
+
+#include "consensus/upgrades.h"
+#include "sapling/sapling_validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+using SaplingValidation::CProofCache;
+
+BOOST_FIXTURE_TEST_SUITE(sapling_proof_cache_tests, BasicTestingSetup)
+
+// A shielded transaction with one spend (zkproof[0] = proofByte), and a transparent output
+static CTransaction GetShieldedTx(unsigned char proofByte, CAmount nTransparentOut)
+{
+    CMutableTransaction mtx;
+    mtx.nVersion = CTransaction::TxVersion::SAPLING;
+    SpendDescription spend;
+    spend.zkproof[0] = proofByte;
+    mtx.sapData->vShieldedSpend.emplace_back(spend);
+    mtx.vout.emplace_back(nTransparentOut, CScript() << OP_TRUE);
+    return CTransaction(mtx);
+}
+
+BOOST_AUTO_TEST_CASE(proof_cache_entries)
+{
+    CProofCache cache;
+    cache.setup_bytes(1 << 20);
+    const int nEpoch = CurrentEpoch(Params().GetConsensus().vUpgrades[Consensus::UPGRADE_V5_3].nActivationHeight,
+                                    Params().GetConsensus());
+
+    // Hit after insert
+    const CTransaction& tx = GetShieldedTx(1, COIN);
+    uint256 entry;
+    cache.ComputeEntry(entry, tx, nEpoch);
+    BOOST_CHECK(!cache.Get(entry, false));
+    cache.Set(entry);
+    BOOST_CHECK(cache.Get(entry, false));
+
+    // Same transaction, same entry
+    uint256 entry2;
+    cache.ComputeEntry(entry2, GetShieldedTx(1, COIN), nEpoch);
+    BOOST_CHECK(entry2 == entry);
+    BOOST_CHECK(cache.Get(entry2, false));
+
+    // Miss for a different proof
+    cache.ComputeEntry(entry2, GetShieldedTx(2, COIN), nEpoch);
+    BOOST_CHECK(entry2 != entry);
+    BOOST_CHECK(!cache.Get(entry2, false));
+
+    // Miss for a different signature hash (the transparent outputs are signed)
+    cache.ComputeEntry(entry2, GetShieldedTx(1, 2 * COIN), nEpoch);
+    BOOST_CHECK(entry2 != entry);
+    BOOST_CHECK(!cache.Get(entry2, false));
+
+    // Another cache (salted differently) has different entries
+    CProofCache cache2;
+    cache2.ComputeEntry(entry2, tx, nEpoch);
+    BOOST_CHECK(entry2 != entry);
+}
+
+BOOST_AUTO_TEST_CASE(proof_cache_network_upgrade)
+{
+    const Consensus::Params& consensus = Params().GetConsensus();
+    const int nUpgradeHeight = consensus.vUpgrades[Consensus::UPGRADE_V5_3].nActivationHeight;
+    const int nEpochBefore = CurrentEpoch(nUpgradeHeight - 1, consensus);
+    const int nEpochAfter = CurrentEpoch(nUpgradeHeight, consensus);
+    BOOST_REQUIRE(nEpochBefore != nEpochAfter);
+
+    CProofCache cache;
+    cache.setup_bytes(1 << 20);
+    const CTransaction& tx = GetShieldedTx(1, COIN);
+    uint256 entryBefore, entryAfter;
+    cache.ComputeEntry(entryBefore, tx, nEpochBefore);
+    cache.ComputeEntry(entryAfter, tx, nEpochAfter);
+    BOOST_CHECK(entryBefore != entryAfter);
+
+    // Checked for the mempool before the upgrade: checked again in the first block after it
+    cache.Set(entryBefore);
+    BOOST_CHECK(cache.Get(entryBefore, false));
+    BOOST_CHECK(!cache.Get(entryAfter, false));
+}
+
+BOOST_AUTO_TEST_CASE(proof_cache_eviction)
+{
+    CProofCache cache;
+    const uint32_t nCapacity = cache.setup_bytes(64 * sizeof(uint256));
+    BOOST_REQUIRE(nCapacity > 0);
+    const int nEpoch = CurrentEpoch(0, Params().GetConsensus());
+
+    // Fill the cache several times over
+    std::vector<uint256> vEntries;
+    for (uint32_t i = 0; i < 8 * nCapacity; i++) {
+        uint256 entry;
+        cache.ComputeEntry(entry, GetShieldedTx(1, i + 1), nEpoch);
+        cache.Set(entry);
+        vEntries.emplace_back(entry);
+    }
+
+    // The cache holds at most nCapacity of them
+    uint32_t nHits = 0;
+    for (const uint256& entry : vEntries) {
+        if (cache.Get(entry, false)) nHits++;
+    }
+    BOOST_CHECK(nHits > 0);
+    BOOST_CHECK(nHits <= nCapacity);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
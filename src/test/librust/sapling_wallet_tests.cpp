@@ -174,6 +174,56 @@ BOOST_AUTO_TEST_CASE(FindMySaplingNotes)
     BOOST_CHECK_EQUAL(2, noteMap.size());
 }
 
+// Same as above, with the trial decryption split over several threads
+BOOST_AUTO_TEST_CASE(FindMySaplingNotesWithWorkers)
+{
+    auto consensusParams = Params().GetConsensus();
+
+    CWallet& wallet = m_wallet;
+    LOCK(wallet.cs_wallet);
+    wallet.SetupSPKM(false);
+    SaplingScriptPubKeyMan* sspk_man = wallet.GetSaplingScriptPubKeyMan();
+    sspk_man->StartDecryptionWorkers(4);
+
+    auto sk = GetTestMasterSaplingSpendingKey();
+    auto extfvk = sk.ToXFVK();
+    auto pa = sk.DefaultAddress();
+    auto testNote = GetTestSaplingNote(pa, 50000000);
+
+    // Pay to the third key of a sequence of keys of the wallet
+    auto skOther = sk.Derive(3);
+    auto builder = TransactionBuilder(consensusParams);
+    builder.AddSaplingSpend(sk.expsk, testNote.note, testNote.tree.root(), testNote.tree.witness());
+    builder.AddSaplingOutput(extfvk.fvk.ovk, skOther.DefaultAddress(), 25000000, {});
+    builder.SendChangeTo(pa, extfvk.fvk.ovk);
+    builder.SetFee(10000000);
+    auto tx = builder.Build().GetTxOrThrow();
+
+    for (uint32_t i = 0; i < 40; i++) {
+        if (i != 3) BOOST_CHECK(wallet.AddSaplingZKey(sk.Derive(i)));
+    }
+    auto noteMap = sspk_man->FindMySaplingNotes(tx).first;
+    BOOST_CHECK_EQUAL(0, noteMap.size());
+
+    BOOST_CHECK(wallet.AddSaplingZKey(skOther));
+    noteMap = sspk_man->FindMySaplingNotes(tx).first;
+    BOOST_CHECK_EQUAL(1, noteMap.size());
+    const SaplingNoteData& nd = noteMap.begin()->second;
+    BOOST_CHECK(nd.ivk == skOther.ToXFVK().fvk.in_viewing_key());
+    BOOST_CHECK_EQUAL(*nd.amount, 25000000);
+
+    // the change to the master key is found too
+    BOOST_CHECK(wallet.AddSaplingZKey(sk));
+    noteMap = sspk_man->FindMySaplingNotes(tx).first;
+    BOOST_CHECK_EQUAL(2, noteMap.size());
+
+    const auto& stats = sspk_man->GetTrialDecryptionStats();
+    BOOST_CHECK_EQUAL(stats.nThreads, 4);
+    BOOST_CHECK_EQUAL(stats.nTxs, 3);
+    BOOST_CHECK_EQUAL(stats.nOutputs, 6);
+    BOOST_CHECK_EQUAL(stats.nNotes, 3);
+}
+
 // Generate note A and spend to create note B, from which we spend to create two conflicting transactions
 BOOST_AUTO_TEST_CASE(GetConflictedSaplingNotes)
 {
@@ -9,6 +9,7 @@
 #include "sapling/sapling.h"
 #include "sapling/transaction_builder.h"
 #include "sapling/sapling_validation.h"
+#include "validation.h"
 
 #include <univalue.h>
 #include <boost/test/unit_test.hpp>
@@ -101,6 +102,63 @@ BOOST_AUTO_TEST_CASE(SaplingToSapling)
     BOOST_CHECK_EQUAL(state.GetRejectReason(), "");
 }
 
+BOOST_AUTO_TEST_CASE(BlockProofsCheck)
+{
+    using SaplingValidation::ProofCheckResult;
+    auto consensusParams = Params().GetConsensus();
+
+    CBasicKeyStore keystore;
+    CKey tsk = AddTestCKeyToKeyStore(keystore);
+    auto scriptPubKey = GetScriptForDestination(tsk.GetPubKey().GetID());
+    auto sk = libzcash::SaplingSpendingKey::random();
+    auto expsk = sk.expanded_spending_key();
+    auto fvk = sk.full_viewing_key();
+    auto pa = sk.default_address();
+
+    // A transparent tx, followed by shielding and shielded txs
+    CBlock block;
+    CMutableTransaction mtx;
+    mtx.vin.emplace_back(COutPoint(uint256S("1234"), 0));
+    mtx.vout.emplace_back(1 * COIN, scriptPubKey);
+    block.vtx.emplace_back(MakeTransactionRef(mtx));
+    for (int i = 0; i < 4; i++) {
+        auto builder = TransactionBuilder(consensusParams, &keystore);
+        builder.SetFee(10000000);
+        if (i % 2) {
+            auto testNote = GetTestSaplingNote(pa, 40000000);
+            builder.AddSaplingSpend(expsk, testNote.note, testNote.tree.root(), testNote.tree.witness());
+        } else {
+            builder.AddTransparentInput(COutPoint(uint256S("1234"), i + 1), scriptPubKey, 50000000);
+        }
+        builder.AddSaplingOutput(fvk.ovk, pa, 29900000, {});
+        block.vtx.emplace_back(MakeTransactionRef(builder.Build().GetTxOrThrow()));
+    }
+
+    std::vector<ProofCheckResult> vResults = CheckBlockSaplingProofs(block, 2);
+    BOOST_CHECK_EQUAL(vResults.size(), block.vtx.size());
+    BOOST_CHECK(vResults[0] == ProofCheckResult::UNCHECKED);
+    for (size_t i = 1; i < vResults.size(); i++) {
+        BOOST_CHECK(vResults[i] == ProofCheckResult::VALID);
+    }
+
+    // Break the binding signature of the third tx: the failure is reported for it
+    CMutableTransaction mtxBad(*block.vtx[3]);
+    mtxBad.sapData->bindingSig[0] ^= 1;
+    block.vtx[3] = MakeTransactionRef(mtxBad);
+    vResults = CheckBlockSaplingProofs(block, 2);
+    BOOST_CHECK(vResults[3] == ProofCheckResult::INVALID_BINDING_SIG);
+    for (size_t i = 1; i < vResults.size(); i++) {
+        if (i == 3) continue;
+        // the others are valid, or skipped after the failure
+        BOOST_CHECK(vResults[i] != ProofCheckResult::INVALID_BINDING_SIG);
+        BOOST_CHECK(vResults[i] != ProofCheckResult::INVALID_SPEND);
+        BOOST_CHECK(vResults[i] != ProofCheckResult::INVALID_OUTPUT);
+    }
+    CValidationState state;
+    BOOST_CHECK(!SaplingValidation::ContextualCheckTransaction(*block.vtx[3], state, Params(), 2, true, false, vResults[3]));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "bad-txns-sapling-binding-signature-invalid");
+}
+
 BOOST_AUTO_TEST_CASE(ThrowsOnTransparentInputWithoutKeyStore)
 {
     auto builder = TransactionBuilder(Params().GetConsensus());
@@ -274,6 +332,53 @@ BOOST_AUTO_TEST_CASE(SetFee)
     }
 }
 
+BOOST_AUTO_TEST_CASE(ParallelProofs)
+{
+    auto consensusParams = Params().GetConsensus();
+
+    auto sk = libzcash::SaplingSpendingKey::random();
+    auto expsk = sk.expanded_spending_key();
+    auto fvk = sk.full_viewing_key();
+    auto pa = sk.default_address();
+
+    auto testNote = GetTestSaplingNote(pa, 5 * COIN);
+
+    // 1 spend and 4 outputs (with the change) proven with separate contexts:
+    // the binding signature must still be valid
+    for (int nThreads : {1, 4}) {
+        auto builder = TransactionBuilder(consensusParams);
+        builder.AddSaplingSpend(expsk, testNote.note, testNote.tree.root(), testNote.tree.witness());
+        for (int i = 0; i < 3; i++) {
+            builder.AddSaplingOutput(fvk.ovk, pa, COIN, {});
+        }
+        builder.SetFee(COIN / 2);
+        BOOST_CHECK(builder.Build(true).IsTx());
+        builder.ClearProofsAndSignatures();
+        auto tx = builder.ProveAndSign(nThreads).GetTxOrThrow();
+
+        const TransactionBuilder::ProvingStats& stats = builder.GetProvingStats();
+        BOOST_CHECK_EQUAL(stats.nThreads, nThreads);
+        BOOST_CHECK_EQUAL(stats.nSpends, 1);
+        BOOST_CHECK_EQUAL(stats.nOutputs, 4);
+
+        BOOST_CHECK_EQUAL(tx.sapData->vShieldedSpend.size(), 1);
+        BOOST_CHECK_EQUAL(tx.sapData->vShieldedOutput.size(), 4);
+        BOOST_CHECK_EQUAL(tx.sapData->valueBalance, COIN / 2);
+        CValidationState state;
+        BOOST_CHECK(SaplingValidation::ContextualCheckTransaction(tx, state, Params(), 3, true, false));
+        BOOST_CHECK_EQUAL(state.GetRejectReason(), "");
+    }
+
+    // Cancelled before the proofs
+    std::atomic<bool> fCancel{true};
+    auto builder = TransactionBuilder(consensusParams);
+    builder.AddSaplingSpend(expsk, testNote.note, testNote.tree.root(), testNote.tree.witness());
+    builder.AddSaplingOutput(fvk.ovk, pa, COIN, {});
+    builder.SetFee(COIN / 2);
+    builder.SetCancelFlag(&fCancel);
+    BOOST_CHECK_EQUAL(builder.Build().GetError(), "Proof generation cancelled");
+}
+
 BOOST_AUTO_TEST_CASE(CheckSaplingTxVersion)
 {
     auto consensusParams = Params().GetConsensus();
@@ -1,18 +1,10 @@
 // Copyright (c) 2015 The Bitcoin Core developers
-<<<<<<< HEAD
-// Copyright (c) 2019-2020 The PIVX Core developers
-=======
 // Copyright (c) 2019-2020 The Hemis Core developers
->>>>>>> 1f345019d (first step)
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "consensus/merkle.h"
-<<<<<<< HEAD
-#include "test/test_pivx.h"
-=======
 #include "test/test_Hemis.h"
->>>>>>> 1f345019d (first step)
 
 #include <boost/test/unit_test.hpp>
 
@@ -141,4 +133,35 @@ BOOST_AUTO_TEST_CASE(merkle_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(merkle_tree_cache)
+{
+    for (int i = 0; i < 24; i++) {
+        // All sizes from 0 to 16 inclusive, and then random sizes
+        const int nLeaves = (i <= 16) ? i : 17 + InsecureRandRange(4000);
+        std::vector<uint256> leaves(nLeaves);
+        for (uint256& leaf : leaves) leaf = InsecureRand256();
+
+        CMerkleTree tree(leaves);
+        BOOST_CHECK_EQUAL(tree.GetLeavesCount(), (size_t)nLeaves);
+        BOOST_CHECK(tree.GetRoot() == ComputeMerkleRoot(leaves));
+        if (nLeaves == 0) continue;
+
+        // Branches from the cached levels
+        for (int loop = 0; loop < std::min(nLeaves, 16); loop++) {
+            const uint32_t pos = nLeaves > 16 ? InsecureRandRange(nLeaves) : loop;
+            const std::vector<uint256>& branch = tree.GetBranch(pos);
+            BOOST_CHECK(branch == ComputeMerkleBranch(leaves, pos));
+            BOOST_CHECK(ComputeMerkleRootFromBranch(leaves[pos], branch, pos) == tree.GetRoot());
+        }
+
+        // Update the first leaf (the coinbase), the last one, and a random one
+        for (const size_t pos : {(size_t)0, leaves.size() - 1, (size_t)InsecureRandRange(nLeaves)}) {
+            leaves[pos] = InsecureRand256();
+            tree.SetLeaf(pos, leaves[pos]);
+            BOOST_CHECK(tree.GetRoot() == ComputeMerkleRoot(leaves));
+            BOOST_CHECK(tree.GetBranch(pos) == ComputeMerkleBranch(leaves, pos));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,115 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "test/test_Hemis.h"
+
+#include "random.h"
+#include "sapling/nullifierfilter.h"
+#include "txdb.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(nullifierfilter_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(filter_no_false_negatives)
+{
+    CNullifierFilter filter;
+    // Disabled: every nullifier may be in the database
+    BOOST_CHECK(filter.MayContain(GetRandHash()));
+
+    const size_t nCount = 100000;
+    filter.Reset(nCount, 16 << 20);
+    std::vector<uint256> vInserted;
+    for (size_t i = 0; i < nCount; i++) {
+        vInserted.emplace_back(GetRandHash());
+        filter.Insert(vInserted.back());
+    }
+    for (const uint256& nf : vInserted) {
+        BOOST_CHECK(filter.MayContain(nf));
+    }
+    BOOST_CHECK(!filter.NeedsRebuild());
+
+    // 16 bits per element: well below 1% false positives
+    size_t nFalsePositives = 0;
+    for (size_t i = 0; i < nCount; i++) {
+        if (filter.MayContain(GetRandHash())) nFalsePositives++;
+    }
+    BOOST_CHECK(nFalsePositives < nCount / 100);
+    BOOST_CHECK_EQUAL(filter.GetStats().nFiltered, nCount - nFalsePositives);
+}
+
+BOOST_AUTO_TEST_CASE(filter_rebuild)
+{
+    CNullifierFilter filter;
+    filter.Reset(0, 16 << 20);
+    const CNullifierFilter::Stats stats = filter.GetStats();
+    BOOST_CHECK(stats.fEnabled);
+    for (size_t i = 0; i <= stats.nCapacity; i++) {
+        filter.Insert(GetRandHash());
+    }
+    BOOST_CHECK(filter.NeedsRebuild());
+
+    // Already at the maximum size: keep it, with more false positives
+    filter.Reset(0, stats.nBytes);
+    for (size_t i = 0; i <= stats.nCapacity; i++) {
+        filter.Insert(GetRandHash());
+    }
+    BOOST_CHECK(!filter.NeedsRebuild());
+
+    filter.Disable();
+    BOOST_CHECK(!filter.GetStats().fEnabled);
+    BOOST_CHECK(!filter.NeedsRebuild());
+}
+
+static void WriteNullifiers(CCoinsViewDB& db, const std::vector<uint256>& vNullifiers, bool fSpent)
+{
+    CCoinsMap mapCoins;
+    CAnchorsSaplingMap mapAnchors;
+    CNullifiersMap mapNullifiers;
+    for (const uint256& nf : vNullifiers) {
+        CNullifiersCacheEntry& entry = mapNullifiers[nf];
+        entry.entered = fSpent;
+        entry.flags = CNullifiersCacheEntry::DIRTY;
+    }
+    BOOST_CHECK(db.BatchWrite(mapCoins, GetRandHash(), UINT256_ZERO, mapAnchors, mapNullifiers));
+}
+
+BOOST_AUTO_TEST_CASE(coinsdb_nullifiers)
+{
+    CCoinsViewDB db(1 << 20, true, true);
+    std::vector<uint256> vLoaded;
+    for (int i = 0; i < 1000; i++) vLoaded.emplace_back(GetRandHash());
+    WriteNullifiers(db, vLoaded, true);
+
+    BOOST_CHECK(db.LoadNullifierFilter(1 << 20));
+    CNullifierFilter::Stats stats = db.GetNullifierFilterStats();
+    BOOST_CHECK(stats.fEnabled);
+    BOOST_CHECK_EQUAL(stats.nElements, vLoaded.size());
+    BOOST_CHECK_EQUAL(stats.nBuilds, 1);
+
+    // Nullifiers written after the load are in the filter too
+    std::vector<uint256> vWritten;
+    for (int i = 0; i < 1000; i++) vWritten.emplace_back(GetRandHash());
+    WriteNullifiers(db, vWritten, true);
+    for (const uint256& nf : vLoaded) BOOST_CHECK(db.GetNullifier(nf));
+    for (const uint256& nf : vWritten) BOOST_CHECK(db.GetNullifier(nf));
+    for (int i = 0; i < 1000; i++) BOOST_CHECK(!db.GetNullifier(GetRandHash()));
+
+    // Erased nullifiers stay in the filter, but are not found in the database
+    WriteNullifiers(db, vWritten, false);
+    for (const uint256& nf : vWritten) BOOST_CHECK(!db.GetNullifier(nf));
+
+    stats = db.GetNullifierFilterStats();
+    BOOST_CHECK_EQUAL(stats.nHits, vLoaded.size() + vWritten.size());
+    BOOST_CHECK(stats.nFalsePositives >= vWritten.size());
+    BOOST_CHECK(stats.nFiltered + stats.nFalsePositives == 1000 + vWritten.size());
+
+    // Disabled: every lookup reads the database
+    BOOST_CHECK(db.LoadNullifierFilter(0));
+    BOOST_CHECK(!db.GetNullifierFilterStats().fEnabled);
+    for (const uint256& nf : vLoaded) BOOST_CHECK(db.GetNullifier(nf));
+    BOOST_CHECK(!db.GetNullifier(GetRandHash()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -9,8 +9,10 @@
 
 #include "blockassembler.h"
 #include "consensus/merkle.h"
+#include "crypto/sha256.h"
 #include "bls/bls_wrapper.h"
 #include "guiinterface.h"
+#include "index/txindex.h"
 #include "evo/deterministicgms.h"
 #include "evo/evodb.h"
 #include "evo/evonotificationinterface.h"
@@ -67,10 +69,12 @@ std::ostream& operator<<(std::ostream& os, const uint256& num)
 BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
     : m_path_root{fs::temp_directory_path() / "test_Hemis" / std::to_string(g_insecure_rand_ctx_temp_path.rand32())}
 {
+    SHA256AutoDetect();
     ECC_Start();
     BLSInit();
     SetupEnvironment();
     InitSignatureCache();
+    SaplingValidation::InitProofCache();
     fCheckBlockIndex = true;
     SelectParams(chainName);
     SeedInsecureRand();
@@ -132,14 +136,21 @@ TestingSetup::TestingSetup(const std::string& chainName) : BasicTestingSetup(cha
             bool ok = ActivateBestChain(state);
             BOOST_CHECK(ok);
         }
+        // As the node does by default (-txindex)
+        g_txindex = std::make_unique<TxIndex>(1 << 20, true);
+        g_txindex->Start();
         nScriptCheckThreads = 3;
-        for (int i=0; i < nScriptCheckThreads-1; i++)
+        for (int i=0; i < nScriptCheckThreads-1; i++) {
             threadGroup.create_thread(&ThreadScriptCheck);
+            threadGroup.create_thread(&ThreadSaplingCheck);
+            threadGroup.create_thread(&ThreadCoinsPrefetch);
+        }
         peerLogic.reset(new PeerLogicValidation(connman));
 }
 
 TestingSetup::~TestingSetup()
 {
+        g_txindex.reset();
         scheduler.stop();
         threadGroup.interrupt_all();
         threadGroup.join_all();
@@ -10,6 +10,7 @@
 #include "flatdb.h"
 #include "guiinterface.h"
 #include "guiinterfaceutil.h"
+#include "index/txindex.h"
 #include "gamemasterman.h"
 #include "gamemaster-payments.h"
 #include "gamemasterconfig.h"
@@ -215,9 +216,9 @@ void SetBudgetFinMode(const std::string& mode)
 bool InitActiveGM()
 {
     fGameMaster = gArgs.GetBoolArg("-gamemaster", DEFAULT_GAMEMASTER);
-    if ((fGameMaster || gamemasterConfig.getCount() > -1) && fTxIndex == false) {
+    if ((fGameMaster || gamemasterConfig.getCount() > -1) && !g_txindex) {
         return UIError(strprintf(_("Enabling Gamemaster support requires turning on transaction indexing."
-                                   "Please add %s to your configuration and start with %s"), "txindex=1", "-reindex"));
+                                   "Please add %s to your configuration"), "txindex=1"));
     }
 
     if (fGameMaster) {
@@ -20,7 +20,6 @@
 static const char DB_COIN = 'C';
 static const char DB_COINS = 'c';
 static const char DB_BLOCK_FILES = 'f';
-static const char DB_TXINDEX = 't';
 static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
@@ -48,17 +47,46 @@ CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(Get
 {
 }
 
+CCoinsViewDB::~CCoinsViewDB()
+{
+    if (flushThread.joinable()) {
+        // The thread writes the pending flush before exiting
+        WITH_LOCK(cs_flush, fStopFlush = true);
+        condFlush.notify_all();
+        flushThread.join();
+    }
+}
+
 bool CCoinsViewDB::GetCoin(const COutPoint& outpoint, Coin& coin) const
 {
+    if (fBackgroundFlush) {
+        LOCK(cs_flush);
+        if (pendingFlush) {
+            auto it = pendingFlush->mapCoins.find(outpoint);
+            if (it != pendingFlush->mapCoins.end()) {
+                coin = it->second.coin;
+                return !coin.IsSpent();
+            }
+        }
+    }
     return db.Read(CoinEntry(&outpoint), coin);
 }
 
 bool CCoinsViewDB::HaveCoin(const COutPoint& outpoint) const
 {
+    if (fBackgroundFlush) {
+        LOCK(cs_flush);
+        if (pendingFlush) {
+            auto it = pendingFlush->mapCoins.find(outpoint);
+            if (it != pendingFlush->mapCoins.end()) {
+                return !it->second.coin.IsSpent();
+            }
+        }
+    }
     return db.Exists(CoinEntry(&outpoint));
 }
 
-uint256 CCoinsViewDB::GetBestBlock() const
+uint256 CCoinsViewDB::ReadBestBlock() const
 {
     uint256 hashBestChain;
     if (!db.Read(DB_BEST_BLOCK, hashBestChain))
@@ -66,6 +94,15 @@ uint256 CCoinsViewDB::GetBestBlock() const
     return hashBestChain;
 }
 
+uint256 CCoinsViewDB::GetBestBlock() const
+{
+    if (fBackgroundFlush) {
+        LOCK(cs_flush);
+        if (pendingFlush) return pendingFlush->hashBlock;
+    }
+    return ReadBestBlock();
+}
+
 std::vector<uint256> CCoinsViewDB::GetHeadBlocks() const {
     std::vector<uint256> vhashHeadBlocks;
     if (!db.Read(DB_HEAD_BLOCKS, vhashHeadBlocks)) {
@@ -79,15 +116,119 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap& mapCoins,
                               const uint256& hashSaplingAnchor,
                               CAnchorsSaplingMap& mapSaplingAnchors,
                               CNullifiersMap& mapSaplingNullifiers)
+{
+    const int64_t nStart = GetTimeMicros();
+    if (!fBackgroundFlush) {
+        size_t nChanged = 0;
+        bool ret = WriteCaches(mapCoins, hashBlock, hashSaplingAnchor, mapSaplingAnchors, mapSaplingNullifiers, nChanged);
+        mapCoins.clear();
+        mapSaplingAnchors.clear();
+        mapSaplingNullifiers.clear();
+        const int64_t nTime = GetTimeMicros() - nStart;
+        LOCK(cs_flush);
+        flushStats.nFlushes++;
+        flushStats.nLastChanged = nChanged;
+        flushStats.nLastBlockingMicros = flushStats.nLastWriteMicros = nTime;
+        flushStats.nTotalBlockingMicros += nTime;
+        flushStats.nTotalWriteMicros += nTime;
+        return ret;
+    }
+
+    WAIT_LOCK(cs_flush, lock);
+    // One flush at a time: wait for the previous one to be written
+    condFlush.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(cs_flush) { return !pendingFlush || flushStats.fFailed; });
+    if (flushStats.fFailed) return false;
+    assert(!hashBlock.IsNull());
+    pendingFlush.reset(new PendingFlush{std::move(mapCoins), hashBlock, hashSaplingAnchor, std::move(mapSaplingAnchors), std::move(mapSaplingNullifiers)});
+    mapCoins.clear();
+    mapSaplingAnchors.clear();
+    mapSaplingNullifiers.clear();
+    flushStats.fInProgress = true;
+    flushStats.nLastBlockingMicros = GetTimeMicros() - nStart;
+    flushStats.nTotalBlockingMicros += flushStats.nLastBlockingMicros;
+    condFlush.notify_all();
+    return true;
+}
+
+void CCoinsViewDB::StartBackgroundFlush()
+{
+    assert(!flushThread.joinable());
+    fBackgroundFlush = true;
+    WITH_LOCK(cs_flush, flushStats.fBackground = true);
+    flushThread = std::thread(&TraceThread<std::function<void()>>, "coinsflush", std::function<void()>(std::bind(&CCoinsViewDB::ThreadFlush, this)));
+}
+
+void CCoinsViewDB::ThreadFlush()
+{
+    WAIT_LOCK(cs_flush, lock);
+    while (true) {
+        condFlush.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(cs_flush) { return (pendingFlush && !flushStats.fFailed) || fStopFlush; });
+        if (!pendingFlush || flushStats.fFailed) return;
+
+        // The pending caches are not modified until written: the lookups read them meanwhile
+        const PendingFlush& flush = *pendingFlush;
+        const int64_t nStart = GetTimeMicros();
+        size_t nChanged = 0;
+        bool ret = false;
+        {
+            REVERSE_LOCK(lock);
+            try {
+                ret = WriteCaches(flush.mapCoins, flush.hashBlock, flush.hashSaplingAnchor, flush.mapSaplingAnchors, flush.mapSaplingNullifiers, nChanged);
+            } catch (const std::exception& e) {
+                LogPrintf("%s: %s\n", __func__, e.what());
+            }
+        }
+        if (!ret) {
+            // Keep serving the caches: the database is not consistent with them
+            LogPrintf("%s: Failed to write to coin database\n", __func__);
+            flushStats.fFailed = true;
+            condFlush.notify_all();
+            continue;
+        }
+        const int64_t nTime = GetTimeMicros() - nStart;
+        flushStats.nFlushes++;
+        flushStats.fInProgress = false;
+        flushStats.nLastChanged = nChanged;
+        flushStats.nLastWriteMicros = nTime;
+        flushStats.nTotalWriteMicros += nTime;
+        LogPrint(BCLog::BENCHMARK, "%s: wrote %u changed coins in %.2fms\n", __func__, (unsigned int)nChanged, nTime * 0.001);
+
+        std::unique_ptr<const PendingFlush> written = std::move(pendingFlush);
+        condFlush.notify_all();
+        {
+            // Free the caches without blocking the lookups
+            REVERSE_LOCK(lock);
+            written.reset();
+        }
+    }
+}
+
+bool CCoinsViewDB::WaitForFlush() const
+{
+    WAIT_LOCK(cs_flush, lock);
+    condFlush.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(cs_flush) { return !pendingFlush || flushStats.fFailed; });
+    return !flushStats.fFailed;
+}
+
+CCoinsViewDB::FlushStats CCoinsViewDB::GetFlushStats() const
+{
+    return WITH_LOCK(cs_flush, return flushStats);
+}
+
+bool CCoinsViewDB::WriteCaches(const CCoinsMap& mapCoins,
+                               const uint256& hashBlock,
+                               const uint256& hashSaplingAnchor,
+                               const CAnchorsSaplingMap& mapSaplingAnchors,
+                               const CNullifiersMap& mapSaplingNullifiers,
+                               size_t& changed)
 {
     CDBBatch batch(CLIENT_VERSION);
     size_t count = 0;
-    size_t changed = 0;
     size_t batch_size = (size_t) gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
     int crash_simulate = gArgs.GetArg("-dbcrashratio", 0);
     assert(!hashBlock.IsNull());
 
-    uint256 old_tip = GetBestBlock();
+    uint256 old_tip = ReadBestBlock();
     if (old_tip.IsNull()) {
         // We may be in the middle of replaying.
         std::vector<uint256> old_heads = GetHeadBlocks();
@@ -104,7 +245,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap& mapCoins,
     batch.Erase(DB_BEST_BLOCK);
     batch.Write(DB_HEAD_BLOCKS, Vector(hashBlock, old_tip));
 
-    for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
+    for (CCoinsMap::const_iterator it = mapCoins.begin(); it != mapCoins.end(); it++) {
         if (it->second.flags & CCoinsCacheEntry::DIRTY) {
             CoinEntry entry(&it->first);
             if (it->second.coin.IsSpent())
@@ -114,8 +255,6 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap& mapCoins,
             changed++;
         }
         count++;
-        CCoinsMap::iterator itOld = it++;
-        mapCoins.erase(itOld);
         if (batch.SizeEstimate() > batch_size) {
             LogPrint(BCLog::COINDB, "Writing partial batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
             db.WriteBatch(batch);
@@ -140,6 +279,11 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap& mapCoins,
     LogPrint(BCLog::COINDB, "Writing final batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
     bool ret = db.WriteBatch(batch);
     LogPrint(BCLog::COINDB, "Committed %u changed transaction outputs (out of %u) to coin database...\n", (unsigned int)changed, (unsigned int)count);
+
+    // Grow the nullifier filter once it holds more nullifiers than it was sized for
+    if (ret && nullifierFilter.NeedsRebuild()) {
+        ret = LoadNullifierFilter(nullifierFilter.GetMaxBytes());
+    }
     return ret;
 }
 
@@ -183,6 +327,8 @@ bool CBlockTreeDB::ReadLastBlockFile(int& nFile)
 
 CCoinsViewCursor *CCoinsViewDB::Cursor() const
 {
+    // The cursor only sees the database
+    WaitForFlush();
     CCoinsViewDBCursor *i = new CCoinsViewDBCursor(const_cast<CDBWrapper&>(db).NewIterator(), GetBestBlock());
     /* It seems that there are no "const iterators" for LevelDB.  Since we
        only need read operations on it, use a const-cast to get around
@@ -248,19 +394,6 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     return WriteBatch(batch, true);
 }
 
-bool CBlockTreeDB::ReadTxIndex(const uint256& txid, CDiskTxPos& pos)
-{
-    return Read(std::make_pair(DB_TXINDEX, txid), pos);
-}
-
-bool CBlockTreeDB::WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> >& vect)
-{
-    CDBBatch batch(CLIENT_VERSION);
-    for (std::vector<std::pair<uint256, CDiskTxPos> >::const_iterator it = vect.begin(); it != vect.end(); it++)
-        batch.Write(std::make_pair(DB_TXINDEX, it->first), it->second);
-    return WriteBatch(batch);
-}
-
 bool CBlockTreeDB::WriteFlag(const std::string& name, bool fValue)
 {
     return Write(std::make_pair(DB_FLAG, name), fValue ? '1' : '0');
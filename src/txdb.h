@@ -12,9 +12,14 @@
 #include "dbwrapper.h"
 #include "libzerocoin/Coin.h"
 #include "libzerocoin/CoinSpend.h"
+#include "sapling/nullifierfilter.h"
+#include "sync.h"
 
+#include <condition_variable>
 #include <map>
+#include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -31,14 +36,24 @@ static const int64_t nDefaultDbBatchSize = 16 << 20;
 static const int64_t nMaxDbCache = sizeof(void*) > 4 ? 16384 : 1024;
 //! min. -dbcache (MiB)
 static const int64_t nMinDbCache = 4;
-//! Max memory allocated to block tree DB specific cache, if no -txindex (MiB)
+//! Max memory allocated to block tree DB specific cache (MiB)
 static const int64_t nMaxBlockDBCache = 2;
-//! Max memory allocated to block tree DB specific cache, if -txindex (MiB)
+//! Max memory allocated to tx index DB specific cache (MiB)
 // Unlike for the UTXO database, for the txindex scenario the leveldb cache make
 // a meaningful difference: https://github.com/bitcoin/bitcoin/pull/8273#issuecomment-229601991
-static const int64_t nMaxBlockDBAndTxIndexCache = 1024;
+static const int64_t nMaxTxIndexCache = 1024;
+//! Max memory allocated to address index DB specific cache (MiB)
+static const int64_t nMaxAddressIndexCache = 1024;
+//! Max memory allocated to block stats index DB specific cache (MiB)
+static const int64_t nMaxBlockStatsIndexCache = 16;
+//! Max memory allocated to coin stats index DB specific cache (MiB)
+static const int64_t nMaxCoinStatsIndexCache = 16;
+//! Max memory allocated to all block filter index caches combined (MiB)
+static const int64_t nMaxFilterIndexCache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
+//! -backgroundflush default
+static const bool DEFAULT_BACKGROUND_FLUSH = false;
 
 struct CDiskTxPos : public FlatFilePos
 {
@@ -69,11 +84,56 @@ struct CDiskTxPos : public FlatFilePos
 /** CCoinsView backed by the LevelDB coin database (chainstate/) */
 class CCoinsViewDB : public CCoinsView
 {
+public:
+    struct FlushStats {
+        bool fBackground{false};
+        int64_t nFlushes{0};
+        bool fInProgress{false};
+        //! A background flush failed: the node must stop
+        bool fFailed{false};
+        //! Last flush: changed coins, time blocking the caller, and time writing the database
+        size_t nLastChanged{0};
+        int64_t nLastBlockingMicros{0};
+        int64_t nLastWriteMicros{0};
+        int64_t nTotalBlockingMicros{0};
+        int64_t nTotalWriteMicros{0};
+    };
+
 protected:
     CDBWrapper db;
+    //! In front of the Sapling nullifiers of the database, see LoadNullifierFilter
+    CNullifierFilter nullifierFilter;
+
+    //! The caches given to BatchWrite in background flush mode, until they are written
+    struct PendingFlush {
+        CCoinsMap mapCoins;
+        uint256 hashBlock;
+        uint256 hashSaplingAnchor;
+        CAnchorsSaplingMap mapSaplingAnchors;
+        CNullifiersMap mapSaplingNullifiers;
+    };
+    bool fBackgroundFlush{false};
+    std::thread flushThread;
+    mutable Mutex cs_flush;
+    mutable std::condition_variable condFlush;
+    std::unique_ptr<const PendingFlush> pendingFlush GUARDED_BY(cs_flush);
+    bool fStopFlush GUARDED_BY(cs_flush){false};
+    FlushStats flushStats GUARDED_BY(cs_flush);
+
+    //! Write the changes of the caches to the database, leaving them untouched
+    bool WriteCaches(const CCoinsMap& mapCoins,
+                     const uint256& hashBlock,
+                     const uint256& hashSaplingAnchor,
+                     const CAnchorsSaplingMap& mapSaplingAnchors,
+                     const CNullifiersMap& mapSaplingNullifiers,
+                     size_t& nChanged);
+    //! Best block written in the database, ignoring any pending flush
+    uint256 ReadBestBlock() const;
+    void ThreadFlush();
 
 public:
     CCoinsViewDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+    ~CCoinsViewDB();
 
     bool GetCoin(const COutPoint& outpoint, Coin& coin) const override;
     bool HaveCoin(const COutPoint& outpoint) const override;
@@ -85,6 +145,17 @@ public:
     bool Upgrade();
     size_t EstimateSize() const override;
 
+    /**
+     * In background flush mode, BatchWrite takes the content of the caches and returns:
+     * they are written in the database by a separate thread, and served from memory until
+     * then. A flush waits for the previous one to be written.
+     * A crash during the write is recovered as with a synchronous flush, by ReplayBlocks.
+     */
+    void StartBackgroundFlush();
+    //! Wait for a background flush to be written. Returns false if it failed.
+    bool WaitForFlush() const;
+    FlushStats GetFlushStats() const;
+
     bool BatchWrite(CCoinsMap& mapCoins,
                     const uint256& hashBlock,
                     const uint256& hashSaplingAnchor,
@@ -96,9 +167,12 @@ public:
     bool GetNullifier(const uint256 &nf) const override;
     uint256 GetBestAnchor() const override;
     bool BatchWriteSapling(const uint256& hashSaplingAnchor,
-                           CAnchorsSaplingMap& mapSaplingAnchors,
-                           CNullifiersMap& mapSaplingNullifiers,
+                           const CAnchorsSaplingMap& mapSaplingAnchors,
+                           const CNullifiersMap& mapSaplingNullifiers,
                            CDBBatch& batch);
+    //! Build the nullifier filter from the database, within nMaxBytes (0 disables it)
+    bool LoadNullifierFilter(size_t nMaxBytes);
+    CNullifierFilter::Stats GetNullifierFilterStats() const;
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
@@ -138,8 +212,6 @@ public:
     bool ReadLastBlockFile(int& nFile);
     bool WriteReindexing(bool fReindexing);
     bool ReadReindexing(bool& fReindexing);
-    bool ReadTxIndex(const uint256& txid, CDiskTxPos& pos);
-    bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> >& vect);
     bool WriteFlag(const std::string& name, bool fValue);
     bool ReadFlag(const std::string& name, bool& fValue);
     bool WriteInt(const std::string& name, int nValue);
@@ -19,6 +19,7 @@
 
 #include <librustzcash.h>
 
+#include <condition_variable>
 #include <stdarg.h>
 #include <thread>
 
@@ -621,7 +622,17 @@ const fs::path &ZC_GetParamsDir()
     return path;
 }
 
+// Sapling parameters loaded in the background
+static Mutex csZKSNARKS;
+static std::condition_variable condZKSNARKS;
+static bool fZKSNARKSLoading GUARDED_BY(csZKSNARKS) = false;
+
 void initZKSNARKS()
+{
+    initZKSNARKSTask()();
+}
+
+std::function<void()> initZKSNARKSTask()
 {
     const fs::path& path = ZC_GetParamsDir();
     fs::path sapling_spend = path / "sapling-spend.params";
@@ -673,24 +684,39 @@ void initZKSNARKS()
     static_assert(
         sizeof(fs::path::value_type) == sizeof(codeunit),
         "librustzcash not configured correctly");
-    auto sapling_spend_str = sapling_spend.native();
-    auto sapling_output_str = sapling_output.native();
-
-    //LogPrintf("Loading Sapling (Spend) parameters from %s\n", sapling_spend.string().c_str());
-
-    librustzcash_init_zksnark_params(
-        reinterpret_cast<const codeunit*>(sapling_spend_str.c_str()),
-        sapling_spend_str.length(),
-        "8270785a1a0d0bc77196f000ee6d221c9c9894f55307bd9357c3f0105d31ca63991ab91324160d8f53e2bbd3c2633a6eb8bdf5205d822e7f3f73edac51b2b70c",
-        reinterpret_cast<const codeunit*>(sapling_output_str.c_str()),
-        sapling_output_str.length(),
-        "657e3d38dbb5cb5e7dd2970e8b03d69b4787dd907285b5a7f0790dcc8072f60bf593b32cc2d1c030e00ff5ae64bf84c5c3beb84ddc841d48264b4a171744d028",
-        nullptr,    // sprout_path
-        0,          // sprout_path_len
-        ""          // sprout_hash
-    );
-
-    //std::cout << "### Sapling params initialized ###" << std::endl;
+
+    WITH_LOCK(csZKSNARKS, fZKSNARKSLoading = true);
+    return [sapling_spend, sapling_output]() {
+        const int64_t nTimeStart = GetTimeMillis();
+        auto sapling_spend_str = sapling_spend.native();
+        auto sapling_output_str = sapling_output.native();
+
+        librustzcash_init_zksnark_params(
+            reinterpret_cast<const codeunit*>(sapling_spend_str.c_str()),
+            sapling_spend_str.length(),
+            "8270785a1a0d0bc77196f000ee6d221c9c9894f55307bd9357c3f0105d31ca63991ab91324160d8f53e2bbd3c2633a6eb8bdf5205d822e7f3f73edac51b2b70c",
+            reinterpret_cast<const codeunit*>(sapling_output_str.c_str()),
+            sapling_output_str.length(),
+            "657e3d38dbb5cb5e7dd2970e8b03d69b4787dd907285b5a7f0790dcc8072f60bf593b32cc2d1c030e00ff5ae64bf84c5c3beb84ddc841d48264b4a171744d028",
+            nullptr,    // sprout_path
+            0,          // sprout_path_len
+            ""          // sprout_hash
+        );
+
+        LogPrintf("Loaded Sapling parameters in %dms\n", GetTimeMillis() - nTimeStart);
+        WITH_LOCK(csZKSNARKS, fZKSNARKSLoading = false);
+        condZKSNARKS.notify_all();
+    };
+}
+
+void WaitForZKSNARKS()
+{
+    WAIT_LOCK(csZKSNARKS, lock);
+    if (!fZKSNARKSLoading) return;
+    const int64_t nTimeStart = GetTimeMillis();
+    LogPrintf("Waiting for the Sapling parameters to be loaded...\n");
+    condZKSNARKS.wait(lock, []() EXCLUSIVE_LOCKS_REQUIRED(csZKSNARKS) { return !fZKSNARKSLoading; });
+    LogPrint(BCLog::BENCHMARK, "%s: waited %dms for the Sapling parameters\n", __func__, GetTimeMillis() - nTimeStart);
 }
 
 const fs::path &GetBlocksDir()
@@ -27,6 +27,7 @@
 
 #include <atomic>
 #include <exception>
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
@@ -106,6 +107,11 @@ bool CheckDataDirOption();
 const fs::path &ZC_GetParamsDir();
 // Init sapling library
 void initZKSNARKS();
+// Find the sapling parameters (throws if they are missing), and return the task loading them,
+// to run on a background thread. Until it completes, WaitForZKSNARKS blocks.
+std::function<void()> initZKSNARKSTask();
+// Wait for the sapling parameters, if they are being loaded in the background
+void WaitForZKSNARKS();
 void ClearDatadirCache();
 fs::path GetConfigFile(const std::string& confPath);
 fs::path GetGamemasterConfigFile();
@@ -25,6 +25,7 @@
 #include "evo/specialtx_validation.h"
 #include "flatfile.h"
 #include "guiinterface.h"
+#include "index/txindex.h"
 #include "interfaces/handler.h"
 #include "invalid.h"
 #include "kernel.h"
@@ -39,6 +40,7 @@
 #include "shutdown.h"
 #include "spork.h"
 #include "sporkdb.h"
+#include "stakeorigins.h"
 #include "tiertwo/tiertwo_sync_state.h"
 #include "txdb.h"
 #include "undo.h"
@@ -93,7 +95,6 @@ int64_t g_best_block_time = 0;
 int nScriptCheckThreads = 0;
 std::atomic<bool> fImporting{false};
 std::atomic<bool> fReindex{false};
-bool fTxIndex = true;
 bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
 size_t nCoinCacheUsage = 5000 * 300;
@@ -662,6 +663,24 @@ bool GetOutput(const uint256& hash, unsigned int index, CValidationState& state,
     return true;
 }
 
+bool FindTxInActiveChain(const uint256& hash, CTransactionRef& txOut, uint256& hashBlock, int nHeightFrom, int nHeightTo)
+{
+    LOCK(cs_main);
+    for (int nHeight = std::min(nHeightFrom, chainActive.Height()); nHeight >= std::max(nHeightTo, 0); nHeight--) {
+        const CBlockIndex* pindex = chainActive[nHeight];
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex)) continue;
+        for (const auto& tx : block.vtx) {
+            if (tx->GetHash() == hash) {
+                txOut = tx;
+                hashBlock = pindex->GetBlockHash();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 /** Return transaction in tx, and if it was found inside a block, its hash is placed in hashBlock */
 bool GetTransaction(const uint256& hash, CTransactionRef& txOut, uint256& hashBlock, bool fAllowSlow, CBlockIndex* blockIndex)
 {
@@ -677,28 +696,25 @@ bool GetTransaction(const uint256& hash, CTransactionRef& txOut, uint256& hashBl
             return true;
         }
 
-        if (fTxIndex) {
-            CDiskTxPos postx;
-            if (pblocktree->ReadTxIndex(hash, postx)) {
-                CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
-                if (file.IsNull())
-                    return error("%s: OpenBlockFile failed", __func__);
-                CBlockHeader header;
-                try {
-                    file >> header;
-                    fseek(file.Get(), postx.nTxOffset, SEEK_CUR);
-                    file >> txOut;
-                } catch (const std::exception& e) {
-                    return error("%s : Deserialize or I/O error - %s", __func__, e.what());
-                }
-                hashBlock = header.GetHash();
-                if (txOut->GetHash() != hash)
-                    return error("%s : txid mismatch", __func__);
+        if (g_txindex) {
+            if (g_txindex->FindTx(hash, hashBlock, txOut)) {
                 return true;
             }
 
-            // transaction not found in the index, nothing more can be done
-            return false;
+            // transaction not found in the index, nothing more can be done...
+            const CBlockIndex* pindexTip = chainActive.Tip();
+            const IndexSummary summary = g_txindex->GetSummary();
+            if (!pindexTip || summary.best_block_hash == pindexTip->GetBlockHash()) {
+                return false;
+            }
+            // ...unless the index didn't process the last blocks connected yet: look for it in those
+            const CBlockIndex* pindexIndexed = summary.synced ? LookupBlockIndex(summary.best_block_hash) : nullptr;
+            const CBlockIndex* pindexFork = pindexIndexed ? chainActive.FindFork(pindexIndexed) : nullptr;
+            if (pindexFork) {
+                return FindTxInActiveChain(hash, txOut, hashBlock, pindexTip->nHeight, pindexFork->nHeight + 1);
+            }
+            // ...or the index is still being built: look for it as without the index
+            fAllowSlow = true;
         }
 
         if (fAllowSlow) { // use coin database to locate block that contains transaction, and scan it
@@ -981,7 +997,7 @@ void static InvalidBlockFound(CBlockIndex* pindex, const CValidationState& state
     }
 }
 
-static bool SkipInvalidUTXOS(int nHeight)
+bool SkipInvalidUTXOS(int nHeight)
 {
     const Consensus::Params& consensus = Params().GetConsensus();
     return Params().NetworkIDString() == CBaseChainParams::MAIN &&
@@ -1188,6 +1204,8 @@ bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint25
     return true;
 }
 
+} // anon namespace
+
 bool UndoReadFromDisk(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& hashBlock)
 {
     // Open history file to read
@@ -1213,8 +1231,6 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const FlatFilePos& pos, const uint2
     return true;
 }
 
-} // anon namespace
-
 enum DisconnectResult
 {
     DISCONNECT_OK,      // All good.
@@ -1393,6 +1409,170 @@ void ThreadScriptCheck()
     scriptcheckqueue.Thread();
 }
 
+// Sapling proofs are verified before connecting the block (in ContextualCheckBlock), so these
+// threads are never busy together with the script checking ones.
+static CCheckQueue<SaplingValidation::CProofCheck> saplingcheckqueue(8);
+// Only one block can use the queue at a time
+static Mutex cs_saplingcheckqueue;
+
+void ThreadSaplingCheck()
+{
+    util::ThreadRename("Hemis-saplingch");
+    saplingcheckqueue.Thread();
+}
+
+std::vector<SaplingValidation::ProofCheckResult> CheckBlockSaplingProofs(const CBlock& block, int nHeight)
+{
+    std::vector<SaplingValidation::ProofCheckResult> vResults(block.vtx.size(), SaplingValidation::ProofCheckResult::UNCHECKED);
+    std::vector<SaplingValidation::CProofCheck> vChecks;
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        if (block.vtx[i]->IsShieldedTx()) {
+            vChecks.emplace_back(*block.vtx[i], nHeight, &vResults[i]);
+        }
+    }
+    if (vChecks.empty()) return vResults;
+
+    const int64_t nTimeStart = GetTimeMicros();
+    const size_t nChecks = vChecks.size();
+    bool fValid = true;
+    if (nScriptCheckThreads && nChecks > 1) {
+        LOCK(cs_saplingcheckqueue);
+        CCheckQueueControl<SaplingValidation::CProofCheck> control(&saplingcheckqueue);
+        control.Add(vChecks);
+        fValid = control.Wait();
+    } else {
+        for (auto& check : vChecks) {
+            if (!(fValid = check())) break;
+        }
+    }
+    LogPrint(BCLog::BENCHMARK, "    - Verify %u shielded txs: %.2fms [%s]\n",
+             nChecks, 0.001 * (GetTimeMicros() - nTimeStart), fValid ? "valid" : "invalid");
+    if (!fValid) {
+        for (size_t i = 0; i < vResults.size(); i++) {
+            const auto res = vResults[i];
+            if (res != SaplingValidation::ProofCheckResult::UNCHECKED && res != SaplingValidation::ProofCheckResult::VALID) {
+                LogPrintf("%s: invalid Sapling proofs/signatures (%d) in tx %s of block %s\n",
+                          __func__, (int)res, block.vtx[i]->GetHash().ToString(), block.GetHash().ToString());
+            }
+        }
+    }
+    return vResults;
+}
+
+/** Closure reading one coin from the coins database, for the prefetching threads */
+class CCoinsPrefetchCheck
+{
+private:
+    const CCoinsView* view{nullptr};
+    const COutPoint* pOutpoint{nullptr};
+    Coin* pCoin{nullptr};
+
+public:
+    CCoinsPrefetchCheck() = default;
+    CCoinsPrefetchCheck(const CCoinsView& viewIn, const COutPoint& outpoint, Coin* pCoinIn) : view(&viewIn), pOutpoint(&outpoint), pCoin(pCoinIn) {}
+
+    bool operator()()
+    {
+        try {
+            if (!view->GetCoin(*pOutpoint, *pCoin)) pCoin->Clear();
+        } catch (const std::exception& e) {
+            // Left to ConnectBlock, which reads the coin again
+            LogPrintf("%s: %s\n", __func__, e.what());
+            pCoin->Clear();
+        }
+        return true;
+    }
+
+    void swap(CCoinsPrefetchCheck& check)
+    {
+        std::swap(view, check.view);
+        std::swap(pOutpoint, check.pOutpoint);
+        std::swap(pCoin, check.pCoin);
+    }
+};
+
+// Used with cs_main held, so never busy together with the script checking threads.
+// The reads wait on the disk: smaller batches spread them better over the threads.
+static CCheckQueue<CCoinsPrefetchCheck> prefetchcheckqueue(16);
+static CoinsPrefetchStats coinsPrefetchStats GUARDED_BY(cs_main);
+
+void ThreadCoinsPrefetch()
+{
+    util::ThreadRename("Hemis-prefetch");
+    prefetchcheckqueue.Thread();
+}
+
+CoinsPrefetchStats GetCoinsPrefetchStats()
+{
+    return WITH_LOCK(cs_main, return coinsPrefetchStats);
+}
+
+/**
+ * Load the coins spent by the given blocks (consecutive, in connection order) in the UTXO cache,
+ * reading those that are not in it from the coins database in parallel. This way ConnectBlock
+ * finds them in memory, instead of waiting for one random database read after the other.
+ * Coins created by the blocks themselves are skipped.
+ */
+static void PrefetchBlockInputs(const std::vector<std::shared_ptr<const CBlock>>& vBlocks) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+    const int64_t nTimeStart = GetTimeMicros();
+    std::unordered_set<uint256, SaltedIdHasher> setCreated;
+    std::vector<COutPoint> vOutPoints;
+    int64_t nInputs = 0, nCacheHits = 0;
+    for (const auto& pblock : vBlocks) {
+        for (const CTransactionRef& tx : pblock->vtx) {
+            if (!tx->IsCoinBase() && !tx->HasZerocoinSpendInputs()) {
+                for (const CTxIn& in : tx->vin) {
+                    if (setCreated.count(in.prevout.hash)) continue;
+                    nInputs++;
+                    if (pcoinsTip->HaveCoinInCache(in.prevout)) {
+                        nCacheHits++;
+                    } else {
+                        vOutPoints.emplace_back(in.prevout);
+                    }
+                }
+            }
+            setCreated.insert(tx->GetHash());
+        }
+    }
+
+    // Read them from the database below the cache: what is not in the cache is up to date there
+    std::vector<Coin> vCoins(vOutPoints.size());
+    std::vector<CCoinsPrefetchCheck> vChecks;
+    vChecks.reserve(vOutPoints.size());
+    for (size_t i = 0; i < vOutPoints.size(); i++) {
+        vChecks.emplace_back(*pcoinsdbview, vOutPoints[i], &vCoins[i]);
+    }
+    if (nScriptCheckThreads && vChecks.size() > 1) {
+        CCheckQueueControl<CCoinsPrefetchCheck> control(&prefetchcheckqueue);
+        control.Add(vChecks);
+        control.Wait();
+    } else {
+        for (auto& check : vChecks) check();
+    }
+
+    int64_t nFetched = 0;
+    for (size_t i = 0; i < vOutPoints.size(); i++) {
+        // Not added if not found, or spent twice (by an invalid block)
+        if (pcoinsTip->AddFetchedCoin(vOutPoints[i], std::move(vCoins[i]))) nFetched++;
+    }
+
+    const int64_t nTime = GetTimeMicros() - nTimeStart;
+    CoinsPrefetchStats& stats = coinsPrefetchStats;
+    stats.nBlocks += vBlocks.size();
+    stats.nInputs += nInputs;
+    stats.nCacheHits += nCacheHits;
+    stats.nFetched += nFetched;
+    stats.nMissing += vOutPoints.size() - nFetched;
+    stats.nTotalMicros += nTime;
+    stats.nLastInputs = nInputs;
+    stats.nLastCacheHits = nCacheHits;
+    stats.nLastFetched = nFetched;
+    LogPrint(BCLog::BENCHMARK, "  - Prefetch %u inputs of %u blocks: %.2fms, %u in cache, %u read [%.2fs]\n",
+             (unsigned int)nInputs, (unsigned int)vBlocks.size(), nTime * 0.001, (unsigned int)nCacheHits, (unsigned int)nFetched, stats.nTotalMicros * 0.000001);
+}
+
 static int64_t nTimeVerify = 0;
 static int64_t nTimeProcessSpecial = 0;
 static int64_t nTimeConnect = 0;
@@ -1401,8 +1581,9 @@ static int64_t nTimeTotal = 0;
 
 /** Apply the effects of this block (with given index) on the UTXO set represented by coins.
  *  Validity checks that depend on the UTXO set are also done; ConnectBlock()
- *  can fail if those validity checks fail (among other reasons). */
-static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex, CCoinsViewCache& view, bool fJustCheck = false) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+ *  can fail if those validity checks fail (among other reasons).
+ *  If pblockundoRet is not null, it's set to the undo data of the block (unless fJustCheck). */
+static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex, CCoinsViewCache& view, bool fJustCheck = false, CBlockUndo* pblockundoRet = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
     AssertLockHeld(cs_main);
     // Check it again in case a previous version let a bad block in
@@ -1491,10 +1672,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     CAmount nFees = 0;
     int nInputs = 0;
     unsigned int nSigOps = 0;
-    CDiskTxPos pos(pindex->GetBlockPos(), GetSizeOfCompactSize(block.vtx.size()));
-    std::vector<std::pair<uint256, CDiskTxPos> > vPos;
     std::vector<std::pair<CBigNum, uint256> > vSpends;
-    vPos.reserve(block.vtx.size());
     CBlockUndo blockundo;
     blockundo.vtxundo.reserve(block.vtx.size() - 1);
     CAmount nValueOut = 0;
@@ -1581,9 +1759,6 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
                 sapling_tree.append(outputDescription.cmu);
             }
         }
-
-        vPos.emplace_back(tx.GetHash(), pos);
-        pos.nTxOffset += ::GetSerializeSize(tx, CLIENT_VERSION);
     }
 
     // Push new tree anchor
@@ -1670,15 +1845,14 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         pindex->RaiseValidity(BLOCK_VALID_SCRIPTS);
         setDirtyBlockIndex.insert(pindex);
     }
+    if (pblockundoRet) {
+        *pblockundoRet = std::move(blockundo);
+    }
 
     // Flush spend/mint info to disk
     if (!vSpends.empty() && !zerocoinDB->WriteCoinSpendBatch(vSpends))
         return AbortNode(state, "Failed to record coin serials to database");
 
-    if (fTxIndex)
-        if (!pblocktree->WriteTxIndex(vPos))
-            return AbortNode(state, "Failed to write transaction index");
-
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
     evoDb->WriteBestBlock(pindex->GetBlockHash());
@@ -1724,6 +1898,10 @@ bool static FlushStateToDisk(CValidationState& state, FlushStateMode mode)
     static int64_t nLastFlush = 0;
     static int64_t nLastSetChain = 0;
     try {
+        // A background write of the coins cache failed
+        if (pcoinsdbview && pcoinsdbview->GetFlushStats().fFailed) {
+            return AbortNode(state, "Failed to write to coin database");
+        }
         int64_t nNow = GetTimeMicros();
         // Avoid writing/flushing immediately after startup.
         if (nLastWrite == 0) {
@@ -1796,8 +1974,12 @@ bool static FlushStateToDisk(CValidationState& state, FlushStateMode mode)
                 return AbortNode(state, "Disk space is low!", _("Error: Disk space is low!"));
             }
             // Flush the chainstate (which may refer to block index entries).
+            // With -backgroundflush, it is written by the coins database thread, except
+            // when everything must be on disk on return.
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
+            if (mode == FLUSH_STATE_ALWAYS && !pcoinsdbview->WaitForFlush())
+                return AbortNode(state, "Failed to write to coin database");
             if (!evoDb->CommitRootTransaction()) {
                 return AbortNode(state, "Failed to commit EvoDB");
             }
@@ -1908,6 +2090,7 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
         assert(flushed);
         dbTx->Commit();
     }
+    g_stake_origins.BlockDisconnected(pindexDelete->nHeight);
     LogPrint(BCLog::BENCHMARK, "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
     const uint256& saplingAnchorAfterDisconnect = pcoinsTip->GetBestAnchor();
     // Write the chain state to disk, if necessary.
@@ -2031,7 +2214,8 @@ bool static ConnectTip(CValidationState& state, CBlockIndex* pindexNew, const st
         auto dbTx = evoDb->BeginTransaction();
 
         CCoinsViewCache view(pcoinsTip.get());
-        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, false);
+        CBlockUndo blockundo;
+        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, false, &blockundo);
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
             if (state.IsInvalid())
@@ -2044,6 +2228,7 @@ bool static ConnectTip(CValidationState& state, CBlockIndex* pindexNew, const st
         bool flushed = view.Flush();
         assert(flushed);
         dbTx->Commit();
+        g_stake_origins.BlockConnected(blockConnecting, blockundo, pindexNew->nHeight);
     }
     int64_t nTime4 = GetTimeMicros();
     nTimeFlush += nTime4 - nTime3;
@@ -2154,6 +2339,55 @@ static void PruneBlockIndexCandidates()
     assert(!setBlockIndexCandidates.empty());
 }
 
+/** Blocks read during the initial block download, to prefetch the inputs of a few at once */
+static const size_t COINS_PREFETCH_BLOCKS = 8;
+
+/**
+ * Blocks read ahead of their connection, with their inputs prefetched already. Kept across
+ * ActivateBestChainStep calls, which usually connect one block each.
+ */
+static std::deque<std::pair<const CBlockIndex*, std::shared_ptr<const CBlock>>> blocksAhead GUARDED_BY(cs_main);
+
+/**
+ * Return the block vpindexToConnect[nPos], the next one to connect, with its inputs prefetched.
+ * It is read with the following ones (going down vpindexToConnect) in IBD.
+ * Returns nullptr, with state set, if a block could not be read.
+ */
+static std::shared_ptr<const CBlock> ReadBlockAhead(CValidationState& state, const std::vector<CBlockIndex*>& vpindexToConnect, size_t nPos,
+                                                    const CBlockIndex* pindexMostWork, const std::shared_ptr<const CBlock>& pblock) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+    if (!blocksAhead.empty() && blocksAhead.front().first == vpindexToConnect[nPos]) {
+        std::shared_ptr<const CBlock> ret = std::move(blocksAhead.front().second);
+        blocksAhead.pop_front();
+        return ret;
+    }
+    // Not the expected block (a new best chain, or an invalid block): read again
+    blocksAhead.clear();
+
+    const size_t nBlocks = std::min(IsInitialBlockDownload() ? COINS_PREFETCH_BLOCKS : 1, nPos + 1);
+    std::vector<std::shared_ptr<const CBlock>> vBlocks;
+    vBlocks.reserve(nBlocks);
+    for (size_t i = 0; i < nBlocks; i++) {
+        const CBlockIndex* pindex = vpindexToConnect[nPos - i];
+        if (pblock && pindex == pindexMostWork) {
+            vBlocks.emplace_back(pblock);
+            continue;
+        }
+        std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
+        if (!ReadBlockFromDisk(*pblockNew, pindex)) {
+            AbortNode(state, "Failed to read block");
+            return nullptr;
+        }
+        vBlocks.emplace_back(std::move(pblockNew));
+    }
+    PrefetchBlockInputs(vBlocks);
+    for (size_t i = 1; i < nBlocks; i++) {
+        blocksAhead.emplace_back(vpindexToConnect[nPos - i], vBlocks[i]);
+    }
+    return vBlocks[0];
+}
+
 /**
  * Try to make some progress towards making pindexMostWork the active block.
  * pblock is either nullptr or a pointer to a CBlock corresponding to pindexMostWork.
@@ -2200,8 +2434,10 @@ static bool ActivateBestChainStep(CValidationState& state, CBlockIndex* pindexMo
         nHeight = nTargetHeight;
 
         // Connect new blocks.
-        for (CBlockIndex* pindexConnect : reverse_iterate(vpindexToConnect)) {
-            if (!ConnectTip(state, pindexConnect, (pindexConnect == pindexMostWork) ? pblock : std::shared_ptr<const CBlock>(), connectTrace, disconnectpool)) {
+        for (size_t nPos = vpindexToConnect.size(); nPos-- > 0;) {
+            CBlockIndex* pindexConnect = vpindexToConnect[nPos];
+            const std::shared_ptr<const CBlock> pblockConnect = ReadBlockAhead(state, vpindexToConnect, nPos, pindexMostWork, pblock);
+            if (!pblockConnect || !ConnectTip(state, pindexConnect, pblockConnect, connectTrace, disconnectpool)) {
                 if (state.IsInvalid()) {
                     // The block violates a consensus rule.
                     if (!state.CorruptionPossible()) {
@@ -2935,13 +3171,7 @@ bool ContextualCheckBlock(const CBlock& block, CValidationState& state, CBlockIn
     const CChainParams& chainparams = Params();
 
     // Check that all transactions are finalized
-    for (const auto& tx : block.vtx) {
-
-        // Check transaction contextually against consensus rules at block height
-        if (!ContextualCheckTransaction(tx, state, chainparams, nHeight, true /* isMined */, IsInitialBlockDownload())) {
-            return false;
-        }
-
+    for (const CTransactionRef& tx : block.vtx) {
         if (!IsFinalTx(tx, nHeight, block.GetBlockTime())) {
             return state.DoS(10, false, REJECT_INVALID, "bad-txns-nonfinal", false, "non-final transaction");
         }
@@ -2971,6 +3201,22 @@ bool ContextualCheckBlock(const CBlock& block, CValidationState& state, CBlockIn
         }
     }
 
+    // Verify the Sapling proofs of the whole block at once, only after the cheap checks
+    // passed (the failures are reported, in block order, by ContextualCheckTransaction)
+    std::vector<SaplingValidation::ProofCheckResult> vSaplingResults;
+    if (chainparams.GetConsensus().NetworkUpgradeActive(nHeight, Consensus::UPGRADE_V5_0)) {
+        vSaplingResults = CheckBlockSaplingProofs(block, nHeight);
+    } else {
+        vSaplingResults.resize(block.vtx.size(), SaplingValidation::ProofCheckResult::UNCHECKED);
+    }
+
+    // Check the transactions contextually against consensus rules at block height
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        if (!ContextualCheckTransaction(block.vtx[i], state, chainparams, nHeight, true /* isMined */, IsInitialBlockDownload(), vSaplingResults[i])) {
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -3603,10 +3849,6 @@ bool static LoadBlockIndexDB(std::string& strError) EXCLUSIVE_LOCKS_REQUIRED(cs_
     pblocktree->ReadReindexing(fReindexing);
     if (fReindexing) fReindex = true;
 
-    // Check whether we have a transaction index
-    pblocktree->ReadFlag("txindex", fTxIndex);
-    LogPrintf("LoadBlockIndexDB(): transaction index %s\n", fTxIndex ? "enabled" : "disabled");
-
     // If this is written true before the next client init, then we know the shutdown process failed
     pblocktree->WriteFlag("shutdown", false);
 
@@ -3857,6 +4099,7 @@ void UnloadBlockIndex()
 {
     LOCK(cs_main);
     setBlockIndexCandidates.clear();
+    blocksAhead.clear();
     chainActive.SetTip(nullptr);
     pindexBestInvalid = nullptr;
     pindexBestHeader = nullptr;
@@ -3893,9 +4136,6 @@ bool LoadBlockIndex(std::string& strError)
         // needs_init.
 
         LogPrintf("Initializing databases...\n");
-        // Use the provided setting for -txindex in the new database
-        fTxIndex = gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX);
-        pblocktree->WriteFlag("txindex", fTxIndex);
     }
     return true;
 }
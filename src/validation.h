@@ -22,6 +22,7 @@
 #include "fs.h"
 #include "moneysupply.h"
 #include "policy/feerate.h"
+#include "sapling/sapling_validation.h"
 #include "script/script_error.h"
 #include "sync.h"
 #include "txmempool.h"
@@ -40,6 +41,7 @@
 class AccumulatorCache;
 class CBlockIndex;
 class CBlockTreeDB;
+class CBlockUndo;
 class CBudgetManager;
 class CCoinsViewDB;
 class CZerocoinDB;
@@ -66,8 +68,6 @@ static const unsigned int DEFAULT_DESCENDANT_LIMIT = 25;
 static const unsigned int DEFAULT_DESCENDANT_SIZE_LIMIT = 101;
 /** Default for -mempoolexpiry, expiration time for mempool transactions in hours */
 static const unsigned int DEFAULT_MEMPOOL_EXPIRY = 72;
-/** Default for -txindex */
-static const bool DEFAULT_TXINDEX = true;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
 /** The maximum size for transactions we're willing to relay/mine */
 static const unsigned int MAX_STANDARD_TX_SIZE = 100000;
@@ -111,6 +111,8 @@ static constexpr std::chrono::seconds AVG_ADDRESS_BROADCAST_INTERVAL{30};
 static const unsigned int DEFAULT_SHIELDEDTXFEE_K = 100;
 /** Enable bloom filter */
  static const bool DEFAULT_PEERBLOOMFILTERS = true;
+/** Serve compact block filters (BIP 157) */
+static const bool DEFAULT_PEERBLOCKFILTERS = false;
 /** If the tip is older than this (in seconds), the node is considered to be in initial block download. */
 static const int64_t DEFAULT_MAX_TIP_AGE = 24 * 60 * 60;
 /** Maximum age of our tip in seconds for us to be considered current for fee estimation */
@@ -140,7 +142,6 @@ extern int64_t g_best_block_time;
 extern std::atomic<bool> fImporting;
 extern std::atomic<bool> fReindex;
 extern int nScriptCheckThreads;
-extern bool fTxIndex;
 extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
 extern size_t nCoinCacheUsage;
@@ -196,9 +197,42 @@ void UnloadBlockIndex();
 int ActiveProtocol();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the Sapling proofs checking thread (one for each script checking thread) */
+void ThreadSaplingCheck();
+/**
+ * Verify the Sapling proofs and signatures of all the shielded transactions of a block (at height
+ * nHeight) at once, spread over the check threads (or serially if there are none).
+ * Returns the outcome for each transaction, in block order (UNCHECKED for the transparent ones,
+ * and for those skipped after a failure).
+ */
+std::vector<SaplingValidation::ProofCheckResult> CheckBlockSaplingProofs(const CBlock& block, int nHeight);
+/** Run an instance of the coins prefetching thread (one for each script checking thread) */
+void ThreadCoinsPrefetch();
+
+/** Inputs of the connected blocks, read from the coins database ahead of ConnectBlock */
+struct CoinsPrefetchStats {
+    int64_t nBlocks{0};
+    //! Inputs spending coins created before the prefetched blocks
+    int64_t nInputs{0};
+    //! Already in the UTXO cache
+    int64_t nCacheHits{0};
+    //! Read from the database
+    int64_t nFetched{0};
+    //! Not in the database: the block is invalid, or the read failed
+    int64_t nMissing{0};
+    //! The same counts, for the last prefetch (of one block, or a few of them in IBD)
+    int64_t nLastInputs{0};
+    int64_t nLastCacheHits{0};
+    int64_t nLastFetched{0};
+    int64_t nTotalMicros{0};
+};
+CoinsPrefetchStats GetCoinsPrefetchStats();
 
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
+/** Look for a transaction in the blocks of the active chain from nHeightFrom back to nHeightTo (both included).
+ *  Each block is read from disk: keep the range short. */
+bool FindTxInActiveChain(const uint256& hash, CTransactionRef& txOut, uint256& hashBlock, int nHeightFrom, int nHeightTo);
 /** Retrieve a transaction (from memory pool, or from disk, if possible) */
 bool GetTransaction(const uint256& hash, CTransactionRef& tx, uint256& hashBlock, bool fAllowSlow = false, CBlockIndex* blockIndex = nullptr);
 /** Retrieve an output (from memory pool, or from disk, if possible) */
@@ -253,6 +287,9 @@ CAmount GetShieldedTxMinFee(const CTransaction& tx);
  */
 bool CheckInputs(const CTransaction& tx, CValidationState& state, const CCoinsViewCache& view, bool fScriptChecks, unsigned int flags, bool cacheStore, PrecomputedTransactionData& precomTxData, std::vector<CScriptCheck>* pvChecks = nullptr);
 
+/** Whether the banned outputs (invalid_out) created at this height are left out of the UTXO set */
+bool SkipInvalidUTXOS(int nHeight);
+
 /** Apply the effects of this transaction on the UTXO set represented by view */
 void UpdateCoins(const CTransaction& tx, CCoinsViewCache& inputs, int nHeight, bool fSkipInvalid = false);
 
@@ -313,6 +350,7 @@ public:
 bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos);
 bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex);
+bool UndoReadFromDisk(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& hashBlock);
 
 
 /** Functions for validating blocks and updating the block tree */
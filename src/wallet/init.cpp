@@ -25,7 +25,9 @@ std::string GetWalletHelpString(bool showDebug)
     strUsage += HelpMessageOpt("-mintxfee=<amt>", strprintf("Fees (in %s/Kb) smaller than this are considered zero fee for transaction creation (default: %s)", CURRENCY_UNIT, FormatMoney(CWallet::minTxFee.GetFeePerK())));
     strUsage += HelpMessageOpt("-paytxfee=<amt>", strprintf("Fee (in %s/kB) to add to transactions you send (default: %s)", CURRENCY_UNIT, FormatMoney(payTxFee.GetFeePerK())));
     strUsage += HelpMessageOpt("-rescan", "Rescan the block chain for missing wallet transactions on startup");
+    strUsage += HelpMessageOpt("-rescanthreads=<n>", strprintf("Set the number of threads, shared by all the wallets, used to match the blocks with the wallet keys during a rescan (<= 0 = all cores, default: %d)", DEFAULT_RESCAN_THREADS));
     strUsage += HelpMessageOpt("-salvagewallet", "Attempt to recover private keys from a corrupt wallet file on startup");
+    strUsage += HelpMessageOpt("-saplingdecryptthreads=<n>", strprintf("Set the number of threads used by each wallet to find its notes in the shielded outputs (<= 0 = all cores, default: %d)", DEFAULT_SAPLING_DECRYPT_THREADS));
     strUsage += HelpMessageOpt("-spendzeroconfchange", strprintf("Spend unconfirmed change when sending transactions (default: %u)", DEFAULT_SPEND_ZEROCONF_CHANGE));
     strUsage += HelpMessageOpt("-txconfirmtarget=<n>", strprintf("If paytxfee is not set, include enough fee so transactions begin confirmation on average within n blocks (default: %u)", 1));
     strUsage += HelpMessageOpt("-upgradewallet", "Upgrade wallet to latest format on startup");
@@ -40,6 +42,7 @@ std::string GetWalletHelpString(bool showDebug)
     strUsage += HelpMessageOpt("-genproclimit=<n>", strprintf("Set the number of threads for coin generation if enabled (-1 = all cores, default: %d)", DEFAULT_GENERATE_PROCLIMIT));
     strUsage += HelpMessageOpt("-minstakesplit=<amt>", strprintf("Minimum positive amount (in HMS) allowed by GUI and RPC for the stake split threshold (default: %s)", FormatMoney(DEFAULT_MIN_STAKE_SPLIT_THRESHOLD)));
     strUsage += HelpMessageOpt("-staking=<n>", strprintf("Enable staking functionality (0-1, default: %u)", DEFAULT_STAKING));
+    strUsage += HelpMessageOpt("-stakingthreads=<n>", strprintf("Set the number of threads used to search for a stake kernel (<= 0 = all cores, default: %d)", DEFAULT_STAKING_THREADS));
     if (showDebug) {
         strUsage += HelpMessageGroup("Wallet debugging/testing options:");
         strUsage += HelpMessageOpt("-dblogsize=<n>", strprintf("Flush database activity from memory pool to disk log every <n> megabytes (default: %u)", DEFAULT_WALLET_DBLOGSIZE));
@@ -26,6 +26,7 @@
 #include "spork.h"
 #include "timedata.h"
 #include "utilmoneystr.h"
+#include "wallet/stakescheduler.h"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "wallet/walletutil.h"
@@ -4282,6 +4283,23 @@ UniValue getwalletinfo(const JSONRPCRequest& request)
             "  \"paytxfee\": x.xxxx                       (numeric) the transaction fee configuration, set in HMS/kB\n"
             "  \"hdseedid\": \"<hash160>\"                (string, optional) the Hash160 of the HD seed (only present when HD is enabled)\n"
             "  \"last_processed_block\": xxxxx,          (numeric) the last block processed block height\n"
+            "  \"scanning\":                             (json object) current scanning details, or false if no scan is in progress\n"
+            "  {\n"
+            "    \"duration\" : xxxx,                    (numeric) elapsed seconds since scan start\n"
+            "    \"progress\" : x.xxxx,                  (numeric) scanning progress percentage [0.0, 1.0]\n"
+            "    \"height\" : xxxx,                      (numeric) height of the last block scanned\n"
+            "    \"blocks\" : xxxx,                      (numeric) number of blocks scanned\n"
+            "    \"blocks_per_second\" : x.xx,           (numeric) average scanning throughput\n"
+            "  }\n"
+            "  \"sapling_trial_decryption\": {           (json object) throughput of the search of the wallet notes in the shielded outputs\n"
+            "    \"threads\": n,                         (numeric) number of threads trying the viewing keys\n"
+            "    \"txes\": n,                            (numeric) number of shielded transactions scanned since startup\n"
+            "    \"outputs\": n,                         (numeric) number of shielded outputs scanned since startup\n"
+            "    \"trials\": n,                          (numeric) number of (output, viewing key) decryption attempts\n"
+            "    \"notes\": n,                           (numeric) number of wallet notes found\n"
+            "    \"time_ms\": n,                         (numeric) total time spent in the trial decryption, in milliseconds\n"
+            "    \"trials_per_second\": n                (numeric) average decryption attempts per second\n"
+            "  }\n"
             "}\n"
 
             "\nExamples:\n" +
@@ -4331,6 +4349,31 @@ UniValue getwalletinfo(const JSONRPCRequest& request)
         obj.pushKV("unlocked_until", pwallet->nRelockTime);
     obj.pushKV("paytxfee", ValueFromAmount(payTxFee.GetFeePerK()));
     obj.pushKV("last_processed_block", pwallet->GetLastBlockHeight());
+    if (pwallet->IsScanning()) {
+        const int64_t nDuration = pwallet->ScanningDuration();
+        const int64_t nBlocks = pwallet->ScannedBlocks();
+        UniValue scanning(UniValue::VOBJ);
+        scanning.pushKV("duration", nDuration / 1000);
+        scanning.pushKV("progress", pwallet->ScanningProgress());
+        scanning.pushKV("height", pwallet->ScanningHeight());
+        scanning.pushKV("blocks", nBlocks);
+        scanning.pushKV("blocks_per_second", nDuration > 0 ? nBlocks * 1000.0 / nDuration : 0.0);
+        obj.pushKV("scanning", scanning);
+    } else {
+        obj.pushKV("scanning", false);
+    }
+
+    // Trial decryption throughput
+    const auto& decStats = pwallet->GetSaplingScriptPubKeyMan()->GetTrialDecryptionStats();
+    UniValue decObj(UniValue::VOBJ);
+    decObj.pushKV("threads", decStats.nThreads);
+    decObj.pushKV("txes", (int64_t)decStats.nTxs);
+    decObj.pushKV("outputs", (int64_t)decStats.nOutputs);
+    decObj.pushKV("trials", (int64_t)decStats.nTrials);
+    decObj.pushKV("notes", (int64_t)decStats.nNotes);
+    decObj.pushKV("time_ms", decStats.nMicros / 1000);
+    decObj.pushKV("trials_per_second", decStats.nMicros > 0 ? (int64_t)(decStats.nTrials * 1000000 / decStats.nMicros) : 0);
+    obj.pushKV("sapling_trial_decryption", decObj);
     return obj;
 }
 
@@ -4428,6 +4471,71 @@ UniValue getstakingstatus(const JSONRPCRequest& request)
     }
 }
 
+UniValue getstakeschedule(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp))
+        return NullUniValue;
+
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getstakeschedule\n"
+            "\nReturns the time slots, computed in advance on top of the current tip, in which the stakeable coins\n"
+            "meet the kernel target, and the latency between the start of a time slot and the submission of the block staked in it.\n"
+
+            "\nResult:\n"
+            "{\n"
+            "  \"tip_hash\": xxx             (hex string) hash of the block on top of which the schedule was computed\n"
+            "  \"tip_height\": n             (numeric) height of the block on top of which the schedule was computed\n"
+            "  \"coins\": n                  (numeric) number of stakeable coins hashed\n"
+            "  \"window_start\": n           (numeric) first time slot searched\n"
+            "  \"window_end\": n             (numeric) last time slot searched\n"
+            "  \"compute_time_ms\": n        (numeric) milliseconds spent computing the schedule\n"
+            "  \"schedule\": [               (array) scheduled stakes, ordered by time slot\n"
+            "    {\n"
+            "      \"time\": n               (numeric) time slot of the kernel\n"
+            "      \"txid\": \"xxx\"          (string) transaction id of the stake input\n"
+            "      \"vout\": n               (numeric) output index of the stake input\n"
+            "      \"amount\": x.xxx         (numeric) value of the stake input in HMS\n"
+            "    }\n"
+            "    ,...\n"
+            "  ],\n"
+            "  \"blocks_submitted\": n       (numeric) number of blocks staked since startup\n"
+            "  \"last_latency_ms\": n        (numeric) slot-to-submission latency of the last block staked\n"
+            "  \"average_latency_ms\": n     (numeric) average slot-to-submission latency\n"
+            "}\n"
+
+            "\nExamples:\n" +
+            HelpExampleCli("getstakeschedule", "") + HelpExampleRpc("getstakeschedule", ""));
+
+    if (!stakeScheduler)
+        throw JSONRPCError(RPC_MISC_ERROR, "Staking is disabled");
+
+    const CStakeScheduler::Stats stats = stakeScheduler->GetStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("tip_hash", stats.hashTip.GetHex());
+    obj.pushKV("tip_height", stats.nHeight);
+    obj.pushKV("coins", stats.nCoins);
+    obj.pushKV("window_start", stats.nWindowStart);
+    obj.pushKV("window_end", stats.nWindowEnd);
+    obj.pushKV("compute_time_ms", stats.nComputeMillis);
+    UniValue schedule(UniValue::VARR);
+    for (const CStakeScheduler::ScheduledStake& s : stats.vSchedule) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("time", s.nTime);
+        entry.pushKV("txid", s.outpoint.hash.GetHex());
+        entry.pushKV("vout", (int) s.outpoint.n);
+        entry.pushKV("amount", ValueFromAmount(s.nValue));
+        schedule.push_back(entry);
+    }
+    obj.pushKV("schedule", schedule);
+    obj.pushKV("blocks_submitted", stats.nBlocksSubmitted);
+    obj.pushKV("last_latency_ms", stats.nLastLatencyMillis);
+    obj.pushKV("average_latency_ms", stats.nBlocksSubmitted > 0 ? stats.nTotalLatencyMillis / stats.nBlocksSubmitted : 0);
+    return obj;
+}
+
 UniValue setstakesplitthreshold(const JSONRPCRequest& request)
 {
     CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
@@ -4757,6 +4865,7 @@ static const CRPCCommand commands[] =
     { "wallet",             "getunconfirmedbalance",    &getunconfirmedbalance,    false, {} },
     { "wallet",             "getwalletinfo",            &getwalletinfo,            false, {} },
     { "wallet",             "getstakingstatus",         &getstakingstatus,         false, {} },
+    { "wallet",             "getstakeschedule",         &getstakeschedule,         false, {} },
     { "wallet",             "importprivkey",            &importprivkey,            true,  {"privkey","label","rescan","is_staking_address"} },
     { "wallet",             "importwallet",             &importwallet,             true,  {"filename"} },
     { "wallet",             "importaddress",            &importaddress,            true,  {"address","label","rescan","p2sh"} },
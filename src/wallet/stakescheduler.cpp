@@ -0,0 +1,178 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "wallet/stakescheduler.h"
+
+#include "chainparams.h"
+#include "kernel.h"
+#include "pow.h"
+#include "timedata.h"
+#include "validation.h"
+#include "wallet/wallet.h"
+
+#include <boost/thread.hpp>
+
+std::unique_ptr<CStakeScheduler> stakeScheduler;
+
+static int64_t GetAdjustedTimeMillis()
+{
+    // same clock as GetCurrentTimeSlot (mockable)
+    return GetTime<std::chrono::milliseconds>().count() + GetTimeOffset() * 1000;
+}
+
+bool CStakeScheduler::CanSchedule(const CBlockIndex* pindexPrev)
+{
+    const Consensus::Params& consensus = Params().GetConsensus();
+    const int nHeight = pindexPrev->nHeight + 1;
+    // RegTest stakes with the adjusted time, not in time slots
+    return !Params().IsRegTestNet() &&
+           consensus.NetworkUpgradeActive(nHeight, Consensus::UPGRADE_V3_4) &&
+           consensus.IsTimeProtocolV2(nHeight);
+}
+
+void CStakeScheduler::Update(const CBlockIndex* pindexPrev, const std::vector<CStakeableOutput>& availableCoins)
+{
+    const int64_t nSlotLength = Params().GetConsensus().nTimeSlotLength;
+    const int64_t nCurrentSlot = GetCurrentTimeSlot();
+    uint64_t nCoinUpdatesStart;
+    {
+        LOCK(cs);
+        nCoinUpdatesStart = nCoinUpdates;
+        if (stats.hashTip == pindexPrev->GetBlockHash() && stats.nWindowEnd > nCurrentSlot &&
+                nCoinUpdatesScheduled == nCoinUpdatesStart) return;
+    }
+
+    const int64_t nTimeStart = GetTimeMillis();
+    const unsigned int nBits = GetNextWorkRequired(pindexPrev, nullptr);
+    const int64_t nWindowStart = nCurrentSlot + nSlotLength;
+    const int64_t nWindowEnd = nCurrentSlot + STAKE_LOOKAHEAD_SLOTS * nSlotLength;
+
+    std::vector<ScheduledStake> vSchedule;
+    for (const CStakeableOutput& coin : availableCoins) {
+        const CStakeKernel& kernel = coin.GetKernel(pindexPrev, nBits);
+        for (int64_t nTime = nWindowStart; nTime <= nWindowEnd; nTime += nSlotLength) {
+            if (nTime > pindexPrev->nTime && kernel.CheckKernelHashAtTime(nTime)) {
+                vSchedule.push_back({nTime, COutPoint(coin.tx->GetHash(), coin.i), coin.Value()});
+            }
+        }
+    }
+    std::stable_sort(vSchedule.begin(), vSchedule.end(),
+                     [](const ScheduledStake& a, const ScheduledStake& b) { return a.nTime < b.nTime; });
+
+    LOCK(cs);
+    nCoinUpdatesScheduled = nCoinUpdatesStart;
+    stats.hashTip = pindexPrev->GetBlockHash();
+    stats.nHeight = pindexPrev->nHeight;
+    stats.nCoins = (int) availableCoins.size();
+    stats.nWindowStart = nWindowStart;
+    stats.nWindowEnd = nWindowEnd;
+    stats.nComputeMillis = GetTimeMillis() - nTimeStart;
+    stats.vSchedule = std::move(vSchedule);
+    LogPrint(BCLog::STAKING, "%s: %d kernels found for %d coins on top of %s in slots %d-%d (%d ms)\n",
+             __func__, stats.vSchedule.size(), stats.nCoins, stats.hashTip.GetHex(),
+             stats.nWindowStart, stats.nWindowEnd, stats.nComputeMillis);
+}
+
+int64_t CStakeScheduler::WaitForNextSlot(const CBlockIndex* pindexPrev)
+{
+    const uint256& hashPrev = pindexPrev->GetBlockHash();
+    const int64_t nCurrentSlot = GetCurrentTimeSlot();
+    const int64_t nDeadlineMillis = GetTimeMillis() + STAKE_MAX_SLEEP_MILLIS;
+    uint64_t nTipUpdatesStart;
+    uint64_t nCoinUpdatesStart;
+    int64_t nTarget = nCurrentSlot + Params().GetConsensus().nTimeSlotLength;
+    {
+        LOCK(cs);
+        nTipUpdatesStart = nTipUpdates;
+        nCoinUpdatesStart = nCoinUpdates;
+        if (stats.hashTip == hashPrev) {
+            // Wake up at the end of the window if there is no kernel in it
+            nTarget = stats.nWindowEnd;
+            for (const ScheduledStake& s : stats.vSchedule) {
+                if (s.nTime > nCurrentSlot) {
+                    nTarget = s.nTime;
+                    break;
+                }
+            }
+        }
+    }
+
+    boost::this_thread::interruption_point();
+    // A new block came in (the later ones are notified)
+    if (WITH_LOCK(g_best_block_mutex, return g_best_block) != hashPrev) return 0;
+
+    WAIT_LOCK(cs, lock);
+    while (true) {
+        if (fInterrupted || nTipUpdates != nTipUpdatesStart || nCoinUpdates != nCoinUpdatesStart) return 0;
+        const int64_t nWaitMillis = nTarget * 1000 - GetAdjustedTimeMillis();
+        if (nWaitMillis <= 0) return nTarget;
+        // Don't sleep through the changes of the coins which aren't notified (e.g. the cold staking flags)
+        const int64_t nDeadlineWaitMillis = nDeadlineMillis - GetTimeMillis();
+        if (nDeadlineWaitMillis <= 0) return 0;
+        // Sleep until the slot or the deadline: the notifications (and spurious wakeups) are checked above
+        if (cond.wait_for(lock, std::chrono::milliseconds(std::min(nWaitMillis, nDeadlineWaitMillis))) == std::cv_status::timeout &&
+                nWaitMillis <= nDeadlineWaitMillis) {
+            return nTarget;
+        }
+    }
+}
+
+void CStakeScheduler::PrioritizeCoins(int64_t nTime, std::vector<CStakeableOutput>& availableCoins) const
+{
+    std::set<COutPoint> setScheduled;
+    {
+        LOCK(cs);
+        for (const ScheduledStake& s : stats.vSchedule) {
+            if (s.nTime == nTime) setScheduled.insert(s.outpoint);
+        }
+    }
+    if (setScheduled.empty()) return;
+
+    std::stable_partition(availableCoins.begin(), availableCoins.end(),
+                          [&setScheduled](const CStakeableOutput& coin) {
+                              return setScheduled.count(COutPoint(coin.tx->GetHash(), coin.i)) > 0;
+                          });
+}
+
+void CStakeScheduler::BlockSubmitted(int64_t nTime)
+{
+    const int64_t nLatency = GetAdjustedTimeMillis() - nTime * 1000;
+    LOCK(cs);
+    stats.nBlocksSubmitted++;
+    stats.nLastLatencyMillis = nLatency;
+    stats.nTotalLatencyMillis += nLatency;
+    LogPrint(BCLog::STAKING, "%s: block for time slot %d submitted after %d ms\n", __func__, nTime, nLatency);
+}
+
+CStakeScheduler::Stats CStakeScheduler::GetStats() const
+{
+    return WITH_LOCK(cs, return stats);
+}
+
+void CStakeScheduler::StakeableCoinsChanged()
+{
+    {
+        LOCK(cs);
+        nCoinUpdates++;
+    }
+    cond.notify_all();
+}
+
+void CStakeScheduler::Interrupt()
+{
+    {
+        LOCK(cs);
+        fInterrupted = true;
+    }
+    cond.notify_all();
+}
+
+void CStakeScheduler::UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload)
+{
+    {
+        LOCK(cs);
+        nTipUpdates++;
+    }
+    cond.notify_all();
+}
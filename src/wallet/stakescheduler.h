@@ -0,0 +1,102 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef Hemis_WALLET_STAKESCHEDULER_H
+#define Hemis_WALLET_STAKESCHEDULER_H
+
+#include "amount.h"
+#include "primitives/transaction.h"
+#include "sync.h"
+#include "uint256.h"
+#include "validationinterface.h"
+
+#include <condition_variable>
+#include <memory>
+#include <vector>
+
+class CBlockIndex;
+class CStakeableOutput;
+
+//! Number of time slots, after the current one, searched for a kernel on every new tip
+static const int STAKE_LOOKAHEAD_SLOTS = 40;
+//! Longest sleep of the staker, between two checks of its coins
+static const int64_t STAKE_MAX_SLEEP_MILLIS = 60 * 1000;
+
+/**
+ * Stake slot scheduler.
+ * With the stake modifier V2, every input of the kernel hash except the block time is fixed once
+ * the tip is known. So, on each new tip, the scheduler finds which of the stakeable coins meet the
+ * target in the upcoming time slots. The staker then sleeps until the first of those slots (or until
+ * the next tip notification, or a change of the stakeable coins), instead of polling and hashing all
+ * the coins again at every slot.
+ */
+class CStakeScheduler : public CValidationInterface
+{
+public:
+    struct ScheduledStake
+    {
+        int64_t nTime;
+        COutPoint outpoint;
+        CAmount nValue;
+    };
+
+    struct Stats
+    {
+        uint256 hashTip;
+        int nHeight{0};
+        int nCoins{0};
+        int64_t nWindowStart{0};
+        int64_t nWindowEnd{0};
+        int64_t nComputeMillis{0};
+        std::vector<ScheduledStake> vSchedule;
+        // slot to block submission latency
+        int nBlocksSubmitted{0};
+        int64_t nLastLatencyMillis{0};
+        int64_t nTotalLatencyMillis{0};
+    };
+
+    // Whether the kernels of the blocks on top of pindexPrev can be computed in advance
+    static bool CanSchedule(const CBlockIndex* pindexPrev);
+
+    // Compute the schedule of the coins on top of pindexPrev (unless it was already computed for the current
+    // window, and the stakeable coins didn't change since)
+    void Update(const CBlockIndex* pindexPrev, const std::vector<CStakeableOutput>& availableCoins);
+
+    // Sleep until the next scheduled time slot on top of pindexPrev, the end of the lookahead window,
+    // a new tip, a change of the stakeable coins, Interrupt(), or at most STAKE_MAX_SLEEP_MILLIS.
+    // Return the time slot reached, or 0 if woken up before it (the coins must be refreshed).
+    int64_t WaitForNextSlot(const CBlockIndex* pindexPrev);
+
+    // Wake up the staker: the stakeable coins changed (e.g. deposit, spend or coin unlock)
+    void StakeableCoinsChanged();
+
+    // Wake up the staker, and don't let it sleep any more (shutdown)
+    void Interrupt();
+
+    // Move the coins scheduled for the time slot nTime to the front of availableCoins
+    void PrioritizeCoins(int64_t nTime, std::vector<CStakeableOutput>& availableCoins) const;
+
+    // Record the submission of a block staked in the time slot nTime
+    void BlockSubmitted(int64_t nTime);
+
+    Stats GetStats() const;
+
+protected:
+    void UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload) override;
+
+private:
+    mutable Mutex cs;
+    std::condition_variable cond;
+    // number of tip notifications received
+    uint64_t nTipUpdates GUARDED_BY(cs){0};
+    // number of stakeable coins notifications received, and the one the schedule was computed at
+    uint64_t nCoinUpdates GUARDED_BY(cs){0};
+    uint64_t nCoinUpdatesScheduled GUARDED_BY(cs){0};
+    bool fInterrupted GUARDED_BY(cs){false};
+    Stats stats GUARDED_BY(cs);
+};
+
+extern std::unique_ptr<CStakeScheduler> stakeScheduler;
+
+#endif // Hemis_WALLET_STAKESCHEDULER_H
@@ -9,6 +9,7 @@
 #include "util/blockstatecatcher.h"
 #include "blocksignature.h"
 #include "consensus/merkle.h"
+#include "kernel.h"
 #include "primitives/block.h"
 #include "script/sign.h"
 #include "test/util/blocksutil.h"
@@ -438,4 +439,119 @@ BOOST_FIXTURE_TEST_CASE(created_on_fork_tests, TestPoSChainSetup)
     BOOST_CHECK(ProcessNewBlock(pblockI, nullptr));
 }
 
+// Stakeable outputs of the wallet, found walking the whole mapWallet
+static std::set<COutPoint> StakeableOutputsFullScan(CWallet* pwallet)
+{
+    std::set<COutPoint> res;
+    LOCK2(cs_main, pwallet->cs_wallet);
+    for (const auto& it : pwallet->mapWallet) {
+        const CWalletTx& wtx = it.second;
+        if (!wtx.IsTrusted() || wtx.GetBlocksToMaturity() > 0) continue;
+        if (wtx.GetDepthInMainChain() < Params().GetConsensus().nStakeMinDepth) continue;
+        for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+            const CTxOut& out = wtx.tx->vout[i];
+            if (out.nValue <= 0 || pwallet->IsSpent(it.first, i) || pwallet->IsLockedCoin(it.first, i)) continue;
+            if ((pwallet->IsMine(out) & ISMINE_SPENDABLE) == ISMINE_NO) continue;
+            res.emplace(it.first, i);
+        }
+    }
+    return res;
+}
+
+static std::set<COutPoint> StakeableOutputs(CWallet* pwallet)
+{
+    std::vector<CStakeableOutput> availableCoins;
+    pwallet->StakeableCoins(&availableCoins);
+    std::set<COutPoint> res;
+    for (const CStakeableOutput& coin : availableCoins) {
+        BOOST_CHECK(res.emplace(coin.tx->GetHash(), coin.i).second);
+    }
+    return res;
+}
+
+BOOST_FIXTURE_TEST_CASE(stakeable_outputs_index_tests, TestPoSChainSetup)
+{
+    SyncWithValidationInterfaceQueue();
+    std::set<COutPoint> stakeable = StakeableOutputs(pwalletMain.get());
+    BOOST_CHECK(!stakeable.empty());
+    BOOST_CHECK(stakeable == StakeableOutputsFullScan(pwalletMain.get()));
+
+    // Staking spends the coinstake input, and makes more outputs deep enough
+    std::vector<COutPoint> stakedInputs;
+    for (int i = 0; i < 5; i++) {
+        std::shared_ptr<CBlock> pblock = CreateBlockInternal(pwalletMain.get());
+        BOOST_CHECK(ProcessNewBlock(pblock, nullptr));
+        stakedInputs.emplace_back(pblock->vtx[1]->vin[0].prevout);
+        SyncWithValidationInterfaceQueue();
+        stakeable = StakeableOutputs(pwalletMain.get());
+        BOOST_CHECK(!stakeable.count(stakedInputs.back()));
+        BOOST_CHECK(stakeable == StakeableOutputsFullScan(pwalletMain.get()));
+    }
+
+    // Locked coins are skipped
+    const COutPoint lockedOut = *stakeable.begin();
+    WITH_LOCK(pwalletMain->cs_wallet, pwalletMain->LockCoin(lockedOut));
+    stakeable = StakeableOutputs(pwalletMain.get());
+    BOOST_CHECK(!stakeable.count(lockedOut));
+    BOOST_CHECK(stakeable == StakeableOutputsFullScan(pwalletMain.get()));
+    WITH_LOCK(pwalletMain->cs_wallet, pwalletMain->UnlockCoin(lockedOut));
+    BOOST_CHECK(StakeableOutputs(pwalletMain.get()).count(lockedOut));
+    WITH_LOCK(pwalletMain->cs_wallet, pwalletMain->LockCoin(lockedOut));
+    BOOST_CHECK(!StakeableOutputs(pwalletMain.get()).count(lockedOut));
+    WITH_LOCK(pwalletMain->cs_wallet, pwalletMain->UnlockAllCoins());
+    stakeable = StakeableOutputs(pwalletMain.get());
+    BOOST_CHECK(stakeable.count(lockedOut));
+    BOOST_CHECK(stakeable == StakeableOutputsFullScan(pwalletMain.get()));
+
+    // Disconnecting the last block makes its coinstake input stakeable again
+    {
+        LOCK(cs_main);
+        CValidationState state;
+        BOOST_CHECK(InvalidateBlock(state, Params(), chainActive.Tip()));
+    }
+    SyncWithValidationInterfaceQueue();
+    stakeable = StakeableOutputs(pwalletMain.get());
+    BOOST_CHECK(stakeable.count(stakedInputs.back()));
+    BOOST_CHECK(stakeable == StakeableOutputsFullScan(pwalletMain.get()));
+}
+
+BOOST_FIXTURE_TEST_CASE(parallel_kernel_search_tests, TestPoSChainSetup)
+{
+    SyncWithValidationInterfaceQueue();
+    const CBlockIndex* pindexPrev = WITH_LOCK(cs_main, return chainActive.Tip());
+    std::vector<CStakeableOutput> availableCoins;
+    BOOST_CHECK(pwalletMain->StakeableCoins(&availableCoins));
+    BOOST_REQUIRE(availableCoins.size() > 1);
+    // Same kernel time for all the searches
+    SetMockTime(GetTime());
+    pwalletMain->StartStakingWorkers(4);
+
+    // Harder and harder targets move the first kernel down the coins (and then past them)
+    const arith_uint256 bnLimit = UintToArith256(Params().GetConsensus().posLimitV2);
+    bool fKernelInMiddle = false;
+    for (int nShift = 0; nShift < 32; nShift++) {
+        const unsigned int nBits = arith_uint256(bnLimit >> nShift).GetCompact();
+        size_t nSerialPos = availableCoins.size();
+        for (size_t i = 0; i < availableCoins.size(); i++) {
+            int64_t nTime = 0;
+            if (Stake(pindexPrev, availableCoins[i].GetKernel(pindexPrev, nBits), nTime)) {
+                nSerialPos = i;
+                break;
+            }
+        }
+
+        size_t nPos = 0;
+        int64_t nTxNewTime = 0;
+        int nAttempts = 0;
+        BOOST_CHECK(pwalletMain->SearchStakeKernel(pindexPrev, nBits, availableCoins, nPos, nTxNewTime, nAttempts, false));
+        BOOST_CHECK_EQUAL(nPos, nSerialPos);
+        BOOST_CHECK((size_t) nAttempts >= std::min(nSerialPos + 1, availableCoins.size()));
+        BOOST_CHECK_EQUAL(nTxNewTime, GetTime());
+        fKernelInMiddle |= nSerialPos > 0 && nSerialPos < availableCoins.size();
+    }
+    BOOST_CHECK(fKernelInMiddle);
+
+    SetMockTime(0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,154 @@
+// Copyright (c) 2022 The Hemis Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include "wallet/test/pos_test_fixture.h"
+
+#include "kernel.h"
+#include "pow.h"
+#include "timedata.h"
+#include "wallet/stakescheduler.h"
+#include "wallet/wallet.h"
+
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(stakescheduler_tests)
+
+static std::vector<CStakeableOutput> GetStakeableCoins(CWallet* pwallet)
+{
+    std::vector<CStakeableOutput> availableCoins;
+    BOOST_CHECK(pwallet->StakeableCoins(&availableCoins));
+    return availableCoins;
+}
+
+BOOST_FIXTURE_TEST_CASE(stake_schedule_tests, TestPoSChainSetup)
+{
+    SyncWithValidationInterfaceQueue();
+    const CBlockIndex* pindexPrev = WITH_LOCK(cs_main, return chainActive.Tip());
+    const int64_t nSlotLength = Params().GetConsensus().nTimeSlotLength;
+    SetMockTime(GetTimeSlot(pindexPrev->GetBlockTime()) + 2 * nSlotLength);
+
+    CStakeScheduler scheduler;
+    const std::vector<CStakeableOutput> availableCoins = GetStakeableCoins(pwalletMain.get());
+    BOOST_CHECK(!availableCoins.empty());
+    scheduler.Update(pindexPrev, availableCoins);
+    CStakeScheduler::Stats stats = scheduler.GetStats();
+    BOOST_CHECK(stats.hashTip == pindexPrev->GetBlockHash());
+    BOOST_CHECK_EQUAL(stats.nCoins, (int) availableCoins.size());
+    BOOST_CHECK_EQUAL(stats.nWindowStart, GetCurrentTimeSlot() + nSlotLength);
+    BOOST_CHECK_EQUAL(stats.nWindowEnd, GetCurrentTimeSlot() + STAKE_LOOKAHEAD_SLOTS * nSlotLength);
+    BOOST_CHECK(!stats.vSchedule.empty());
+
+    // The schedule is sorted by time, and contains exactly the (coin, slot) pairs meeting the target
+    std::set<std::pair<int64_t, COutPoint>> setScheduled;
+    for (size_t i = 0; i < stats.vSchedule.size(); i++) {
+        const CStakeScheduler::ScheduledStake& s = stats.vSchedule[i];
+        if (i > 0) BOOST_CHECK(stats.vSchedule[i - 1].nTime <= s.nTime);
+        BOOST_CHECK(s.nTime >= stats.nWindowStart && s.nTime <= stats.nWindowEnd);
+        BOOST_CHECK(setScheduled.emplace(s.nTime, s.outpoint).second);
+    }
+    const unsigned int nBits = GetNextWorkRequired(pindexPrev, nullptr);
+    for (const CStakeableOutput& coin : availableCoins) {
+        const CStakeKernel& kernel = coin.GetKernel(pindexPrev, nBits);
+        const COutPoint outpoint(coin.tx->GetHash(), coin.i);
+        for (int64_t nTime = stats.nWindowStart; nTime <= stats.nWindowEnd; nTime += nSlotLength) {
+            BOOST_CHECK_EQUAL(kernel.CheckKernelHashAtTime(nTime), setScheduled.count({nTime, outpoint}) > 0);
+        }
+    }
+
+    // The coins of the slot are moved to the front
+    const int64_t nFirstSlot = stats.vSchedule.front().nTime;
+    std::vector<CStakeableOutput> vCoins = availableCoins;
+    scheduler.PrioritizeCoins(nFirstSlot, vCoins);
+    BOOST_CHECK(setScheduled.count({nFirstSlot, COutPoint(vCoins.front().tx->GetHash(), vCoins.front().i)}));
+
+    // Same tip and window: not computed again
+    scheduler.Update(pindexPrev, {});
+    BOOST_CHECK_EQUAL(scheduler.GetStats().nCoins, (int) availableCoins.size());
+
+    // Once the window is over, the schedule is computed again
+    SetMockTime(stats.nWindowEnd);
+    scheduler.Update(pindexPrev, availableCoins);
+    BOOST_CHECK_EQUAL(scheduler.GetStats().nWindowStart, stats.nWindowEnd + nSlotLength);
+
+    // A change of the stakeable coins makes it computed again, even in the same window
+    scheduler.StakeableCoinsChanged();
+    scheduler.Update(pindexPrev, {});
+    BOOST_CHECK_EQUAL(scheduler.GetStats().nCoins, 0);
+    BOOST_CHECK(scheduler.GetStats().vSchedule.empty());
+
+    SetMockTime(0);
+}
+
+BOOST_FIXTURE_TEST_CASE(stake_scheduler_wakeup_tests, TestPoSChainSetup)
+{
+    SyncWithValidationInterfaceQueue();
+    const CBlockIndex* pindexPrev = WITH_LOCK(cs_main, return chainActive.Tip());
+    const int64_t nSlotLength = Params().GetConsensus().nTimeSlotLength;
+    const int64_t nMockTime = GetTimeSlot(pindexPrev->GetBlockTime()) + 2 * nSlotLength;
+    SetMockTime(nMockTime);
+
+    // The wallet notifies the global scheduler
+    stakeScheduler = std::make_unique<CStakeScheduler>();
+    std::vector<CStakeableOutput> availableCoins = GetStakeableCoins(pwalletMain.get());
+    stakeScheduler->Update(pindexPrev, availableCoins);
+    const std::vector<CStakeScheduler::ScheduledStake> vSchedule = stakeScheduler->GetStats().vSchedule;
+    BOOST_CHECK(!vSchedule.empty());
+
+    // Not the current tip: returns at once
+    BOOST_CHECK_EQUAL(stakeScheduler->WaitForNextSlot(pindexPrev->pprev), 0);
+
+    // Wakes up at the first scheduled slot, a second away
+    const int64_t nFirstSlot = vSchedule.front().nTime;
+    SetMockTime(nFirstSlot - 1);
+    int64_t nStart = GetTimeMillis();
+    BOOST_CHECK_EQUAL(stakeScheduler->WaitForNextSlot(pindexPrev), nFirstSlot);
+    BOOST_CHECK(GetTimeMillis() - nStart >= 900);
+
+    // Wakes up when a stakeable coin is locked (the mocked time doesn't reach the first slot)
+    SetMockTime(nMockTime);
+    const COutPoint lockedOut(availableCoins.front().tx->GetHash(), availableCoins.front().i);
+    std::thread lockThread([this, &lockedOut]() {
+        MilliSleep(200);
+        WITH_LOCK(pwalletMain->cs_wallet, pwalletMain->LockCoin(lockedOut));
+    });
+    nStart = GetTimeMillis();
+    BOOST_CHECK_EQUAL(stakeScheduler->WaitForNextSlot(pindexPrev), 0);
+    BOOST_CHECK(GetTimeMillis() - nStart < STAKE_MAX_SLEEP_MILLIS);
+    lockThread.join();
+
+    // ...and the schedule is computed again with the remaining coins
+    availableCoins = GetStakeableCoins(pwalletMain.get());
+    stakeScheduler->Update(pindexPrev, availableCoins);
+    const CStakeScheduler::Stats stats = stakeScheduler->GetStats();
+    BOOST_CHECK_EQUAL(stats.nCoins, (int) availableCoins.size());
+    for (const CStakeScheduler::ScheduledStake& s : stats.vSchedule) {
+        BOOST_CHECK(s.outpoint != lockedOut);
+    }
+
+    // Wakes up when it is unlocked
+    std::thread unlockThread([this, &lockedOut]() {
+        MilliSleep(200);
+        WITH_LOCK(pwalletMain->cs_wallet, pwalletMain->UnlockCoin(lockedOut));
+    });
+    BOOST_CHECK_EQUAL(stakeScheduler->WaitForNextSlot(pindexPrev), 0);
+    unlockThread.join();
+
+    // Wakes up on shutdown, and doesn't sleep any more
+    std::thread interruptThread([]() {
+        MilliSleep(200);
+        stakeScheduler->Interrupt();
+    });
+    nStart = GetTimeMillis();
+    BOOST_CHECK_EQUAL(stakeScheduler->WaitForNextSlot(pindexPrev), 0);
+    interruptThread.join();
+    BOOST_CHECK_EQUAL(stakeScheduler->WaitForNextSlot(pindexPrev), 0);
+    BOOST_CHECK(GetTimeMillis() - nStart < STAKE_MAX_SLEEP_MILLIS);
+
+    stakeScheduler.reset();
+    SetMockTime(0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
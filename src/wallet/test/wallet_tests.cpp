@@ -419,6 +419,38 @@ BOOST_FIXTURE_TEST_CASE(rescan, TestChain100Setup)
     }
 }
 
+// The rescan pipeline reads the blocks and matches them on other threads: it must not need
+// cs_main there, as the startup rescan runs with cs_main held.
+BOOST_FIXTURE_TEST_CASE(rescan_cs_main_held, TestChain100Setup)
+{
+    LOCK(cs_main);
+    CBlockIndex* const nullBlock = nullptr;
+    CBlockIndex* tip = chainActive.Tip();
+
+    // The whole chain, longer than the blocks read ahead by the pipeline
+    {
+        CWallet wallet("dummy", WalletDatabase::CreateDummy());
+        WITH_LOCK(wallet.cs_wallet, wallet.SetLastBlockProcessed(tip); );
+        AddKey(wallet, coinbaseKey);
+        WalletRescanReserver reserver(&wallet);
+        reserver.reserve();
+        BOOST_CHECK_EQUAL(nullBlock, wallet.ScanForWalletTransactions(chainActive.Genesis(), nullptr, reserver));
+        BOOST_CHECK_EQUAL(WITH_LOCK(wallet.cs_wallet, return wallet.mapWallet.size()), coinbaseTxns.size());
+    }
+
+    // Up to a stop block, with cs_wallet held too
+    {
+        CWallet wallet("dummy", WalletDatabase::CreateDummy());
+        WITH_LOCK(wallet.cs_wallet, wallet.SetLastBlockProcessed(tip); );
+        AddKey(wallet, coinbaseKey);
+        WalletRescanReserver reserver(&wallet);
+        reserver.reserve();
+        LOCK(wallet.cs_wallet);
+        BOOST_CHECK_EQUAL(nullBlock, wallet.ScanForWalletTransactions(chainActive[1], chainActive[50], reserver));
+        BOOST_CHECK_EQUAL(wallet.mapWallet.size(), 50U);
+    }
+}
+
 // Verify importwallet RPC starts rescan at earliest block with timestamp
 // greater or equal than key birthday. Previously there was a bug where
 // importwallet RPC would start the scan at the latest block with timestamp less
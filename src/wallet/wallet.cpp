@@ -14,6 +14,7 @@
 
 #include "checkpoints.h"
 #include "coincontrol.h"
+#include "ctpl_stl.h"
 #include "evo/providertx.h"
 #include "guiinterfaceutil.h"
 #include "policy/policy.h"
@@ -22,11 +23,15 @@
 #include "scheduler.h"
 #include "shutdown.h"
 #include "spork.h"
+#include "util/threadnames.h"
 #include "util/validation.h"
 #include "utilmoneystr.h"
 #include "wallet/fees.h"
+#include "wallet/stakescheduler.h"
 
+#include <deque>
 #include <future>
+#include <thread>
 #include <boost/algorithm/string/replace.hpp>
 
 std::vector<CWalletRef> vpwallets;
@@ -496,7 +501,7 @@ bool CWallet::ChangeWalletPassphrase(const SecureString& strOldWalletPassphrase,
 
 void CWallet::ChainTipAdded(const CBlockIndex *pindex,
                             const CBlock *pblock,
-                            SaplingMerkleTree saplingTree)
+                            SaplingMerkleTree& saplingTree)
 {
     IncrementNoteWitnesses(pindex, pblock, saplingTree);
     m_sspk_man->UpdateSaplingNullifierNoteMapForBlock(pblock);
@@ -764,6 +769,130 @@ void CWallet::AddToSpends(const uint256& wtxid)
     }
 }
 
+void CWallet::EraseStakeableOutputs(const uint256& txid)
+{
+    AssertLockHeld(cs_wallet);
+    auto it = mapStakeableTxHeights.find(txid);
+    if (it == mapStakeableTxHeights.end()) return;
+    // the outputs of a tx are contiguous in the index
+    const std::pair<int, COutPoint> first(it->second, COutPoint(txid, 0));
+    bool fCoinsChanged = false;
+    for (auto* pset : {&setStakeableOutputs, &setStakeableCoins, &setColdStakeableCoins}) {
+        auto itOut = pset->lower_bound(first);
+        while (itOut != pset->end() && itOut->second.hash == txid) {
+            itOut = pset->erase(itOut);
+            fCoinsChanged |= pset != &setStakeableOutputs;
+        }
+    }
+    mapStakeableTxHeights.erase(it);
+    if (fCoinsChanged && stakeScheduler) stakeScheduler->StakeableCoinsChanged();
+}
+
+void CWallet::UpdateStakeableOutputs(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+    const uint256& txid = wtx.GetHash();
+    EraseStakeableOutputs(txid);
+    if (!wtx.isConfirmed()) return;
+
+    const Consensus::Params& consensus = Params().GetConsensus();
+    int nRequiredDepth = consensus.nStakeMinDepth;
+    if (wtx.IsCoinBase() || wtx.IsCoinStake()) {
+        nRequiredDepth = std::max(nRequiredDepth, consensus.nCoinbaseMaturity + 1);
+    }
+    const int nStakeHeight = wtx.m_confirm.block_height + nRequiredDepth - 1;
+    bool fAdded = false;
+    for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+        const CTxOut& out = wtx.tx->vout[i];
+        if (out.nValue <= 0) continue;
+        if ((IsMine(out) & (ISMINE_SPENDABLE | ISMINE_COLD)) == ISMINE_NO) continue;
+        // Skip the outputs spent by a confirmed tx
+        const COutPoint outpoint(txid, i);
+        const auto range = mapTxSpends.equal_range(outpoint);
+        bool fSpent = false;
+        for (auto it = range.first; it != range.second && !fSpent; ++it) {
+            auto mit = mapWallet.find(it->second);
+            fSpent = mit != mapWallet.end() && mit->second.isConfirmed();
+        }
+        if (fSpent) continue;
+        const std::pair<int, COutPoint> entry(nStakeHeight, outpoint);
+        setStakeableOutputs.emplace(entry);
+        if (nStakeHeight <= nStakeableMaxHeight) CheckStakeableCoin(entry);
+        fAdded = true;
+    }
+    if (fAdded) mapStakeableTxHeights.emplace(txid, nStakeHeight);
+}
+
+void CWallet::CheckStakeableCoin(const std::pair<int, COutPoint>& entry)
+{
+    AssertLockHeld(cs_wallet);
+    const COutPoint& outpoint = entry.second;
+    const bool fWasStakeable = (setStakeableCoins.erase(entry) + setColdStakeableCoins.erase(entry)) > 0;
+    std::set<std::pair<int, COutPoint>>* pset = nullptr;
+    if (!IsSpent(outpoint) && !IsLockedCoin(outpoint.hash, outpoint.n)) {
+        // Same as CheckOutputAvailability, without coin control and delegated coins
+        const CTxOut& out = mapWallet.at(outpoint.hash).tx->vout[outpoint.n];
+        const isminetype mine = IsMine(out);
+        if (mine == ISMINE_SPENDABLE_DELEGATED) {
+            // delegated coins are staked by the cold staker
+        } else if ((mine & ISMINE_SPENDABLE) != ISMINE_NO) {
+            pset = &setStakeableCoins;
+        } else if ((mine & ISMINE_COLD) != ISMINE_NO && (mine != ISMINE_COLD || HasDelegator(out))) {
+            pset = &setColdStakeableCoins;
+        }
+    }
+    if (pset) pset->emplace(entry);
+    // Wake up the staker sleeping on the old coins
+    if (fWasStakeable != (pset != nullptr) && stakeScheduler) stakeScheduler->StakeableCoinsChanged();
+}
+
+void CWallet::RecheckStakeableCoin(const COutPoint& outpoint)
+{
+    AssertLockHeld(cs_wallet);
+    auto it = mapStakeableTxHeights.find(outpoint.hash);
+    if (it == mapStakeableTxHeights.end() || it->second > nStakeableMaxHeight) return;
+    const std::pair<int, COutPoint> entry(it->second, outpoint);
+    if (setStakeableOutputs.count(entry)) CheckStakeableCoin(entry);
+}
+
+void CWallet::SetStakeableMaxHeight(int nMaxHeight)
+{
+    AssertLockHeld(cs_wallet);
+    if (nMaxHeight > nStakeableMaxHeight) {
+        // the outputs getting deep enough
+        auto it = setStakeableOutputs.lower_bound({nStakeableMaxHeight + 1, COutPoint(UINT256_ZERO, 0)});
+        for (; it != setStakeableOutputs.end() && it->first <= nMaxHeight; ++it) {
+            CheckStakeableCoin(*it);
+        }
+    } else if (nMaxHeight < nStakeableMaxHeight) {
+        // the outputs no longer deep enough (the wallet tip went back)
+        const std::pair<int, COutPoint> first(nMaxHeight + 1, COutPoint(UINT256_ZERO, 0));
+        auto itCoins = setStakeableCoins.lower_bound(first);
+        auto itColdCoins = setColdStakeableCoins.lower_bound(first);
+        if ((itCoins != setStakeableCoins.end() || itColdCoins != setColdStakeableCoins.end()) && stakeScheduler) {
+            stakeScheduler->StakeableCoinsChanged();
+        }
+        setStakeableCoins.erase(itCoins, setStakeableCoins.end());
+        setColdStakeableCoins.erase(itColdCoins, setColdStakeableCoins.end());
+    }
+    nStakeableMaxHeight = nMaxHeight;
+}
+
+void CWallet::UpdateStakeableOutputsWithInputs(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+    UpdateStakeableOutputs(wtx);
+    if (wtx.IsCoinBase()) return;
+    std::set<uint256> updated;
+    for (const CTxIn& txin : wtx.tx->vin) {
+        if (!updated.emplace(txin.prevout.hash).second) continue;
+        auto it = mapWallet.find(txin.prevout.hash);
+        if (it != mapWallet.end()) {
+            UpdateStakeableOutputs(it->second);
+        }
+    }
+}
+
 bool CWallet::EncryptWallet(const SecureString& strWalletPassphrase)
 {
     if (IsCrypted())
@@ -948,6 +1077,8 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
     // Break debit/credit balance caches:
     wtx.MarkDirty();
 
+    UpdateStakeableOutputsWithInputs(wtx);
+
     // Notify UI of new or updated transaction
     NotifyTransactionChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
 
@@ -1005,6 +1136,7 @@ bool CWallet::LoadToWallet(CWalletTx& wtxIn)
     m_sspk_man->UpdateNullifierNoteMapWithTx(wtx);
     wtxOrdered.emplace(wtx.nOrderPos, &wtx);
     AddToSpends(hash);
+    UpdateStakeableOutputsWithInputs(wtx);
     for (const CTxIn& txin : wtx.tx->vin) {
         auto it = mapWallet.find(txin.prevout.hash);
         if (it != mapWallet.end()) {
@@ -1017,9 +1149,10 @@ bool CWallet::LoadToWallet(CWalletTx& wtxIn)
     return true;
 }
 
-bool CWallet::FindNotesDataAndAddMissingIVKToKeystore(const CTransaction& tx, Optional<mapSaplingNoteData_t>& saplingNoteData)
+bool CWallet::FindNotesDataAndAddMissingIVKToKeystore(const CTransaction& tx, Optional<mapSaplingNoteData_t>& saplingNoteData,
+                                                      const std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap>* pFound)
 {
-    auto saplingNoteDataAndAddressesToAdd = m_sspk_man->FindMySaplingNotes(tx);
+    auto saplingNoteDataAndAddressesToAdd = pFound ? *pFound : m_sspk_man->FindMySaplingNotes(tx);
     saplingNoteData = saplingNoteDataAndAddressesToAdd.first;
     auto addressesToAdd = saplingNoteDataAndAddressesToAdd.second;
     // Add my addresses
@@ -1068,7 +1201,8 @@ void CWallet::AddExternalNotesDataToTx(CWalletTx& wtx) const
  * Abandoned state should probably be more carefully tracked via different
  * posInBlock signals or by checking mempool presence when necessary.
  */
-bool CWallet::AddToWalletIfInvolvingMe(const CTransactionRef& ptx, const CWalletTx::Confirmation& confirm, bool fUpdate)
+bool CWallet::AddToWalletIfInvolvingMe(const CTransactionRef& ptx, const CWalletTx::Confirmation& confirm, bool fUpdate,
+                                       const TxKeysMatch* pMatch)
 {
     const CTransaction& tx = *ptx;
     {
@@ -1093,7 +1227,7 @@ bool CWallet::AddToWalletIfInvolvingMe(const CTransactionRef& ptx, const CWallet
         // Check tx for Sapling notes
         Optional<mapSaplingNoteData_t> saplingNoteData {nullopt};
         if (HasSaplingSPKM()) {
-            if (!FindNotesDataAndAddMissingIVKToKeystore(tx, saplingNoteData)) {
+            if (!FindNotesDataAndAddMissingIVKToKeystore(tx, saplingNoteData, pMatch ? &pMatch->saplingNotes : nullptr)) {
                 return false; // error adding incoming viewing key.
             }
         }
@@ -1170,6 +1304,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
             assert(!wtx.InMempool());
             wtx.setAbandoned();
             wtx.MarkDirty();
+            UpdateStakeableOutputsWithInputs(wtx);
             batch.WriteTx(wtx);
             NotifyTransactionChanged(this, wtx.GetHash(), CT_UPDATED);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them abandoned too
@@ -1230,6 +1365,7 @@ void CWallet::MarkConflicted(const uint256& hashBlock, int conflicting_height, c
             wtx.m_confirm.block_height = conflicting_height;
             wtx.setConflicted();
             wtx.MarkDirty();
+            UpdateStakeableOutputsWithInputs(wtx);
             batch.WriteTx(wtx);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them conflicted too
             TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(now, 0));
@@ -1432,8 +1568,18 @@ void CWallet::EraseFromWallet(const uint256& hash)
 {
     {
         LOCK(cs_wallet);
-        if (mapWallet.erase(hash))
+        auto it = mapWallet.find(hash);
+        if (it != mapWallet.end()) {
+            const CTransactionRef tx = it->second.tx;
+            mapWallet.erase(it);
             WalletBatch(*database).EraseTx(hash);
+            // The outputs spent by the erased tx could be stakeable again
+            EraseStakeableOutputs(hash);
+            for (const CTxIn& txin : tx->vin) {
+                auto itPrev = mapWallet.find(txin.prevout.hash);
+                if (itPrev != mapWallet.end()) UpdateStakeableOutputs(itPrev->second);
+            }
+        }
         LogPrintf("%s: Erased wtx %s from wallet\n", __func__, hash.GetHex());
     }
     return;
@@ -1854,6 +2000,176 @@ int64_t CWallet::RescanFromTime(int64_t startTime, const WalletRescanReserver& r
     return startTime;
 }
 
+CWallet::TxKeysMatch CWallet::MatchTxKeys(const CTransaction& tx) const
+{
+    TxKeysMatch match;
+    // LockIfMyCollateral looks at every ProRegTx
+    match.fCandidate = tx.IsSpecialTx() && tx.nType == CTransaction::TxType::PROREG;
+    for (const CTxOut& txout : tx.vout) {
+        if (match.fCandidate) break;
+        match.fCandidate = IsMine(txout) != ISMINE_NO;
+    }
+    if (HasSaplingSPKM() && tx.IsShieldedTx()) {
+        match.saplingNotes = m_sspk_man->FindMySaplingNotes(tx);
+    }
+    return match;
+}
+
+size_t CWallet::GetKeyStoreSize() const
+{
+    LOCK(cs_KeyStore);
+    return mapKeys.size() + mapCryptedKeys.size() + mapWatchKeys.size() + mapScripts.size() + setWatchOnly.size() +
+           mapSaplingFullViewingKeys.size() + mapSaplingIncomingViewingKeys.size();
+}
+
+bool CWallet::MayInvolveMe(const CTransaction& tx, const TxKeysMatch& match) const
+{
+    AssertLockHeld(cs_wallet);
+    if (match.fCandidate || !match.saplingNotes.first.empty() || mapWallet.count(tx.GetHash())) {
+        return true;
+    }
+    // Spends (or conflicts with) a wallet output
+    for (const CTxIn& txin : tx.vin) {
+        if (mapWallet.count(txin.prevout.hash) || mapTxSpends.count(txin.prevout)) {
+            return true;
+        }
+    }
+    if (tx.IsShieldedTx()) {
+        for (const SpendDescription& spend : tx.sapData->vShieldedSpend) {
+            if (m_sspk_man->IsSaplingNullifierFromMe(spend.nullifier)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+namespace {
+
+//! Number of blocks read and matched ahead of the wallet during a rescan
+static const size_t RESCAN_BLOCKS_AHEAD = 32;
+//! Number of blocks handed to a rescan pipeline at once
+static const int RESCAN_BLOCKS_BATCH = 1000;
+
+//! Workers matching the transactions with the wallet keys, shared by the rescans of all the wallets
+static ctpl::thread_pool& GetRescanPool()
+{
+    static const std::unique_ptr<ctpl::thread_pool> pool = []() {
+        int nThreads = gArgs.GetArg("-rescanthreads", DEFAULT_RESCAN_THREADS);
+        if (nThreads <= 0 || nThreads > GetNumCores()) nThreads = GetNumCores();
+        auto ret = std::make_unique<ctpl::thread_pool>(nThreads);
+        RenameThreadPool(*ret, "Hemis-rescan");
+        LogPrintf("Using %d threads for the wallet rescans\n", nThreads);
+        return ret;
+    }();
+    return *pool;
+}
+
+/**
+ * Rescan pipeline. An I/O thread reads the given blocks ahead, and hands their transactions
+ * to the worker pool, which matches them with the wallet keys without holding cs_main/cs_wallet.
+ * The rescan takes the blocks in chain order with Next(), and applies the matches under the locks.
+ * The block positions are collected by the caller: neither the reader nor the workers take
+ * cs_main, so the rescan can run with cs_main held.
+ */
+class RescanPipeline
+{
+public:
+    struct Item {
+        CBlockIndex* pindex{nullptr};
+        // null if the block couldn't be read
+        std::shared_ptr<const CBlock> block;
+        // size of the key store before the txs were matched
+        size_t nKeyStoreSize{0};
+        std::future<std::vector<CWallet::TxKeysMatch>> matches;
+    };
+
+    RescanPipeline(const CWallet* pwalletIn, ctpl::thread_pool& poolIn, std::vector<std::pair<CBlockIndex*, FlatFilePos>> vBlocksIn) :
+        pwallet(pwalletIn), pool(poolIn), vBlocks(std::move(vBlocksIn))
+    {
+        readThread = std::thread(&TraceThread<std::function<void()>>, "rescanread", std::function<void()>(std::bind(&RescanPipeline::ThreadRead, this)));
+    }
+
+    ~RescanPipeline()
+    {
+        {
+            LOCK(cs);
+            fStop = true;
+        }
+        cond.notify_all();
+        readThread.join();
+        // don't leave matching tasks behind
+        for (auto& item : queue) {
+            if (item.matches.valid()) item.matches.wait();
+        }
+    }
+
+    // Next block in chain order. False when all the blocks have been read
+    bool Next(Item& itemRet)
+    {
+        WAIT_LOCK(cs, lock);
+        cond.wait(lock, [&] { return !queue.empty() || fDone; });
+        if (queue.empty()) return false;
+        itemRet = std::move(queue.front());
+        queue.pop_front();
+        cond.notify_all();
+        return true;
+    }
+
+private:
+    const CWallet* pwallet;
+    ctpl::thread_pool& pool;
+    const std::vector<std::pair<CBlockIndex*, FlatFilePos>> vBlocks;
+    std::thread readThread;
+
+    Mutex cs;
+    std::condition_variable cond;
+    std::deque<Item> queue GUARDED_BY(cs);
+    bool fStop GUARDED_BY(cs){false};
+    bool fDone GUARDED_BY(cs){false};
+
+    void ThreadRead()
+    {
+        for (const auto& entry : vBlocks) {
+            {
+                WAIT_LOCK(cs, lock);
+                cond.wait(lock, [&] { return fStop || queue.size() < RESCAN_BLOCKS_AHEAD; });
+                if (fStop) break;
+            }
+
+            Item item;
+            item.pindex = entry.first;
+            auto pblock = std::make_shared<CBlock>();
+            if (!entry.second.IsNull() && ReadBlockFromDisk(*pblock, entry.second) &&
+                    pblock->GetHash() == entry.first->GetBlockHash()) {
+                item.block = pblock;
+                item.nKeyStoreSize = pwallet->GetKeyStoreSize();
+                const CWallet* pw = pwallet;
+                item.matches = pool.push([pw, pblock](int) {
+                    std::vector<CWallet::TxKeysMatch> vMatches;
+                    vMatches.reserve(pblock->vtx.size());
+                    for (const auto& tx : pblock->vtx) {
+                        vMatches.emplace_back(pw->MatchTxKeys(*tx));
+                    }
+                    return vMatches;
+                });
+            }
+            {
+                LOCK(cs);
+                queue.emplace_back(std::move(item));
+            }
+            cond.notify_all();
+        }
+        {
+            LOCK(cs);
+            fDone = true;
+        }
+        cond.notify_all();
+    }
+};
+
+} // anon namespace
+
 /**
  * Scan the block chain (starting in pindexStart) for transactions
  * from or to us. If fUpdate is true, found transactions that already
@@ -1893,58 +2209,95 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
             dProgressTip = Checkpoints::GuessVerificationProgress(tip, false);
         }
 
+        ctpl::thread_pool& pool = GetRescanPool();
+
         std::vector<uint256> myTxHashes;
-        while (pindex && !fAbortRescan) {
-            double gvp = 0;
-            if (pindex->nHeight % 100 == 0 && dProgressTip - dProgressStart > 0.0) {
-                gvp = WITH_LOCK(cs_main, return Checkpoints::GuessVerificationProgress(pindex, false); );
-                ShowProgress(_("Rescanning..."), std::max(1, std::min(99, (int)((gvp - dProgressStart) / (dProgressTip - dProgressStart) * 100))));
-            }
-            if (GetTime() >= nNow + 60) {
-                nNow = GetTime();
-                LogPrintf("Still rescanning. At block %d. Progress=%f\n", pindex->nHeight, gvp);
-            }
-            if (fromStartup && ShutdownRequested()) {
-                break;
+        // Sapling tree handed off from a block to the next one (root --> tree)
+        std::pair<uint256, SaplingMerkleTree> saplingTree;
+        bool fStop = false;
+        while (pindex && !fStop) {
+            // The pipeline reads a batch of blocks up to the tip at the time, then this loop catches up with the next ones
+            std::vector<std::pair<CBlockIndex*, FlatFilePos>> vBlocks;
+            {
+                LOCK(cs_main);
+                for (CBlockIndex* pindexBatch = pindex; pindexBatch && (int) vBlocks.size() < RESCAN_BLOCKS_BATCH;
+                     pindexBatch = chainActive.Next(pindexBatch)) {
+                    vBlocks.emplace_back(pindexBatch, pindexBatch->GetBlockPos());
+                    if (pindexBatch == pindexStop) break;
+                }
             }
+            RescanPipeline pipeline(this, pool, std::move(vBlocks));
+            RescanPipeline::Item item;
+            CBlockIndex* pindexLast = nullptr;
+            while (!fAbortRescan && pipeline.Next(item)) {
+                pindex = pindexLast = item.pindex;
+                double gvp = 0;
+                if (pindex->nHeight % 100 == 0 && dProgressTip - dProgressStart > 0.0) {
+                    gvp = WITH_LOCK(cs_main, return Checkpoints::GuessVerificationProgress(pindex, false); );
+                    const double progress = std::max(0.0, std::min(1.0, (gvp - dProgressStart) / (dProgressTip - dProgressStart)));
+                    m_scanning_progress = progress;
+                    ShowProgress(_("Rescanning..."), std::max(1, std::min(99, (int)(progress * 100))));
+                }
+                if (GetTime() >= nNow + 60) {
+                    nNow = GetTime();
+                    LogPrintf("Still rescanning. At block %d. Progress=%f\n", pindex->nHeight, gvp);
+                }
+                if (fromStartup && ShutdownRequested()) {
+                    fStop = true;
+                    break;
+                }
 
-            CBlock block;
-            if (ReadBlockFromDisk(block, pindex)) {
-                LOCK2(cs_main, cs_wallet);
-                if (pindex && !chainActive.Contains(pindex)) {
-                     // Abort scan if current block is no longer active, to prevent
-                     // marking transactions as coming from the wrong block.
-                     ret = pindex;
-                     break;
-                 }
-                for (int posInBlock = 0; posInBlock < (int) block.vtx.size(); posInBlock++) {
-                    const auto& tx = block.vtx[posInBlock];
-                    CWalletTx::Confirmation confirm(CWalletTx::Status::CONFIRMED, pindex->nHeight, pindex->GetBlockHash(), posInBlock);
-                    if (AddToWalletIfInvolvingMe(tx, confirm, fUpdate)) {
-                        myTxHashes.push_back(tx->GetHash());
+                if (item.block) {
+                    const CBlock& block = *item.block;
+                    const std::vector<TxKeysMatch>& vMatches = item.matches.get();
+                    LOCK2(cs_main, cs_wallet);
+                    if (pindex && !chainActive.Contains(pindex)) {
+                        // Abort scan if current block is no longer active, to prevent
+                        // marking transactions as coming from the wrong block.
+                        ret = pindex;
+                        fStop = true;
+                        break;
+                    }
+                    for (int posInBlock = 0; posInBlock < (int) block.vtx.size(); posInBlock++) {
+                        const auto& tx = block.vtx[posInBlock];
+                        // The keys added since the match (e.g. keypool top up) could be involved
+                        const bool fStale = item.nKeyStoreSize != GetKeyStoreSize();
+                        if (!fStale && !MayInvolveMe(*tx, vMatches[posInBlock])) continue;
+                        CWalletTx::Confirmation confirm(CWalletTx::Status::CONFIRMED, pindex->nHeight, pindex->GetBlockHash(), posInBlock);
+                        if (AddToWalletIfInvolvingMe(tx, confirm, fUpdate, fStale ? nullptr : &vMatches[posInBlock])) {
+                            myTxHashes.push_back(tx->GetHash());
+                        }
                     }
-                }
 
-                // Sapling
-                // This should never fail: we should always be able to get the tree
-                // state on the path to the tip of our chain
-                if (pindex->pprev) {
-                    if (Params().GetConsensus().NetworkUpgradeActive(pindex->pprev->nHeight, Consensus::UPGRADE_V5_0)) {
-                        SaplingMerkleTree saplingTree;
-                        assert(pcoinsTip->GetSaplingAnchorAt(pindex->pprev->hashFinalSaplingRoot, saplingTree));
-                        // Increment note witness caches
-                        ChainTipAdded(pindex, &block, saplingTree);
+                    // Sapling
+                    // This should never fail: we should always be able to get the tree
+                    // state on the path to the tip of our chain
+                    if (pindex->pprev) {
+                        if (Params().GetConsensus().NetworkUpgradeActive(pindex->pprev->nHeight, Consensus::UPGRADE_V5_0)) {
+                            // Load the tree only if the previous block didn't leave it
+                            const uint256& prevRoot = pindex->pprev->hashFinalSaplingRoot;
+                            if (saplingTree.first != prevRoot) {
+                                assert(pcoinsTip->GetSaplingAnchorAt(prevRoot, saplingTree.second));
+                            }
+                            // Increment note witness caches (appending the commitments of the block to the tree)
+                            ChainTipAdded(pindex, &block, saplingTree.second);
+                            saplingTree.first = pindex->hashFinalSaplingRoot;
+                        }
                     }
+                } else {
+                    ret = pindex;
+                }
+                m_scanning_height = pindex->nHeight;
+                m_scanned_blocks++;
+                if (pindex == pindexStop) {
+                    fStop = true;
+                    break;
                 }
-            } else {
-                ret = pindex;
-            }
-            if (pindex == pindexStop) {
-                break;
             }
-            {
+            if (fAbortRescan || !pindexLast) break;
+            if (!fStop) {
                 LOCK(cs_main);
-                pindex = chainActive.Next(pindex);
+                pindex = chainActive.Next(pindexLast);
                 if (tip != chainActive.Tip()) {
                     tip = chainActive.Tip();
                     // in case the tip has changed, update progress max
@@ -2686,41 +3039,34 @@ bool CWallet::StakeableCoins(std::vector<CStakeableOutput>* pCoins)
     if (pCoins) pCoins->clear();
 
     LOCK2(cs_main, cs_wallet);
-    for (const auto& it : mapWallet) {
-        const uint256& wtxid = it.first;
-        const CWalletTx* pcoin = &(it).second;
-
-        // Check if the tx is selectable
-        int nDepth = 0;
-        bool safeTx = false;
-        if (!CheckTXAvailability(pcoin, true, nDepth, safeTx))
-            continue;
-
-        // Check min depth requirement for stake inputs
-        if (nDepth < Params().GetConsensus().nStakeMinDepth) continue;
-
-        const CBlockIndex* pindex = nullptr;
-        for (unsigned int index = 0; index < pcoin->tx->vout.size(); index++) {
+    // Only the outputs which got deep enough (or too shallow) since the last call are checked
+    SetStakeableMaxHeight(GetLastBlockHeight());
 
-            auto res = CheckOutputAvailability(
-                    pcoin->tx->vout[index],
-                    index,
-                    wtxid,
-                    nullptr, // coin control
-                    false,   // fIncludeDelegated
-                    fIncludeColdStaking,
-                    false,
-                    false);   // fIncludeLocked
+    if (!pCoins) return !setStakeableCoins.empty() || (fIncludeColdStaking && !setColdStakeableCoins.empty());
 
-            if (!res.available || !res.spendable) continue;
+    std::vector<std::pair<int, COutPoint>> vCoins;
+    if (fIncludeColdStaking && !setColdStakeableCoins.empty()) {
+        vCoins.reserve(setStakeableCoins.size() + setColdStakeableCoins.size());
+        std::merge(setStakeableCoins.begin(), setStakeableCoins.end(),
+                   setColdStakeableCoins.begin(), setColdStakeableCoins.end(), std::back_inserter(vCoins));
+    } else {
+        vCoins.assign(setStakeableCoins.begin(), setStakeableCoins.end());
+    }
 
-            // found valid coin
-            if (!pCoins) return true;
-            if (!pindex) pindex = mapBlockIndex.at(pcoin->m_confirm.hashBlock);
-            pCoins->emplace_back(pcoin, (int) index, nDepth, pindex);
+    pCoins->reserve(vCoins.size());
+    const CWalletTx* pcoin = nullptr;
+    const CBlockIndex* pindex = nullptr;
+    int nDepth = 0;
+    for (const auto& entry : vCoins) {
+        const COutPoint& outpoint = entry.second;
+        if (!pcoin || pcoin->GetHash() != outpoint.hash) {
+            pcoin = &mapWallet.at(outpoint.hash);
+            pindex = mapBlockIndex.at(pcoin->m_confirm.hashBlock);
+            nDepth = pcoin->GetDepthInMainChain();
         }
+        pCoins->emplace_back(pcoin, (int) outpoint.n, nDepth, pindex);
     }
-    return (pCoins && !pCoins->empty());
+    return !pCoins->empty();
 }
 
 bool CWallet::SelectCoinsMinConf(const CAmount& nTargetValue, int nConfMine, int nConfTheirs, uint64_t nMaxAncestors, std::vector<COutput> vCoins, std::set<std::pair<const CWalletTx*, unsigned int> >& setCoinsRet, CAmount& nValueRet) const
@@ -3365,6 +3711,16 @@ bool CWallet::CreateCoinStake(
     bool fKernelFound = false;
     int nAttempts = 0;
     for (auto it = availableCoins->begin(); it != availableCoins->end();) {
+        if (stakingWorkerPool) {
+            // Let the workers look for the next kernel, then build the coinstake on it below
+            size_t nPos = it - availableCoins->begin();
+            if (!SearchStakeKernel(pindexPrev, nBits, *availableCoins, nPos, nTxNewTime, nAttempts, stopOnNewBlock)) {
+                return false;
+            }
+            if (nPos == availableCoins->size()) break;
+            it = availableCoins->begin() + nPos;
+        }
+
         COutPoint outPoint = COutPoint(it->tx->GetHash(), it->i);
         CPivStake stakeInput(it->tx->tx->vout[it->i],
                              outPoint,
@@ -3385,12 +3741,17 @@ bool CWallet::CreateCoinStake(
 
         nCredit = 0;
 
-        nAttempts++;
-        fKernelFound = Stake(pindexPrev, &stakeInput, nBits, nTxNewTime);
+        if (stakingWorkerPool) {
+            // The workers found the kernel at nTxNewTime, and counted the attempts
+            fKernelFound = true;
+        } else {
+            nAttempts++;
+            fKernelFound = Stake(pindexPrev, it->GetKernel(pindexPrev, nBits), nTxNewTime);
 
-        // update staker status (time, attempts)
-        pStakerStatus->SetLastTime(nTxNewTime);
-        pStakerStatus->SetLastTries(nAttempts);
+            // update staker status (time, attempts)
+            pStakerStatus->SetLastTime(nTxNewTime);
+            pStakerStatus->SetLastTries(nAttempts);
+        }
 
         if (!fKernelFound) {
             it++;
@@ -3444,6 +3805,111 @@ bool CWallet::CreateCoinStake(
     return fKernelFound;
 }
 
+bool CWallet::SearchStakeKernel(const CBlockIndex* pindexPrev,
+                                unsigned int nBits,
+                                std::vector<CStakeableOutput>& availableCoins,
+                                size_t& nPos,
+                                int64_t& nTxNewTime,
+                                int& nAttempts,
+                                bool stopOnNewBlock) const
+{
+    // Number of coins a worker claims at once
+    static const size_t KERNEL_SEARCH_BATCH_SIZE = 64;
+
+    const size_t nCoins = availableCoins.size();
+    std::atomic<size_t> nNextPos{nPos};
+    std::atomic<bool> fInterrupted{false};
+    std::atomic<int> nTries{0};
+    // The first kernel and its time, the spent candidates and the last time tried (guarded by cs_kernel).
+    // nKernelPos is also read without the lock, to stop the workers early.
+    Mutex cs_kernel;
+    std::atomic<size_t> nKernelPos{nCoins};
+    int64_t nKernelTime{0};
+    int64_t nLastTime{0};
+    std::vector<size_t> vSpent;
+
+    auto search = [&](int64_t& nTime) {
+        while (true) {
+            // New block came in, or the wallet got locked, or shutdown was requested: stop everybody
+            if (fInterrupted ||
+                    (stopOnNewBlock && GetLastBlockHeightLockWallet() != pindexPrev->nHeight) ||
+                    IsLocked() || ShutdownRequested()) {
+                fInterrupted = true;
+                return;
+            }
+
+            // The batches are claimed in order: stop after the first kernel found
+            const size_t nStart = nNextPos.fetch_add(KERNEL_SEARCH_BATCH_SIZE);
+            if (nStart >= nCoins || nStart >= nKernelPos) return;
+            const size_t nEnd = std::min(nStart + KERNEL_SEARCH_BATCH_SIZE, nCoins);
+            // The coins before a kernel found by another worker are still checked, so that
+            // the kernel found is the first one, as in the serial search
+            for (size_t i = nStart; i < nEnd && i < nKernelPos; i++) {
+                const CStakeableOutput& coin = availableCoins[i];
+                nTries++;
+                if (!Stake(pindexPrev, coin.GetKernel(pindexPrev, nBits), nTime)) continue;
+
+                // Make sure the stake input hasn't been spent since last check
+                const bool fSpent = WITH_LOCK(cs_wallet, return IsSpent(coin.tx->GetHash(), coin.i));
+                LOCK(cs_kernel);
+                if (fSpent) {
+                    vSpent.emplace_back(i);
+                } else if (i < nKernelPos) {
+                    // Keep the first kernel, in case more workers find one
+                    nKernelPos = i;
+                    nKernelTime = nTime;
+                }
+            }
+        }
+    };
+    auto worker = [&]() {
+        int64_t nTime = 0;
+        search(nTime);
+        LOCK(cs_kernel);
+        nLastTime = std::max(nLastTime, nTime);
+    };
+
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < stakingWorkerPool->size(); i++) {
+        futures.emplace_back(stakingWorkerPool->push([&worker](int) { worker(); }));
+    }
+    for (auto& f : futures) {
+        f.get();
+    }
+
+    LOCK(cs_kernel);
+
+    // update staker status (time, attempts)
+    nAttempts += nTries;
+    if (nTries > 0) {
+        nTxNewTime = nKernelPos < nCoins ? nKernelTime : nLastTime;
+        pStakerStatus->SetLastTime(nTxNewTime);
+    }
+    pStakerStatus->SetLastTries(nAttempts);
+
+    if (fInterrupted) return false;
+
+    // remove the spent inputs from the available coins
+    nPos = nKernelPos;
+    std::sort(vSpent.rbegin(), vSpent.rend());
+    for (const size_t i : vSpent) {
+        availableCoins.erase(availableCoins.begin() + i);
+        if (i < nPos) nPos--;
+    }
+    if (nKernelPos == nCoins) nPos = availableCoins.size();
+    return true;
+}
+
+void CWallet::StartStakingWorkers(int nThreads)
+{
+    if (nThreads <= 0) nThreads = GetNumCores();
+    if (nThreads <= 1) return;
+
+    stakingWorkerPool = std::make_unique<ctpl::thread_pool>(nThreads);
+    RenameThreadPool(*stakingWorkerPool, "Hemis-staker");
+    LogPrintf("Using %d threads for the stake kernel search\n", nThreads);
+}
+
 bool CWallet::SignCoinStake(CMutableTransaction& txNew) const
 {
     // Sign it
@@ -3611,9 +4077,14 @@ bool CWallet::SetAddressBook(const CWDestination& address, const std::string& st
     bool fUpdated = HasAddressBook(address);
     {
         LOCK(cs_wallet); // mapAddressBook
+        const bool fWasDelegator = mapAddressBook[address].purpose == AddressBook::AddressBookPurpose::DELEGATOR;
         mapAddressBook[address].name = strName;
         if (!strPurpose.empty()) /* update purpose only if requested */
             mapAddressBook[address].purpose = strPurpose;
+        // The cold-staked outputs of a delegator are checked again
+        if (fWasDelegator || mapAddressBook[address].purpose == AddressBook::AddressBookPurpose::DELEGATOR) {
+            SetStakeableMaxHeight(-1);
+        }
     }
     NotifyAddressBookChanged(this, address, strName, ::IsMine(*this, address) != ISMINE_NO,
             mapAddressBook.at(address).purpose, (fUpdated ? CT_UPDATED : CT_NEW));
@@ -3635,6 +4106,8 @@ bool CWallet::DelAddressBook(const CWDestination& address, const CChainParams::B
             WalletBatch(*database).EraseDestData(strAddress, item.first);
         }
         mapAddressBook.erase(address);
+        // The cold-staked outputs of a delegator are checked again
+        if (purpose == AddressBook::AddressBookPurpose::DELEGATOR) SetStakeableMaxHeight(-1);
     }
 
     NotifyAddressBookChanged(this, address, "", ::IsMine(*this, address) != ISMINE_NO, purpose, CT_DELETED);
@@ -3916,6 +4389,7 @@ void CWallet::LockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.insert(output);
+    RecheckStakeableCoin(output);
 }
 
 void CWallet::LockNote(const SaplingOutPoint& op)
@@ -3928,6 +4402,7 @@ void CWallet::UnlockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.erase(output);
+    RecheckStakeableCoin(output);
 }
 
 void CWallet::UnlockNote(const SaplingOutPoint& op)
@@ -3939,7 +4414,11 @@ void CWallet::UnlockNote(const SaplingOutPoint& op)
 void CWallet::UnlockAllCoins()
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
-    setLockedCoins.clear();
+    std::set<COutPoint> setUnlocked;
+    setUnlocked.swap(setLockedCoins);
+    for (const COutPoint& output : setUnlocked) {
+        RecheckStakeableCoin(output);
+    }
 }
 
 void CWallet::UnlockAllNotes()
@@ -4333,6 +4812,8 @@ CWallet* CWallet::CreateWalletFromFile(const std::string& name, const fs::path&
 
     LogPrintf("Wallet completed loading in %15dms\n", GetTimeMillis() - nStart);
 
+    walletInstance->GetSaplingScriptPubKeyMan()->StartDecryptionWorkers(gArgs.GetArg("-saplingdecryptthreads", DEFAULT_SAPLING_DECRYPT_THREADS));
+
     LOCK(cs_main);
     CBlockIndex* pindexRescan = chainActive.Genesis();
 
@@ -4506,6 +4987,10 @@ CWallet::CWallet(std::string name, std::unique_ptr<WalletDatabase> database) : m
 
 CWallet::~CWallet()
 {
+    if (stakingWorkerPool) {
+        stakingWorkerPool->clear_queue();
+        stakingWorkerPool->stop(true);
+    }
     delete encrypted_batch;
     delete pStakerStatus;
 }
@@ -4945,3 +5430,12 @@ CStakeableOutput::CStakeableOutput(const CWalletTx* txIn,
                        COutput(txIn, iIn, nDepthIn, true /*fSpendable*/, true/*fSolvable*/, true/*fSafe*/),
                        pindex(_pindex)
 {}
+
+const CStakeKernel& CStakeableOutput::GetKernel(const CBlockIndex* pindexPrev, unsigned int nBits) const
+{
+    if (!kernel || !kernel->IsValidFor(pindexPrev, nBits)) {
+        CPivStake stakeInput(tx->tx->vout[i], COutPoint(tx->GetHash(), i), pindex);
+        kernel = std::make_shared<CStakeKernel>(pindexPrev, &stakeInput, nBits, 0);
+    }
+    return *kernel;
+}
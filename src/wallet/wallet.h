@@ -78,6 +78,12 @@ static const bool DEFAULT_SPEND_ZEROCONF_CHANGE = true;
 static const bool DEFAULT_STAKING = true;
 //! Default for -coldstaking
 static const bool DEFAULT_COLDSTAKING = true;
+//! Default for -stakingthreads
+static const int DEFAULT_STAKING_THREADS = 1;
+//! Default for -rescanthreads
+static const int DEFAULT_RESCAN_THREADS = 4;
+//! Default for -saplingdecryptthreads
+static const int DEFAULT_SAPLING_DECRYPT_THREADS = 2;
 //! Defaults for -gen and -genproclimit
 static const bool DEFAULT_GENERATE = false;
 static const unsigned int DEFAULT_GENERATE_PROCLIMIT = 1;
@@ -100,6 +106,10 @@ class SaplingScriptPubKeyMan;
 class SaplingNoteData;
 struct SaplingNoteEntry;
 
+namespace ctpl {
+    class thread_pool;
+}
+
 /** (client) version numbers for particular wallet features */
 enum WalletFeature {
     FEATURE_BASE = 10500, // the earliest version new wallets supports (only useful for getinfo's clientversion output)
@@ -575,10 +585,23 @@ class WalletRescanReserver; //forward declarations for ScanForWalletTransactions
  */
 class CWallet : public CCryptoKeyStore, public CValidationInterface
 {
+public:
+    /** Outputs of a transaction paying to the wallet keys, found without cs_main/cs_wallet (see MatchTxKeys) */
+    struct TxKeysMatch {
+        // a transparent output is mine, or the tx is a ProRegTx (the collateral may be mine)
+        bool fCandidate{false};
+        // result of FindMySaplingNotes
+        std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap> saplingNotes;
+    };
+
 private:
     static std::atomic<bool> fFlushScheduled;
     std::atomic<bool> fAbortRescan;
     std::atomic<bool> fScanningWallet; //controlled by WalletRescanReserver
+    std::atomic<int64_t> m_scanning_start{0};
+    std::atomic<double> m_scanning_progress{0};
+    std::atomic<int> m_scanning_height{0};
+    std::atomic<int64_t> m_scanned_blocks{0};
     std::mutex mutexScanning;
     friend class WalletRescanReserver;
 
@@ -639,12 +662,45 @@ private:
     void AddToSpends(const COutPoint& outpoint, const uint256& wtxid);
     void AddToSpends(const uint256& wtxid);
 
+    /**
+     * Stakeable outputs index, so that StakeableCoins doesn't need to walk the whole mapWallet.
+     * It holds the outputs, with positive value and spendable (or cold-stakeable) by this wallet,
+     * of the transactions confirmed in the main chain and not spent by a confirmed transaction,
+     * ordered by the first wallet height at which they are deep enough to be staked (stake min
+     * depth, and coinbase maturity for the coinbase/coinstake outputs).
+     */
+    std::set<std::pair<int, COutPoint>> setStakeableOutputs GUARDED_BY(cs_wallet);
+    //! txid --> stake height of its outputs in setStakeableOutputs
+    std::map<uint256, int> mapStakeableTxHeights GUARDED_BY(cs_wallet);
+    /**
+     * The entries of setStakeableOutputs up to nStakeableMaxHeight which are not locked nor spent
+     * (even by an unconfirmed tx), split between the spendable ones and the cold-staked ones (with a
+     * delegator). They are updated by the events changing them, and by StakeableCoins for the outputs
+     * getting deep enough (or too shallow, after a reorg), so that StakeableCoins doesn't check the
+     * whole index on each call.
+     */
+    std::set<std::pair<int, COutPoint>> setStakeableCoins GUARDED_BY(cs_wallet);
+    std::set<std::pair<int, COutPoint>> setColdStakeableCoins GUARDED_BY(cs_wallet);
+    int nStakeableMaxHeight GUARDED_BY(cs_wallet){-1};
+    /* Add, update or remove the outputs of the transaction in the stakeable outputs index */
+    void UpdateStakeableOutputs(const CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /* Same, for the transaction and for the wallet transactions it spends */
+    void UpdateStakeableOutputsWithInputs(const CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void EraseStakeableOutputs(const uint256& txid) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /* Check an entry of the stakeable outputs index into setStakeableCoins/setColdStakeableCoins */
+    void CheckStakeableCoin(const std::pair<int, COutPoint>& entry) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /* Re-check the index entry of the output (after a lock/unlock) */
+    void RecheckStakeableCoin(const COutPoint& outpoint) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /* Move nStakeableMaxHeight, checking the entries getting in and dropping the ones getting out */
+    void SetStakeableMaxHeight(int nMaxHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     /* Mark a transaction (and its in-wallet descendants) as conflicting with a particular block. */
     void MarkConflicted(const uint256& hashBlock, int conflicting_height, const uint256& hashTx);
 
     template <class T>
     void SyncMetaData(std::pair<typename TxSpendMap<T>::iterator, typename TxSpendMap<T>::iterator> range);
-    void ChainTipAdded(const CBlockIndex *pindex, const CBlock *pblock, SaplingMerkleTree saplingTree);
+    // saplingTree, the tree of the previous block, is advanced to the tree of pindex
+    void ChainTipAdded(const CBlockIndex *pindex, const CBlock *pblock, SaplingMerkleTree& saplingTree);
 
     /* Used by TransactionAddedToMemorypool/BlockConnected/Disconnected */
     void SyncTransaction(const CTransactionRef& tx, const CWalletTx::Confirmation& confirm);
@@ -673,6 +729,9 @@ private:
     //! Destination --> label/purpose mapping.
     std::map<CWDestination, AddressBook::CAddressBookData> mapAddressBook;
 
+    //! Worker pool splitting the stake kernel search (-stakingthreads). Null when searching serially.
+    std::unique_ptr<ctpl::thread_pool> stakingWorkerPool;
+
 public:
 
     static const CAmount DEFAULT_STAKE_SPLIT_THRESHOLD = 500 * COIN;
@@ -884,6 +943,13 @@ public:
     void AbortRescan() { fAbortRescan = true; }
     bool IsAbortingRescan() { return fAbortRescan; }
     bool IsScanning() { return fScanningWallet; }
+    int64_t ScanningDuration() const { return fScanningWallet ? GetTimeMillis() - m_scanning_start : 0; }
+    double ScanningProgress() const { return fScanningWallet ? (double) m_scanning_progress : 0; }
+    int ScanningHeight() const { return fScanningWallet ? (int) m_scanning_height : 0; }
+    int64_t ScannedBlocks() const { return fScanningWallet ? (int64_t) m_scanned_blocks : 0; }
+
+    /** Match the outputs of a transaction with the wallet keys. Only takes the key store lock. */
+    TxKeysMatch MatchTxKeys(const CTransaction& tx) const;
 
     /*
      * Stake Split threshold
@@ -925,7 +991,8 @@ public:
     //////////// Sapling //////////////////
 
     // Search for notes and addresses from this wallet in the tx, and add the addresses --> IVK mapping to the keystore if missing.
-    bool FindNotesDataAndAddMissingIVKToKeystore(const CTransaction& tx, Optional<mapSaplingNoteData_t>& saplingNoteData);
+    bool FindNotesDataAndAddMissingIVKToKeystore(const CTransaction& tx, Optional<mapSaplingNoteData_t>& saplingNoteData,
+                                                 const std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap>* pFound = nullptr);
     // Decrypt sapling output notes with the inputs ovk and updates saplingNoteDataMap
     void AddExternalNotesDataToTx(CWalletTx& wtx) const;
 
@@ -1028,9 +1095,15 @@ public:
     void TransactionAddedToMempool(const CTransactionRef& tx) override;
     void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex *pindex) override;
     void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const uint256& blockHash, int nBlockHeight, int64_t blockTime) override;
-    bool AddToWalletIfInvolvingMe(const CTransactionRef& tx, const CWalletTx::Confirmation& confirm, bool fUpdate);
+    bool AddToWalletIfInvolvingMe(const CTransactionRef& tx, const CWalletTx::Confirmation& confirm, bool fUpdate,
+                                  const TxKeysMatch* pMatch = nullptr);
     void EraseFromWallet(const uint256& hash);
 
+    // Number of keys, scripts and viewing keys in the key store: a change means a TxKeysMatch can be stale
+    size_t GetKeyStoreSize() const;
+    // False if the tx, given the outputs matched by MatchTxKeys, can't be added to the wallet
+    bool MayInvolveMe(const CTransaction& tx, const TxKeysMatch& match) const;
+
     /**
      * Upgrade wallet to HD and Sapling if needed. Does nothing if not.
      */
@@ -1118,6 +1191,22 @@ public:
                          std::vector<CStakeableOutput>* availableCoins,
                          bool stopOnNewBlock = true) const;
     bool SignCoinStake(CMutableTransaction& txNew) const;
+    /**
+     * Search the coins in [nPos, end) for a stake kernel on top of pindexPrev, using the staking worker pool.
+     * The workers stop once the coins before the first kernel are all checked, or the search gets
+     * interrupted (new tip, locked wallet or shutdown). Spent kernel candidates are removed from the vector.
+     * Return false if the search was interrupted, otherwise nPos is set to the position of the
+     * first kernel (as found by a serial search), or to the end of the vector if none.
+     */
+    bool SearchStakeKernel(const CBlockIndex* pindexPrev,
+                           unsigned int nBits,
+                           std::vector<CStakeableOutput>& availableCoins,
+                           size_t& nPos,
+                           int64_t& nTxNewTime,
+                           int& nAttempts,
+                           bool stopOnNewBlock) const;
+    /** Start the worker pool used by CreateCoinStake for the kernel search (nThreads <= 0 = all cores) */
+    void StartStakingWorkers(int nThreads);
     void AutoCombineDust(CConnman* connman);
 
     // Shielded balances
@@ -1314,6 +1403,11 @@ public:
     CStakeableOutput(const CWalletTx* txIn, int iIn, int nDepthIn,
                      const CBlockIndex*& pindex);
 
+    /** Return the stake kernel of this output on top of pindexPrev (its message prefix is hashed once per tip) */
+    const CStakeKernel& GetKernel(const CBlockIndex* pindexPrev, unsigned int nBits) const;
+
+private:
+    mutable std::shared_ptr<CStakeKernel> kernel;
 };
 
 /** RAII object to check and reserve a wallet rescan */
@@ -1332,6 +1426,10 @@ public:
         if (m_wallet->fScanningWallet) {
             return false;
         }
+        m_wallet->m_scanning_start = GetTimeMillis();
+        m_wallet->m_scanning_progress = 0;
+        m_wallet->m_scanning_height = 0;
+        m_wallet->m_scanned_blocks = 0;
         m_wallet->fScanningWallet = true;
         m_could_reserve = true;
         return true;
@@ -9,6 +9,7 @@ import random
 from test_framework.test_framework import HemisTestFramework
 from test_framework.util import (
     assert_equal,
+    wait_until,
 )
 
 
@@ -17,7 +18,8 @@ class BlockIndexStatsTest(HemisTestFramework):
     def set_test_params(self):
         self.num_nodes = 2
         saplingUpgrade = ['-nuparams=v5_shield:201']
-        self.extra_args = [saplingUpgrade] * self.num_nodes
+        # The miner reads the stats from the block stats index, alice from disk
+        self.extra_args = [saplingUpgrade + ['-blockstatsindex'], saplingUpgrade]
 
     def send_tx(self, node_from, node_to, fee, fFromShield, fToShield):
         if not fFromShield and not fToShield:
@@ -140,6 +142,10 @@ class BlockIndexStatsTest(HemisTestFramework):
         assert_equal(count_bytes, alice_stats['txbytes'])
         assert_equal(count_fees, float(alice_stats['ttlfee']))
 
+        wait_until(lambda: miner.getindexinfo("blockstatsindex")["blockstatsindex"]["synced"])
+        miner_stats = miner.getblockindexstats(start_block+1, NUM_BLOCKS)
+        assert_equal(miner_stats, alice_stats)
+
 
 
 if __name__ == '__main__':